@@ -10,6 +10,7 @@ from werkzeug.utils import secure_filename
 import cv2
 import tempfile
 import shutil
+from shm_ring import SharedFrameRingWriter
 
 app = Flask(__name__)
 CORS(app)
@@ -18,12 +19,14 @@ CORS(app)
 UPLOAD_FOLDER = 'uploads'
 OUTPUT_FOLDER = 'outputs'
 TEMP_FOLDER = 'temp'
+DETECTION_CACHE_FOLDER = 'detection_cache'
 ALLOWED_EXTENSIONS = {'mp4', 'avi', 'mov', 'mkv', 'mk4'}
 
 # Create directories
 os.makedirs(UPLOAD_FOLDER, exist_ok=True)
 os.makedirs(OUTPUT_FOLDER, exist_ok=True)
 os.makedirs(TEMP_FOLDER, exist_ok=True)
+os.makedirs(DETECTION_CACHE_FOLDER, exist_ok=True)
 
 # Global task storage
 tasks = {}
@@ -57,73 +60,63 @@ def get_video_info(video_path):
         print(f"Error getting video info: {e}")
         return None
 
-def preprocess_video(video_path, output_path):
-    """Preprocess video for better processing"""
+def plan_preprocessing(video_info):
+    """Output geometry used when feeding the tracker.
+    
+    Every source frame is streamed at the source rate; frame skipping is left to
+    the tracker's --frame-skip, so the two never multiply and the ring's declared
+    fps matches the frames it carries.
+    """
+    width, height = video_info['width'], video_info['height']
+    
+    # Reduce resolution if too large
+    if width > 1920 or height > 1080:
+        scale_factor = min(1920 / width, 1080 / height)
+        new_width = int(width * scale_factor)
+        new_height = int(height * scale_factor)
+    else:
+        new_width, new_height = width, height
+    
+    return {
+        'fps': video_info['fps'],
+        'width': new_width,
+        'height': new_height
+    }
+
+def stream_video_to_ring(video_path, ring, should_abort=None):
+    """Decode the video and push raw frames straight into the tracker's shared-memory ring.
+    
+    Replaces the old preprocess-to-mp4 step: frames are resized directly into the
+    ring slots, so there is no re-encode and no temp file per job.
+    """
+    cap = cv2.VideoCapture(video_path)
+    if not cap.isOpened():
+        ring.mark_done()
+        return False
+    
+    frame_idx = 0
+    streamed_frames = 0
     try:
-        cap = cv2.VideoCapture(video_path)
-        if not cap.isOpened():
-            return False
-        
-        # Get original properties
-        fps = cap.get(cv2.CAP_PROP_FPS)
-        frame_count = int(cap.get(cv2.CAP_PROP_FRAME_COUNT))
-        width = int(cap.get(cv2.CAP_PROP_FRAME_WIDTH))
-        height = int(cap.get(cv2.CAP_PROP_FRAME_HEIGHT))
-        
-        # Calculate new properties for optimization
-        target_fps = min(fps, 15)  # Max 15 FPS for processing
-        frame_skip = max(1, int(fps / target_fps))
-        
-        # Reduce resolution if too large
-        scale_factor = 1.0
-        if width > 1920 or height > 1080:
-            scale_factor = min(1920 / width, 1080 / height)
-            new_width = int(width * scale_factor)
-            new_height = int(height * scale_factor)
-        else:
-            new_width, new_height = width, height
-        
-        # Setup video writer
-        fourcc = cv2.VideoWriter_fourcc(*'mp4v')
-        out = cv2.VideoWriter(output_path, fourcc, target_fps, (new_width, new_height))
-        
-        frame_idx = 0
-        processed_frames = 0
-        
-        print(f"Preprocessing video: {frame_count} frames -> {frame_count // frame_skip} frames")
-        print(f"Resolution: {width}x{height} -> {new_width}x{new_height}")
-        print(f"FPS: {fps} -> {target_fps}")
-        
         while True:
             ret, frame = cap.read()
             if not ret:
                 break
             
-            # Skip frames for faster processing
-            if frame_idx % frame_skip == 0:
-                # Resize if needed
-                if scale_factor != 1.0:
-                    frame = cv2.resize(frame, (new_width, new_height))
-                
-                out.write(frame)
-                processed_frames += 1
-                
-                # Progress update every 100 frames
-                if processed_frames % 100 == 0:
-                    progress = (frame_idx / frame_count) * 100
-                    print(f"Preprocessing progress: {progress:.1f}%")
+            timestamp_ms = cap.get(cv2.CAP_PROP_POS_MSEC)
+            if not ring.write(frame, frame_idx, timestamp_ms, should_abort):
+                break
             
+            streamed_frames += 1
             frame_idx += 1
-        
-        cap.release()
-        out.release()
-        
-        print(f"Preprocessing completed: {processed_frames} frames processed")
-        return True
-        
     except Exception as e:
-        print(f"Error preprocessing video: {e}")
+        print(f"Error streaming video to shared memory: {e}")
         return False
+    finally:
+        cap.release()
+        ring.mark_done()
+    
+    print(f"Streamed {streamed_frames} frames to shared memory ring {ring.name}")
+    return True
 
 def process_video_task(task_id, video_path, output_path, parameters):
     """Process video in background thread"""
@@ -141,12 +134,36 @@ def process_video_task(task_id, video_path, output_path, parameters):
         # Prepare C++ tracker command with real-time optimizations
         tracker_path = os.path.join('..', 'build', 'advanced_car_tracker')
         
+        # Stream decoded frames over shared memory when possible instead of
+        # letting the tracker decode the upload a second time
+        ring = None
+        plan = None
+        if parameters.get('use_shared_memory', True) and video_info and os.name == 'posix':
+            plan = plan_preprocessing(video_info)
+            try:
+                ring = SharedFrameRingWriter(
+                    f"cct_{task_id.replace('-', '')[:16]}",
+                    plan['width'], plan['height'],
+                    fps=plan['fps'],
+                    total_frames=video_info['frame_count']
+                )
+            except Exception as e:
+                print(f"Shared memory unavailable, falling back to file input: {e}")
+                ring = None
+        
         # Build command with real-time parameters
-        cmd = [
-            tracker_path,
-            '-i', video_path,
-            '-o', output_path
-        ]
+        if ring is not None:
+            cmd = [tracker_path, '--shm-input', ring.name, '-o', output_path]
+        else:
+            cmd = [tracker_path, '-i', video_path, '-o', output_path]
+        
+        # The server has no display
+        cmd.append('--headless')
+        
+        # Re-runs of the same video with new tracker parameters replay cached detections
+        cmd.extend(['--detection-cache', os.path.abspath(DETECTION_CACHE_FOLDER)])
+        if ring is not None:
+            cmd.extend(['--cache-source', os.path.abspath(video_path)])
         
         # Add real-time mode if enabled
         if parameters.get('enable_realtime', True):
@@ -184,6 +201,15 @@ def process_video_task(task_id, video_path, output_path, parameters):
             cwd=os.path.join('..', 'build')
         )
         
+        producer = None
+        if ring is not None:
+            producer = threading.Thread(
+                target=stream_video_to_ring,
+                args=(video_path, ring, lambda: process.poll() is not None)
+            )
+            producer.daemon = True
+            producer.start()
+        
         # Monitor progress with real-time updates
         while process.poll() is None:
             # Simulate progress based on time elapsed
@@ -205,6 +231,11 @@ def process_video_task(task_id, video_path, output_path, parameters):
         stdout, stderr = process.communicate()
         end_time = time.time()
         
+        if producer is not None:
+            producer.join()
+        if ring is not None:
+            ring.close()
+        
         if process.returncode == 0:
             tasks[task_id]['status'] = 'completed'
             tasks[task_id]['progress'] = 100
@@ -295,7 +326,8 @@ def start_processing():
             'enable_reid': request.form.get('enable_reid', 'true').lower() == 'true',
             'enable_camera': request.form.get('enable_camera', 'true').lower() == 'true',
             'resolution_scale': float(request.form.get('resolution_scale', 1.0)),
-            'frame_skip': int(request.form.get('frame_skip', 1))
+            'frame_skip': int(request.form.get('frame_skip', 1)),
+            'use_shared_memory': request.form.get('use_shared_memory', 'true').lower() == 'true'
         }
         
         # Initialize task
@@ -0,0 +1,145 @@
+"""Producer side of the shared-memory frame ring read by advanced_car_tracker --shm-input.
+
+The layout mirrors src/SharedFrameRing.h; keep RING_VERSION and the offsets below
+in sync with it.
+
+Sequences and indices are published through libcct_ring_publish (built next to
+the tracker) so the pixel stores are ordered before them. Without the library the
+writer only runs on x86, whose stores are not reordered with each other.
+"""
+import ctypes
+import os
+import platform
+import struct
+import time
+from multiprocessing import shared_memory
+
+import numpy as np
+
+RING_MAGIC = 0x52544343  # "CCTR"
+RING_VERSION = 1
+
+HEADER_SIZE = 128
+SLOT_ALIGNMENT = 64
+SLOT_HEADER_SIZE = 32
+
+# magic, version, slotCount, width, height, channels, slotStride, fps, totalFrames
+_HEADER_FORMAT = '<IIIIIIQdq'
+_WRITE_INDEX_OFFSET = 48
+_READ_INDEX_OFFSET = 56
+_PRODUCER_DONE_OFFSET = 64
+
+_STRONGLY_ORDERED_MACHINES = {'x86_64', 'amd64', 'i386', 'i686', 'x86'}
+
+
+def _load_publish_library():
+    path = os.environ.get('CCT_RING_PUBLISH_LIB') or os.path.join(
+        os.path.dirname(os.path.abspath(__file__)), '..', 'build', 'libcct_ring_publish.so')
+    try:
+        lib = ctypes.CDLL(path)
+    except OSError:
+        return None
+    lib.cct_ring_begin_slot.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+    lib.cct_ring_publish_u64.argtypes = [ctypes.c_void_p, ctypes.c_uint64]
+    lib.cct_ring_publish_u32.argtypes = [ctypes.c_void_p, ctypes.c_uint32]
+    for fn in (lib.cct_ring_begin_slot, lib.cct_ring_publish_u64, lib.cct_ring_publish_u32):
+        fn.restype = None
+    return lib
+
+
+_publish = _load_publish_library()
+
+
+class SharedFrameRingWriter:
+    """Writes raw BGR frames into a seqlock-guarded ring in POSIX shared memory."""
+
+    def __init__(self, name, width, height, channels=3, slot_count=8, fps=30.0, total_frames=0):
+        if _publish is None and platform.machine().lower() not in _STRONGLY_ORDERED_MACHINES:
+            raise RuntimeError('libcct_ring_publish is required for shared memory on '
+                               f'{platform.machine()}; build the tracker first')
+        self.name = name
+        self.width = width
+        self.height = height
+        self.channels = channels
+        self.slot_count = slot_count
+
+        frame_bytes = width * height * channels
+        self.slot_stride = _align_up(SLOT_HEADER_SIZE + frame_bytes, SLOT_ALIGNMENT)
+        size = HEADER_SIZE + self.slot_stride * slot_count
+
+        self.shm = shared_memory.SharedMemory(name=name, create=True, size=size)
+        self.buf = self.shm.buf
+        # Released in close(); an exported pointer keeps the mapping open
+        self._base = ctypes.c_char.from_buffer(self.buf)
+        self._base_address = ctypes.addressof(self._base)
+        self.buf[:HEADER_SIZE] = bytes(HEADER_SIZE)
+        struct.pack_into(_HEADER_FORMAT, self.buf, 0, 0, RING_VERSION, slot_count,
+                         width, height, channels, self.slot_stride, float(fps), int(total_frames))
+
+        self._slots = []
+        for i in range(slot_count):
+            offset = HEADER_SIZE + i * self.slot_stride
+            pixels = np.ndarray((height, width, channels), dtype=np.uint8,
+                                buffer=self.buf, offset=offset + SLOT_HEADER_SIZE)
+            self._slots.append((offset, pixels))
+
+        self.write_index = 0
+        # Publish the magic last so the consumer never sees a half-built header
+        struct.pack_into('<I', self.buf, 0, RING_MAGIC)
+
+    def write(self, frame, frame_index, timestamp_ms, should_abort=None):
+        """Copy (and resize if needed) a frame into the next slot.
+
+        Blocks while the ring is full. Returns False if should_abort() turns
+        true while waiting, e.g. because the consumer process has exited.
+        """
+        n = self.write_index
+        while n - self._read_index() >= self.slot_count:
+            if should_abort is not None and should_abort():
+                return False
+            time.sleep(0.0005)
+
+        offset, pixels = self._slots[n % self.slot_count]
+        if _publish is not None:
+            _publish.cct_ring_begin_slot(self._base_address + offset, 2 * n + 1)
+        else:
+            struct.pack_into('<Q', self.buf, offset, 2 * n + 1)
+
+        if frame.shape[0] == self.height and frame.shape[1] == self.width:
+            np.copyto(pixels, frame)
+        else:
+            import cv2
+            cv2.resize(frame, (self.width, self.height), dst=pixels, interpolation=cv2.INTER_AREA)
+
+        struct.pack_into('<qd', self.buf, offset + 8, int(frame_index), float(timestamp_ms))
+        self._publish_u64(offset, 2 * n + 2)
+
+        self.write_index = n + 1
+        self._publish_u64(_WRITE_INDEX_OFFSET, self.write_index)
+        return True
+
+    def mark_done(self):
+        if _publish is not None:
+            _publish.cct_ring_publish_u32(self._base_address + _PRODUCER_DONE_OFFSET, 1)
+        else:
+            struct.pack_into('<I', self.buf, _PRODUCER_DONE_OFFSET, 1)
+
+    def close(self):
+        self._slots = []
+        self._base = None
+        self.buf = None
+        self.shm.close()
+        self.shm.unlink()
+
+    def _publish_u64(self, offset, value):
+        if _publish is not None:
+            _publish.cct_ring_publish_u64(self._base_address + offset, value)
+        else:
+            struct.pack_into('<Q', self.buf, offset, value)
+
+    def _read_index(self):
+        return struct.unpack_from('<Q', self.buf, _READ_INDEX_OFFSET)[0]
+
+
+def _align_up(value, alignment):
+    return (value + alignment - 1) // alignment * alignment
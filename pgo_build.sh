@@ -0,0 +1,62 @@
+#!/bin/bash
+
+# Profile-guided release build
+#
+# 1. Builds instrumented binaries (LTO + -fprofile-generate) in build-pgo
+# 2. Trains them on the synthetic end-to-end benchmark workload
+# 3. Rebuilds build-pgo with the profiles (LTO + -fprofile-use). GCC keys
+#    profiles by object path, so both steps must use the same build directory.
+# 4. Builds an LTO-only reference in build-lto and compares e2e_bench FPS
+
+set -e
+
+echo "=== Car Chase Tracker PGO Build ==="
+
+JOBS=$(nproc 2>/dev/null || sysctl -n hw.ncpu 2>/dev/null || echo 4)
+ROOT=$(cd "$(dirname "$0")" && pwd)
+PROFILE_DIR="$ROOT/build-pgo/pgo-profiles"
+# Keep training and comparison runs the same shape as the regular benchmark
+BENCH_ARGS="--vehicles 10,50,200 --frames 300"
+
+configure_and_build() {
+    local dir=$1
+    shift
+    cmake -S "$ROOT" -B "$ROOT/$dir" -DCMAKE_BUILD_TYPE=Release -DCCT_LTO=ON "$@"
+    cmake --build "$ROOT/$dir" -j"$JOBS"
+}
+
+echo "[1/4] Building instrumented binaries..."
+rm -rf "$PROFILE_DIR"
+configure_and_build build-pgo -DCCT_PGO=GENERATE -DCCT_PGO_DIR="$PROFILE_DIR"
+
+echo "[2/4] Training on the end-to-end benchmark..."
+TRAIN_DIR=$(mktemp -d)
+# Detector path and tracking-only (oracle) path, so both get profiled
+"$ROOT/build-pgo/e2e_bench" $BENCH_ARGS --workdir "$TRAIN_DIR/detector"
+"$ROOT/build-pgo/e2e_bench" $BENCH_ARGS --workdir "$TRAIN_DIR/oracle" --oracle
+rm -rf "$TRAIN_DIR"
+
+if ls "$PROFILE_DIR"/*.profraw >/dev/null 2>&1; then
+    # Clang writes raw profiles that must be merged first
+    llvm-profdata merge -output="$PROFILE_DIR/default.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+echo "[3/4] Building profile-optimized binaries..."
+configure_and_build build-pgo -DCCT_PGO=USE -DCCT_PGO_DIR="$PROFILE_DIR"
+
+echo "[4/4] Comparing against an LTO-only build..."
+configure_and_build build-lto
+COMPARE_DIR=$(mktemp -d)
+"$ROOT/build-lto/e2e_bench" $BENCH_ARGS --oracle --workdir "$COMPARE_DIR/lto" --csv "$COMPARE_DIR/lto.csv"
+"$ROOT/build-pgo/e2e_bench" $BENCH_ARGS --oracle --workdir "$COMPARE_DIR/pgo" --csv "$COMPARE_DIR/pgo.csv"
+
+echo ""
+echo "Tracking FPS (oracle detections):"
+printf "  %-10s %10s %10s %8s\n" "vehicles" "LTO" "LTO+PGO" "gain"
+# Columns: vehicles,frames,fps,...
+paste -d, <(tail -n +2 "$COMPARE_DIR/lto.csv" | cut -d, -f1,3) <(tail -n +2 "$COMPARE_DIR/pgo.csv" | cut -d, -f3) |
+    awk -F, '{ printf "  %-10s %10.1f %10.1f %+7.1f%%\n", $1, $2, $3, ($2 > 0 ? ($3 / $2 - 1) * 100 : 0) }'
+rm -rf "$COMPARE_DIR"
+
+echo ""
+echo "=== PGO build completed: build-pgo/ ==="
@@ -1,13 +1,26 @@
 #include "AdvancedCarTracker.h"
+#include "Tracer.h"
 #include <iostream>
 #include <chrono>
 #include <iomanip>
+#include <sstream>
+
+namespace {
+
+// Longest step handed to the tracker; after a longer stall the motion model
+// has nothing useful to say and matching falls back on the detections
+const float kMaxElapsedFrames = 30.0f;
+
+}  // namespace
 
 AdvancedCarTracker::AdvancedCarTracker() 
-    : isRunning_(false), showDebugInfo_(true), enableRecording_(false),
+    : snapshotInterval_(300), lastSnapshotFrame_(-1), resumeFrame_(-1),
+      isRunning_(false), headless_(false), showDebugInfo_(true), enableRecording_(false),
       targetSelectionMode_(false), targetSelected_(false), selectedTargetId_(-1),
       frameCount_(0), totalProcessingTime_(0.0), averageFPS_(0.0),
-      frameSkip(1), frameCounter(0), realtimeMode(false), resolutionScale(1.0f) {
+      frameSkip(1), frameCounter(0), realtimeMode(false), resolutionScale(1.0f),
+      frameIntervalMs_(0.0), frameTimestampMs_(-1.0), lastTrackedFrame_(-1),
+      lastTrackedTimestampMs_(-1.0) {
 }
 
 AdvancedCarTracker::~AdvancedCarTracker() {
@@ -27,19 +40,25 @@ bool AdvancedCarTracker::initialize(const std::string& videoPath, const std::str
     // Initialize tracking system
     trackingSystem_ = std::make_unique<AdvancedTrackingSystem>();
     trackingSystem_->initialize();
+    vehicleDetector_->setLatencyStats(&latencyStats_);
+    trackingSystem_->setLatencyStats(&latencyStats_);
     
     // Open video capture
     if (!videoPath.empty()) {
-        videoCapture_.open(videoPath);
-        if (!videoCapture_.isOpened()) {
+        if (!videoIngest_.open(videoPath)) {
             std::cerr << "Error: Could not open video file: " << videoPath << std::endl;
             return false;
         }
+        frameIntervalMs_ = videoIngest_.getFPS() > 0.0 ? 1000.0 / videoIngest_.getFPS() : 0.0;
     }
+    videoPath_ = videoPath;
+    detectionCache_.reset();
     
     // Set up mouse callback for interactive target selection
-    cv::namedWindow("Advanced Car Chase Tracker", cv::WINDOW_AUTOSIZE);
-    cv::setMouseCallback("Advanced Car Chase Tracker", onMouse, this);
+    if (!headless_) {
+        cv::namedWindow("Advanced Car Chase Tracker", cv::WINDOW_AUTOSIZE);
+        cv::setMouseCallback("Advanced Car Chase Tracker", onMouse, this);
+    }
     
     std::cout << "Advanced Car Chase Tracking System initialized successfully!" << std::endl;
     std::cout << "Controls:" << std::endl;
@@ -47,6 +66,7 @@ bool AdvancedCarTracker::initialize(const std::string& videoPath, const std::str
     std::cout << "  'C': Clear primary target" << std::endl;
     std::cout << "  'T': Toggle target selection mode" << std::endl;
     std::cout << "  'I': Show track information" << std::endl;
+    std::cout << "  'L': Print stage latency percentiles" << std::endl;
     std::cout << "  ESC: Exit" << std::endl;
     
     return true;
@@ -65,24 +85,61 @@ bool AdvancedCarTracker::initializeCamera(int cameraIndex) {
     // Initialize tracking system
     trackingSystem_ = std::make_unique<AdvancedTrackingSystem>();
     trackingSystem_->initialize();
+    vehicleDetector_->setLatencyStats(&latencyStats_);
+    trackingSystem_->setLatencyStats(&latencyStats_);
     
     // Open camera capture
-    videoCapture_.open(cameraIndex);
-    if (!videoCapture_.isOpened()) {
+    if (!videoIngest_.open(cameraIndex)) {
         std::cerr << "Error: Could not open camera " << cameraIndex << std::endl;
         return false;
     }
+    // Cameras often report no rate; frame indices are used then
+    frameIntervalMs_ = videoIngest_.getFPS() > 0.0 ? 1000.0 / videoIngest_.getFPS() : 0.0;
     
     // Set up mouse callback for interactive target selection
-    cv::namedWindow("Advanced Car Chase Tracker", cv::WINDOW_AUTOSIZE);
-    cv::setMouseCallback("Advanced Car Chase Tracker", onMouse, this);
+    if (!headless_) {
+        cv::namedWindow("Advanced Car Chase Tracker", cv::WINDOW_AUTOSIZE);
+        cv::setMouseCallback("Advanced Car Chase Tracker", onMouse, this);
+    }
     
     std::cout << "Camera initialized successfully!" << std::endl;
     return true;
 }
 
+bool AdvancedCarTracker::initializeSharedMemory(const std::string& ringName) {
+    std::cout << "Attaching to shared frame ring: " << ringName << std::endl;
+    
+    // Initialize vehicle detector
+    vehicleDetector_ = std::make_unique<VehicleDetector>();
+    if (!vehicleDetector_->initialize()) {
+        std::cerr << "Failed to initialize vehicle detector!" << std::endl;
+        return false;
+    }
+    
+    // Initialize tracking system
+    trackingSystem_ = std::make_unique<AdvancedTrackingSystem>();
+    trackingSystem_->initialize();
+    vehicleDetector_->setLatencyStats(&latencyStats_);
+    trackingSystem_->setLatencyStats(&latencyStats_);
+    
+    // Frames arrive raw from the producer; no container to demux or decode
+    frameRing_ = std::make_unique<SharedFrameRing>();
+    if (!frameRing_->open(ringName)) {
+        std::cerr << "Error: Could not attach to shared frame ring: " << ringName << std::endl;
+        frameRing_.reset();
+        return false;
+    }
+    
+    frameCount_ = static_cast<int>(frameRing_->getTotalFrames());
+    frameIntervalMs_ = frameRing_->getFPS() > 0.0 ? 1000.0 / frameRing_->getFPS() : 0.0;
+    
+    std::cout << "Shared frame ring attached: " << frameRing_->getWidth() << "x" 
+              << frameRing_->getHeight() << " @ " << frameRing_->getFPS() << " FPS" << std::endl;
+    return true;
+}
+
 void AdvancedCarTracker::run() {
-    if (!videoCapture_.isOpened()) {
+    if (!videoIngest_.isOpened() && !frameRing_) {
         std::cerr << "Error: No video source available!" << std::endl;
         return;
     }
@@ -93,18 +150,19 @@ void AdvancedCarTracker::run() {
     std::cout << "Starting advanced tracking..." << std::endl;
     
     while (isRunning_) {
-        videoCapture_ >> frame;
-        if (frame.empty()) {
+        StageTimer decodeTimer(&latencyStats_, LatencyStage::Decode);
+        if (!readFrame(frame)) {
+            decodeTimer.cancel();
             std::cout << "End of video stream." << std::endl;
             break;
         }
+        decodeTimer.stop();
         
-        auto startTime = std::chrono::high_resolution_clock::now();
+        StageTimer frameTimer(&latencyStats_, LatencyStage::Frame);
         processFrame(frame);
-        auto endTime = std::chrono::high_resolution_clock::now();
+        updatePerformanceMetrics(frameTimer.stop() / 1e6);
         
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-        updatePerformanceMetrics(duration.count());
+        if (headless_) continue;
         
         // Display frame
         cv::imshow("Advanced Car Chase Tracker", frame);
@@ -118,38 +176,134 @@ void AdvancedCarTracker::run() {
         }
     }
     
+    latencyStats_.printSummary(std::cout);
     stop();
 }
 
 void AdvancedCarTracker::stop() {
     isRunning_ = false;
-    if (videoCapture_.isOpened()) {
-        videoCapture_.release();
+    if (metricsServer_) {
+        metricsServer_->stop();
+        metricsServer_.reset();
+    }
+    if (videoIngest_.isOpened()) {
+        if (videoIngest_.getSkippedFrames() > 0) {
+            std::cout << "Stepped over " << videoIngest_.getSkippedFrames() << " of "
+                      << videoIngest_.getSkippedFrames() + videoIngest_.getDecodedFrames()
+                      << " frames without conversion" << std::endl;
+        }
+        videoIngest_.release();
     }
     if (videoWriter_.isOpened()) {
         videoWriter_.release();
     }
-    cv::destroyAllWindows();
+    if (frameRing_) {
+        if (frameRing_->getDroppedFrames() > 0) {
+            std::cout << "Shared frame ring dropped " << frameRing_->getDroppedFrames() 
+                      << " frames" << std::endl;
+        }
+        frameRing_.reset();
+    }
+    if (trackLog_) {
+        trackLog_->close();
+    }
+    snapshotWriter_.reset();
+    if (detectionCache_) {
+        if (detectionCache_->getHits() > 0 || detectionCache_->getMisses() > 0) {
+            std::cout << "Detection cache: " << detectionCache_->getHits() << " hits, "
+                      << detectionCache_->getMisses() << " misses" << std::endl;
+        }
+        detectionCache_.reset();
+    }
+    for (auto& exporter : exporters_) {
+        exporter->close();
+    }
+    if (!headless_) {
+        cv::destroyAllWindows();
+    }
+}
+
+bool AdvancedCarTracker::readFrame(cv::Mat& frame) {
+    if (frameRing_) {
+        // The previous frame was used in place; hand its slot back first
+        if (!frameRing_->release()) {
+            std::cerr << "Warning: shared frame was overwritten while in use" << std::endl;
+        }
+        
+        int64_t frameIndex = 0;
+        double timestampMs = 0.0;
+        if (!frameRing_->acquire(frame, frameIndex, timestampMs)) {
+            frame.release();
+            return false;
+        }
+        frameTimestampMs_ = timestampMs;
+        return true;
+    }
+    
+    if (!videoIngest_.read(frame)) return false;
+    frameTimestampMs_ = videoIngest_.getTimestampMs();
+    return true;
+}
+
+bool AdvancedCarTracker::skipFrame(cv::Mat& frame) {
+    // Ring slots must be acquired and released in order, and their pixels
+    // are already BGR; only the file and camera path has work to skip
+    if (frameRing_) return readFrame(frame);
+    
+    if (!videoIngest_.skip()) return false;
+    frameTimestampMs_ = videoIngest_.getTimestampMs();
+    return true;
+}
+
+float AdvancedCarTracker::elapsedFrames(int frameIndex, double timestampMs) {
+    float elapsed = framesSince(frameIndex, timestampMs);
+    lastTrackedFrame_ = frameIndex;
+    lastTrackedTimestampMs_ = timestampMs;
+    return elapsed;
+}
+
+float AdvancedCarTracker::framesSince(int frameIndex, double timestampMs) const {
+    float elapsed = 1.0f;
+    if (timestampMs > lastTrackedTimestampMs_ && lastTrackedTimestampMs_ >= 0.0 && frameIntervalMs_ > 0.0) {
+        elapsed = static_cast<float>((timestampMs - lastTrackedTimestampMs_) / frameIntervalMs_);
+    } else if (frameIndex > lastTrackedFrame_ && lastTrackedFrame_ >= 0) {
+        elapsed = static_cast<float>(frameIndex - lastTrackedFrame_);
+    }
+    return std::max(0.1f, std::min(elapsed, kMaxElapsedFrames));
+}
+
+void AdvancedCarTracker::resetFrameTiming() {
+    lastTrackedFrame_ = -1;
+    lastTrackedTimestampMs_ = -1.0;
 }
 
-void AdvancedCarTracker::processFrame(const cv::Mat& frame) {
+void AdvancedCarTracker::processFrame(const cv::Mat& frame, int frameIndex) {
+    Tracer::setFrame(frameIndex >= 0 ? frameIndex : frameCount_);
+    TRACE_SCOPE("processFrame");
     try {
         // Detect vehicles
-        std::vector<Detection> detections = vehicleDetector_->detectVehicles(frame);
+        std::vector<Detection> detections = detectFrame(frame, frameIndex);
         
-        // Update tracking
-        std::vector<AdvancedTrackedVehicle> tracks = trackingSystem_->updateAdvanced(detections, frame);
+        // Update tracking; the controller supplies frames without timestamps
+        float dt = elapsedFrames(frameIndex, -1.0);
+        TrackView<AdvancedTrackedVehicle> tracks = trackingSystem_->updateAdvanced(detections, frame, dt);
+        logTracks(frameCount_, tracks);
+        exportTracks(frameCount_ + 1, tracks);
+        recordFrameMetrics(detections.size(), tracks.size());
         
         // Draw results
+        StageTimer renderTimer(&latencyStats_, LatencyStage::Render);
         cv::Mat outputFrame = frame.clone();
         trackingSystem_->drawAdvancedTracks(outputFrame, tracks);
         trackingSystem_->drawTargetSelection(outputFrame);
         
         // Draw UI
         drawUI(outputFrame);
+        renderTimer.stop();
         
         // Save frame if recording
         if (enableRecording_) {
+            StageTimer encodeTimer(&latencyStats_, LatencyStage::Encode);
             saveFrame(outputFrame);
         }
         
@@ -206,6 +360,10 @@ void AdvancedCarTracker::handleKeyPress(int key) {
         case 'R':
             setRecordingMode(!enableRecording_);
             break;
+        case 'l':
+        case 'L':
+            latencyStats_.printSummary(std::cout);
+            break;
     }
 }
 
@@ -231,6 +389,15 @@ void AdvancedCarTracker::setDebugMode(bool enable) {
     showDebugInfo_ = enable;
 }
 
+void AdvancedCarTracker::setDecodeOptions(int threads, bool hardwareDecode) {
+    videoIngest_.setDecodeThreads(threads);
+    videoIngest_.setHardwareDecode(hardwareDecode);
+}
+
+void AdvancedCarTracker::setHeadless(bool headless) {
+    headless_ = headless;
+}
+
 void AdvancedCarTracker::setRecordingMode(bool enable, const std::string& outputPath) {
     enableRecording_ = enable;
     if (!outputPath.empty()) {
@@ -242,6 +409,80 @@ void AdvancedCarTracker::setTargetSelectionMode(bool enable) {
     targetSelectionMode_ = enable;
 }
 
+bool AdvancedCarTracker::setTrackLogPath(const std::string& path) {
+    trackLog_ = std::make_unique<TrackLogWriter>();
+    // Track log frames are 0-based, like resumeFrame_
+    bool opened = resumeFrame_ >= 0 ? trackLog_->openForResume(path, resumeFrame_)
+                                    : trackLog_->open(path);
+    if (!opened) {
+        trackLog_.reset();
+        return false;
+    }
+    std::cout << "Track log: " << path << std::endl;
+    return true;
+}
+
+bool AdvancedCarTracker::addExporter(const std::string& path, ExportFormat format) {
+    auto exporter = std::make_unique<TrackExporter>();
+    // Export frame numbers are 1-based
+    bool opened = resumeFrame_ >= 0 ? exporter->openForResume(path, format, resumeFrame_ + 1)
+                                    : exporter->open(path, format);
+    if (!opened) {
+        return false;
+    }
+    exporters_.push_back(std::move(exporter));
+    std::cout << "Exporting tracks to: " << path << std::endl;
+    return true;
+}
+
+void AdvancedCarTracker::exportTracks(int frameNumber, TrackView<AdvancedTrackedVehicle> tracks) {
+    TRACE_SCOPE("export_tracks");
+    for (auto& exporter : exporters_) {
+        exporter->writeFrame(frameNumber, tracks, trackingSystem_->getPrimaryTargetId());
+    }
+}
+
+void AdvancedCarTracker::recordFrameMetrics(size_t detections, size_t activeTracks) {
+    metrics_.framesProcessed.fetch_add(1, std::memory_order_relaxed);
+    metrics_.detections.fetch_add(detections, std::memory_order_relaxed);
+    metrics_.lastFrameDetections.store(detections, std::memory_order_relaxed);
+    metrics_.activeTracks.store(activeTracks, std::memory_order_relaxed);
+    metrics_.lostTracks.store(trackingSystem_->getLostTrackCount(), std::memory_order_relaxed);
+    metrics_.reIdHits.store(trackingSystem_->getReIdHits(), std::memory_order_relaxed);
+    if (frameRing_) {
+        metrics_.frameQueueDepth.store(frameRing_->getBacklog(), std::memory_order_relaxed);
+        metrics_.framesDropped.store(frameRing_->getDroppedFrames(), std::memory_order_relaxed);
+    }
+    size_t exportDepth = 0;
+    for (const auto& exporter : exporters_) {
+        exportDepth += exporter->getPendingBuffers();
+    }
+    metrics_.exportQueueDepth.store(exportDepth, std::memory_order_relaxed);
+}
+
+void AdvancedCarTracker::logTracks(int frameIndex, TrackView<AdvancedTrackedVehicle> tracks) {
+    if (!trackLog_) return;
+    TRACE_SCOPE("log_tracks");
+    
+    for (const auto& track : tracks) {
+        TrackLogRow row;
+        row.frame = frameIndex;
+        row.id = track.id;
+        row.x = track.boundingBox.x;
+        row.y = track.boundingBox.y;
+        row.width = track.boundingBox.width;
+        row.height = track.boundingBox.height;
+        row.vx = track.velocity.x;
+        row.vy = track.velocity.y;
+        row.confidence = track.confidence;
+        row.visibility = track.visibilityRatio;
+        row.flags = 0;
+        if (track.isPartiallyOccluded) row.flags |= kTrackLogOccluded;
+        if (trackingSystem_->isPrimaryTarget(track.id)) row.flags |= kTrackLogPrimary;
+        trackLog_->append(row);
+    }
+}
+
 // Interactive features
 void AdvancedCarTracker::handleMouseClick(int x, int y) {
     if (targetSelectionMode_) {
@@ -265,6 +506,21 @@ void AdvancedCarTracker::clearTargetSelection() {
     std::cout << "Target selection cleared." << std::endl;
 }
 
+TrackingState AdvancedCarTracker::saveTrackingState() const {
+    return trackingSystem_->saveState();
+}
+
+void AdvancedCarTracker::restoreTrackingState(const TrackingState& state) {
+    trackingSystem_->restoreState(state);
+    selectedTargetId_ = state.primaryTargetId;
+    targetSelected_ = state.primaryTargetId >= 0;
+    resetFrameTiming();
+    // The previous frame the gate compares against is from elsewhere
+    if (motionGate_) {
+        motionGate_->reset();
+    }
+}
+
 // Performance monitoring
 double AdvancedCarTracker::getAverageFPS() const {
     return averageFPS_;
@@ -278,6 +534,27 @@ double AdvancedCarTracker::getTotalProcessingTime() const {
     return totalProcessingTime_;
 }
 
+const LatencyStats& AdvancedCarTracker::getLatencyStats() const {
+    return latencyStats_;
+}
+
+const TrackerMetrics& AdvancedCarTracker::getMetrics() const {
+    return metrics_;
+}
+
+bool AdvancedCarTracker::startMetricsServer(const std::string& endpoint) {
+    auto server = std::make_unique<MetricsServer>();
+    // Runs on the server thread; only reads atomics
+    bool started = server->start(endpoint, [this] {
+        return formatPrometheusMetrics(metrics_, latencyStats_);
+    });
+    if (!started) {
+        return false;
+    }
+    metricsServer_ = std::move(server);
+    return true;
+}
+
 // Advanced features
 void AdvancedCarTracker::enablePartialOcclusionHandling(bool enable) {
     trackingSystem_->enablePartialTracking(enable);
@@ -324,10 +601,197 @@ void AdvancedCarTracker::setRealtimeMode(bool mode) {
 void AdvancedCarTracker::setResolutionScale(float scale) {
     resolutionScale = std::max(0.1f, std::min(1.0f, scale));
     std::cout << "Resolution scale set to: " << resolutionScale << std::endl;
+    // Cached detections were made at the old scale
+    detectionCache_.reset();
+    if (motionGate_) {
+        motionGate_->reset();
+    }
+}
+
+void AdvancedCarTracker::setMotionGate(bool enable, int fullScanInterval) {
+    if (!enable) {
+        motionGate_.reset();
+        return;
+    }
+    if (!motionGate_) {
+        motionGate_ = std::make_unique<MotionGate>();
+    }
+    motionGate_->setFullScanInterval(fullScanInterval);
+}
+
+const MotionGate* AdvancedCarTracker::getMotionGate() const {
+    return motionGate_.get();
+}
+
+void AdvancedCarTracker::setDetectionThreshold(float threshold) {
+    if (vehicleDetector_) {
+        vehicleDetector_->setConfidenceThreshold(threshold);
+    }
+}
+
+void AdvancedCarTracker::setDetectionCache(const std::string& directory, const std::string& sourcePath) {
+    detectionCacheDir_ = directory;
+    cacheSourcePath_ = sourcePath;
+    detectionCache_.reset();
+}
+
+bool AdvancedCarTracker::openDetectionCache() {
+    const std::string& source = cacheSourcePath_.empty() ? videoPath_ : cacheSourcePath_;
+    if (source.empty() || !vehicleDetector_) {
+        return false;
+    }
+    
+    uint64_t videoHash = DetectionCache::fingerprintFile(source);
+    if (videoHash == 0) {
+        std::cerr << "Warning: Could not fingerprint " << source << "; detection cache disabled" << std::endl;
+        return false;
+    }
+    
+    // Everything besides the video that changes what the detector sees
+    std::ostringstream config;
+    config << vehicleDetector_->getModelFingerprint() << "|scale=" << resolutionScale;
+    if (frameRing_) {
+        config << "|ring=" << frameRing_->getWidth() << "x" << frameRing_->getHeight();
+    }
+    uint64_t configHash = DetectionCache::hashString(config.str());
+    
+    std::string path = DetectionCache::cachePath(detectionCacheDir_, videoHash, configHash);
+    auto cache = std::make_unique<DetectionCache>();
+    if (!cache->open(path, videoHash, configHash)) {
+        return false;
+    }
+    
+    std::cout << "Detection cache: " << path << " (" << cache->getCachedFrameCount() 
+              << " frames cached)" << std::endl;
+    detectionCache_ = std::move(cache);
+    return true;
+}
+
+DetectionCache* AdvancedCarTracker::getDetectionCache() {
+    if (!detectionCache_ && !detectionCacheDir_.empty()) {
+        openDetectionCache();
+    }
+    return detectionCache_.get();
+}
+
+void AdvancedCarTracker::setSnapshotFile(const std::string& path, int interval) {
+    snapshotPath_ = path;
+    snapshotInterval_ = std::max(1, interval);
+}
+
+bool AdvancedCarTracker::resumeFromSnapshot(const std::string& path) {
+    if (frameRing_ || !videoIngest_.isOpened()) {
+        std::cerr << "Error: Resuming needs a seekable video file" << std::endl;
+        return false;
+    }
+    
+    TrackerSnapshotReader reader;
+    if (!reader.open(path, DetectionCache::fingerprintFile(videoPath_))) {
+        std::cerr << "Error: No tracker snapshots for this video in " << path << std::endl;
+        return false;
+    }
+    TrackingState state;
+    int frameIndex = -1;
+    if (!reader.loadLatest(-1, frameIndex, state)) {
+        std::cerr << "Error: No intact tracker snapshot in " << path << std::endl;
+        return false;
+    }
+    
+    restoreTrackingState(state);
+    videoIngest_.seek(frameIndex + 1);
+    frameCounter = frameIndex + 1;
+    resumeFrame_ = frameIndex;
+    lastSnapshotFrame_ = frameIndex;
+    std::cout << "Resuming after frame " << frameIndex + 1 << " with " << state.advancedTracks.size()
+              << " tracks" << std::endl;
+    return true;
+}
+
+bool AdvancedCarTracker::openSnapshotWriter() {
+    if (frameRing_) {
+        std::cerr << "Error: Tracker snapshots need a video file" << std::endl;
+        return false;
+    }
+    uint64_t videoHash = DetectionCache::fingerprintFile(videoPath_);
+    if (videoHash == 0) {
+        std::cerr << "Error: Could not fingerprint " << videoPath_ << " for snapshots" << std::endl;
+        return false;
+    }
+    auto writer = std::make_unique<TrackerSnapshotWriter>();
+    // A resumed job keeps the snapshots it is resuming from
+    if (!writer->open(snapshotPath_, videoHash, resumeFrame_ >= 0)) {
+        return false;
+    }
+    snapshotWriter_ = std::move(writer);
+    return true;
+}
+
+std::vector<Detection> AdvancedCarTracker::detectFrame(const cv::Mat& frame, int frameIndex) {
+    TRACE_SCOPE("detect");
+    
+    if (frameIndex >= 0 && !detectionCacheDir_.empty() && !detectionCache_) {
+        openDetectionCache();
+        if (!detectionCache_) {
+            detectionCacheDir_.clear();  // Don't retry every frame
+        }
+    }
+    
+    float threshold = vehicleDetector_->getConfidenceThreshold();
+    bool useCache = detectionCache_ && frameIndex >= 0;
+    
+    std::vector<Detection> detections;
+    if (useCache && detectionCache_->lookup(frameIndex, detections)) {
+        detections = VehicleDetector::filterByConfidence(detections, threshold);
+        for (auto& detection : detections) {
+            detection.label = vehicleDetector_->labelForClass(detection.classId);
+        }
+        return detections;
+    }
+    
+    // Scale frame for faster processing, into a buffer kept across frames
+    cv::Mat processedFrame = frame;
+    if (resolutionScale != 1.0f) {
+        cv::Size newSize(frame.cols * resolutionScale, frame.rows * resolutionScale);
+        cv::resize(frame, detectorFrame_, newSize);
+        processedFrame = detectorFrame_;
+    }
+    
+    // Cache misses detect down to the floor so later runs can use any threshold
+    if (useCache) {
+        detections = vehicleDetector_->detectVehiclesRaw(processedFrame, detectionCache_->getFloorThreshold());
+    } else if (motionGate_) {
+        // Track boxes are in source pixels; the gate sees the scaled frame
+        gateTrackBoxes_.clear();
+        for (const auto& track : trackingSystem_->getAdvancedTracks()) {
+            const cv::Rect& box = track.boundingBox;
+            gateTrackBoxes_.emplace_back(cvRound(box.x * resolutionScale), cvRound(box.y * resolutionScale),
+                                         cvRound(box.width * resolutionScale), cvRound(box.height * resolutionScale));
+        }
+        motionGate_->propose(processedFrame, gateTrackBoxes_, gateRegions_);
+        detections = vehicleDetector_->detectVehiclesInRegions(processedFrame, gateRegions_);
+    } else {
+        detections = vehicleDetector_->detectVehicles(processedFrame);
+    }
+    
+    // Scale detections back to original size if needed
+    if (resolutionScale != 1.0f) {
+        for (auto& detection : detections) {
+            detection.boundingBox.x /= resolutionScale;
+            detection.boundingBox.y /= resolutionScale;
+            detection.boundingBox.width /= resolutionScale;
+            detection.boundingBox.height /= resolutionScale;
+        }
+    }
+    
+    if (useCache) {
+        detectionCache_->store(frameIndex, detections);
+        detections = VehicleDetector::filterByConfidence(detections, threshold);
+    }
+    return detections;
 }
 
 bool AdvancedCarTracker::processVideo() {
-    if (!videoCapture_.isOpened()) {
+    if (!videoIngest_.isOpened() && !frameRing_) {
         std::cerr << "Error: No video source available!" << std::endl;
         return false;
     }
@@ -335,23 +799,49 @@ bool AdvancedCarTracker::processVideo() {
     cv::Mat frame;
     int processedFrames = 0;
     auto startTime = std::chrono::high_resolution_clock::now();
+    latencyStats_.reset();
     
     std::cout << "Starting video processing with optimizations:" << std::endl;
     std::cout << "  Frame skip: " << frameSkip << std::endl;
     std::cout << "  Real-time mode: " << (realtimeMode ? "Enabled" : "Disabled") << std::endl;
     std::cout << "  Resolution scale: " << resolutionScale << std::endl;
     
+    if (!snapshotPath_.empty() && !snapshotWriter_ && !openSnapshotWriter()) {
+        return false;
+    }
+    
     while (true) {
-        videoCapture_ >> frame;
-        if (frame.empty()) break;
+        Tracer::setFrame(frameCounter);
+        // A skipped frame only needs pixels to follow the primary target on
+        // or to be written out; otherwise the decoder just steps over it
+        bool skipping = (frameCounter + 1) % frameSkip != 0;
+        bool needPixels = !skipping || videoWriter_.isOpened() || trackingSystem_->getPrimaryTargetId() >= 0;
+        StageTimer decodeTimer(&latencyStats_, LatencyStage::Decode);
+        if (!(needPixels ? readFrame(frame) : skipFrame(frame))) {
+            decodeTimer.cancel();
+            break;
+        }
+        decodeTimer.stop();
         
         frameCounter++;
         
         // Only process every Nth frame based on frameSkip
         if (frameCounter % frameSkip != 0) {
-            // For skipped frames, just write the original frame
-            if (videoWriter_.isOpened()) {
-                videoWriter_.write(frame);
+            metrics_.framesSkipped.fetch_add(1, std::memory_order_relaxed);
+            // The primary target still follows the video between detector
+            // runs; everything else is drawn and exported where its filter
+            // puts it on this frame
+            float framesAhead = framesSince(frameCounter - 1, frameTimestampMs_);
+            if (needPixels) trackingSystem_->trackPrimaryTarget(frame, framesAhead);
+            if (videoWriter_.isOpened() || !exporters_.empty()) {
+                TrackView<AdvancedTrackedVehicle> coasted = trackingSystem_->coastTracks(framesAhead);
+                exportTracks(frameCounter, coasted);
+                if (videoWriter_.isOpened()) {
+                    cv::Mat resultFrame = frame.clone();
+                    trackingSystem_->drawAdvancedTracks(resultFrame, coasted);
+                    trackingSystem_->drawTargetSelection(resultFrame);
+                    videoWriter_.write(resultFrame);
+                }
             }
             continue;
         }
@@ -359,32 +849,25 @@ bool AdvancedCarTracker::processVideo() {
         processedFrames++;
         
         // Process frame
-        auto frameStart = std::chrono::high_resolution_clock::now();
+        StageTimer frameTimer(&latencyStats_, LatencyStage::Frame);
         
-        // Scale frame for faster processing
-        cv::Mat processedFrame = frame;
-        if (resolutionScale != 1.0f) {
-            cv::Size newSize(frame.cols * resolutionScale, frame.rows * resolutionScale);
-            cv::resize(frame, processedFrame, newSize);
-        }
+        // Detect vehicles (or replay them from the cache)
+        std::vector<Detection> detections = detectFrame(frame, frameCounter - 1);
         
-        // Detect vehicles
-        std::vector<Detection> detections = vehicleDetector_->detectVehicles(processedFrame);
+        // Update tracking over the frames since the last processed one
+        float dt = elapsedFrames(frameCounter - 1, frameTimestampMs_);
+        TrackView<AdvancedTrackedVehicle> tracks = trackingSystem_->updateAdvanced(detections, frame, dt);
+        logTracks(frameCounter - 1, tracks);
+        exportTracks(frameCounter, tracks);
+        recordFrameMetrics(detections.size(), tracks.size());
         
-        // Scale detections back to original size if needed
-        if (resolutionScale != 1.0f) {
-            for (auto& detection : detections) {
-                detection.boundingBox.x /= resolutionScale;
-                detection.boundingBox.y /= resolutionScale;
-                detection.boundingBox.width /= resolutionScale;
-                detection.boundingBox.height /= resolutionScale;
-            }
+        if (snapshotWriter_ && frameCounter - 1 - lastSnapshotFrame_ >= snapshotInterval_) {
+            snapshotWriter_->write(frameCounter - 1, trackingSystem_->saveState());
+            lastSnapshotFrame_ = frameCounter - 1;
         }
         
-        // Update tracking
-        std::vector<AdvancedTrackedVehicle> tracks = trackingSystem_->updateAdvanced(detections, frame);
-        
         // Draw results
+        StageTimer renderTimer(&latencyStats_, LatencyStage::Render);
         cv::Mat resultFrame = frame.clone();
         trackingSystem_->drawAdvancedTracks(resultFrame, tracks);
         trackingSystem_->drawTargetSelection(resultFrame);
@@ -396,14 +879,15 @@ bool AdvancedCarTracker::processVideo() {
             cv::putText(resultFrame, info, cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 0), 2);
         }
         
+        renderTimer.stop();
+        
         // Write processed frame
         if (videoWriter_.isOpened()) {
+            StageTimer encodeTimer(&latencyStats_, LatencyStage::Encode);
             videoWriter_.write(resultFrame);
         }
         
-        auto frameEnd = std::chrono::high_resolution_clock::now();
-        auto frameDuration = std::chrono::duration_cast<std::chrono::milliseconds>(frameEnd - frameStart);
-        totalProcessingTime_ += frameDuration.count();
+        totalProcessingTime_ += frameTimer.stop() / 1e6;
         
         // Calculate current FPS
         if (processedFrames > 0) {
@@ -412,9 +896,14 @@ bool AdvancedCarTracker::processVideo() {
         
         // Progress update every 50 processed frames for real-time feel
         if (processedFrames % 50 == 0) {
-            double progress = (double)frameCounter / frameCount_ * 100.0;
-            std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress << "% ";
-            std::cout << "(Frame " << frameCounter << "/" << frameCount_ << ", Processed: " << processedFrames << ") ";
+            // Cameras and live rings have no known length
+            if (frameCount_ > 0) {
+                double progress = (double)frameCounter / frameCount_ * 100.0;
+                std::cout << "Progress: " << std::fixed << std::setprecision(1) << progress << "% ";
+                std::cout << "(Frame " << frameCounter << "/" << frameCount_ << ", Processed: " << processedFrames << ") ";
+            } else {
+                std::cout << "Frame " << frameCounter << ", Processed: " << processedFrames << " ";
+            }
             std::cout << "FPS: " << std::fixed << std::setprecision(1) << averageFPS_ << std::endl;
         }
     }
@@ -435,6 +924,11 @@ bool AdvancedCarTracker::processVideo() {
     std::cout << "Average processing time per frame: " << (totalProcessingTime_ / processedFrames) << " ms" << std::endl;
     std::cout << "Average FPS: " << std::fixed << std::setprecision(2) << averageFPS_ << std::endl;
     std::cout << "Total processing time: " << totalDuration.count() << " ms" << std::endl;
+    if (motionGate_) {
+        std::cout << "Motion gate: " << std::setprecision(1) << motionGate_->getScannedFraction() * 100.0
+                  << "% of pixels scanned, " << motionGate_->getFullScanCount() << " full scans" << std::endl;
+    }
+    latencyStats_.printSummary(std::cout);
     
     return true;
 } 
\ No newline at end of file
@@ -2,6 +2,16 @@
 
 #include "AdvancedTrackingSystem.h"
 #include "VehicleDetector.h"
+#include "SharedFrameRing.h"
+#include "VideoIngest.h"
+#include "TrackLog.h"
+#include "TrackExporter.h"
+#include "DetectionCache.h"
+#include "LatencyHistogram.h"
+#include "TrackerMetrics.h"
+#include "MetricsServer.h"
+#include "TrackerSnapshot.h"
+#include "MotionGate.h"
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <memory>
@@ -10,10 +20,23 @@ class AdvancedCarTracker {
 private:
     std::unique_ptr<AdvancedTrackingSystem> trackingSystem_;
     std::unique_ptr<VehicleDetector> vehicleDetector_;
-    cv::VideoCapture videoCapture_;
+    VideoIngest videoIngest_;
     cv::VideoWriter videoWriter_;
+    std::unique_ptr<SharedFrameRing> frameRing_;
+    std::unique_ptr<TrackLogWriter> trackLog_;
+    std::vector<std::unique_ptr<TrackExporter>> exporters_;
+    std::unique_ptr<DetectionCache> detectionCache_;
+    std::unique_ptr<TrackerSnapshotWriter> snapshotWriter_;
+    std::string snapshotPath_;
+    int snapshotInterval_;
+    int lastSnapshotFrame_;
+    int resumeFrame_;  // Frame restored by resumeFromSnapshot(); -1 when starting fresh
+    std::string detectionCacheDir_;
+    std::string cacheSourcePath_;
+    std::string videoPath_;
     
     bool isRunning_;
+    bool headless_;
     bool showDebugInfo_;
     bool enableRecording_;
     std::string outputVideoPath_;
@@ -28,11 +51,26 @@ private:
     int frameCount_;
     double totalProcessingTime_;
     double averageFPS_;
+    LatencyStats latencyStats_;
+    TrackerMetrics metrics_;
+    std::unique_ptr<MetricsServer> metricsServer_;
     
     int frameSkip;
     int frameCounter;
     bool realtimeMode;
     float resolutionScale;
+    
+    // Frame timing behind the tracker's motion model
+    double frameIntervalMs_;         // From the source's FPS; 0 when unknown
+    double frameTimestampMs_;        // Of the frame readFrame() returned; negative when unknown
+    int lastTrackedFrame_;
+    double lastTrackedTimestampMs_;
+    
+    // Restricts detection to moving regions; null when off
+    std::unique_ptr<MotionGate> motionGate_;
+    std::vector<cv::Rect> gateTrackBoxes_;
+    std::vector<cv::Rect> gateRegions_;
+    cv::Mat detectorFrame_;  // Frame at resolutionScale, reused
 
 public:
     AdvancedCarTracker();
@@ -40,23 +78,57 @@ public:
     
     bool initialize(const std::string& videoPath, const std::string& modelPath = "");
     bool initializeCamera(int cameraIndex = 0);
+    bool initializeSharedMemory(const std::string& ringName);
     void run();
     void stop();
     
     // Configuration
+    // Skips window creation; call before initialize() on machines without a display
+    void setHeadless(bool headless);
+    // FFmpeg decoder threads (0: FFmpeg's choice) and hardware decoding for
+    // video files; call before initialize()
+    void setDecodeOptions(int threads, bool hardwareDecode);
     void setDebugMode(bool enable);
     void setRecordingMode(bool enable, const std::string& outputPath = "");
     void setTargetSelectionMode(bool enable);
+    bool setTrackLogPath(const std::string& path);
+    bool addExporter(const std::string& path, ExportFormat format);
+    void setDetectionThreshold(float threshold);
+    // Replays detections from (and records them into) a cache in this
+    // directory. sourcePath names the original video when frames arrive
+    // over shared memory; otherwise the opened video file is used.
+    void setDetectionCache(const std::string& directory, const std::string& sourcePath = "");
+    // Opens the configured cache if needed; null when caching is off or unavailable
+    DetectionCache* getDetectionCache();
+    // processVideo() appends the tracker state to path every `interval` frames
+    void setSnapshotFile(const std::string& path, int interval);
+    // Restores the latest snapshot for this video and continues after its
+    // frame. Call after initialize() and before addExporter() and
+    // setTrackLogPath(), which then keep existing rows up to that frame
+    // instead of starting over.
+    bool resumeFromSnapshot(const std::string& path);
     
     // Interactive features
     void handleMouseClick(int x, int y);
     void selectTarget(const cv::Point& point);
     void clearTargetSelection();
     
+    // Tracker state after the last processed frame, including the selected
+    // target; lets the controller rewind without re-tracking
+    TrackingState saveTrackingState() const;
+    void restoreTrackingState(const TrackingState& state);
+    
     // Performance monitoring
     double getAverageFPS() const;
     int getFrameCount() const;
     double getTotalProcessingTime() const;
+    // Per-stage latency histograms; safe to read while frames are processed
+    const LatencyStats& getLatencyStats() const;
+    // Counters and gauges behind the metrics endpoint
+    const TrackerMetrics& getMetrics() const;
+    // Serves Prometheus metrics on "port", "host:port" or "unix:/path"
+    // until stop(); scrapes never block frame processing
+    bool startMetricsServer(const std::string& endpoint);
     
     // Advanced features
     void enablePartialOcclusionHandling(bool enable);
@@ -67,7 +139,9 @@ public:
     void setCameraMotionSensitivity(float sensitivity);
     
     // Frame processing (public for controller access)
-    void processFrame(const cv::Mat& frame);
+    // frameIndex is the frame's position in the source; it enables the
+    // detection cache and is ignored when negative
+    void processFrame(const cv::Mat& frame, int frameIndex = -1);
     
     bool processVideo();
     
@@ -75,14 +149,38 @@ public:
     void setFrameSkip(int skip);
     void setRealtimeMode(bool mode);
     void setResolutionScale(float scale);
+    // Runs the detector only on tiles that changed once camera motion is
+    // removed, plus the tiles under current tracks, with a whole-frame scan
+    // every fullScanInterval frames. Replayed detections are not gated.
+    void setMotionGate(bool enable, int fullScanInterval = 15);
+    // Null when the gate is off
+    const MotionGate* getMotionGate() const;
 
 private:
+    bool readFrame(cv::Mat& frame);
+    // Advances past a frame processVideo() will not look at, without
+    // converting it when the source allows
+    bool skipFrame(cv::Mat& frame);
+    // Frames elapsed since the last tracked frame, for the Kalman step.
+    // Timestamps win over indices when both are known, so dropped and
+    // variable-rate frames are measured rather than assumed.
+    float elapsedFrames(int frameIndex, double timestampMs);
+    // The same measurement without moving the last tracked frame, for
+    // skipped frames that carry the primary target forward in between
+    float framesSince(int frameIndex, double timestampMs) const;
+    void resetFrameTiming();
+    std::vector<Detection> detectFrame(const cv::Mat& frame, int frameIndex);
+    bool openDetectionCache();
+    void logTracks(int frameIndex, TrackView<AdvancedTrackedVehicle> tracks);
+    void exportTracks(int frameNumber, TrackView<AdvancedTrackedVehicle> tracks);
     void drawUI(cv::Mat& frame);
     void drawPerformanceInfo(cv::Mat& frame);
     void drawTargetInfo(cv::Mat& frame);
     void handleKeyPress(int key);
     void saveFrame(const cv::Mat& frame);
     void updatePerformanceMetrics(double processingTime);
+    void recordFrameMetrics(size_t detections, size_t activeTracks);
+    bool openSnapshotWriter();
     
     // Mouse callback wrapper
     static void onMouse(int event, int x, int y, int flags, void* userdata);
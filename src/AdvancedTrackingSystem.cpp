@@ -1,13 +1,119 @@
 #include "AdvancedTrackingSystem.h"
+#include "Tracer.h"
+#include "TrackerPolicies.h"
 #include <iostream>
 #include <algorithm>
+#include <cstdio>
 #include <opencv2/features2d.hpp>
 #include <opencv2/xfeatures2d.hpp>
 
+namespace {
+
+// cv::KalmanFilter copies share their matrices, and predict()/correct()
+// write into them in place
+cv::KalmanFilter cloneKalmanFilter(const cv::KalmanFilter& source) {
+    cv::KalmanFilter copy;
+    copy.statePre = source.statePre.clone();
+    copy.statePost = source.statePost.clone();
+    copy.transitionMatrix = source.transitionMatrix.clone();
+    copy.controlMatrix = source.controlMatrix.clone();
+    copy.measurementMatrix = source.measurementMatrix.clone();
+    copy.processNoiseCov = source.processNoiseCov.clone();
+    copy.measurementNoiseCov = source.measurementNoiseCov.clone();
+    copy.errorCovPre = source.errorCovPre.clone();
+    copy.gain = source.gain.clone();
+    copy.errorCovPost = source.errorCovPost.clone();
+    copy.temp1 = source.temp1.clone();
+    copy.temp2 = source.temp2.clone();
+    copy.temp3 = source.temp3.clone();
+    copy.temp4 = source.temp4.clone();
+    copy.temp5 = source.temp5.clone();
+    return copy;
+}
+
+std::vector<TrackedVehicle> cloneTracks(const std::vector<TrackedVehicle>& source) {
+    std::vector<TrackedVehicle> copy(source);
+    for (size_t i = 0; i < copy.size(); ++i) {
+        copy[i].kalmanFilter = cloneKalmanFilter(source[i].kalmanFilter);
+    }
+    return copy;
+}
+
+std::vector<AdvancedTrackedVehicle> cloneTracks(const std::vector<AdvancedTrackedVehicle>& source) {
+    std::vector<AdvancedTrackedVehicle> copy(source);
+    for (size_t i = 0; i < copy.size(); ++i) {
+        copy[i].kalmanFilter = cloneKalmanFilter(source[i].kalmanFilter);
+        copy[i].appearanceFeatures = source[i].appearanceFeatures.clone();
+        copy[i].featureHistory = source[i].featureHistory.clone();
+    }
+    return copy;
+}
+
+size_t matBytes(const cv::Mat& mat) {
+    return mat.total() * mat.elemSize();
+}
+
+size_t kalmanBytes(const cv::KalmanFilter& filter) {
+    return matBytes(filter.statePre) + matBytes(filter.statePost) + matBytes(filter.transitionMatrix) +
+           matBytes(filter.processNoiseCov) + matBytes(filter.measurementMatrix) +
+           matBytes(filter.measurementNoiseCov) + matBytes(filter.errorCovPre) +
+           matBytes(filter.errorCovPost) + matBytes(filter.gain);
+}
+
+} // namespace
+
+void FeatureHistory::push(const cv::Mat& features) {
+    // Older snapshots recorded frames without features as empty entries
+    if (features.empty()) return;
+    for (auto& slot : slots_) {
+        if (slot.empty()) slot.create(features.size(), features.type());
+    }
+    size_t slot = (head_ + size_) % kCapacity;
+    if (size_ == kCapacity) {
+        head_ = (head_ + 1) % kCapacity;
+    } else {
+        size_++;
+    }
+    features.copyTo(slots_[slot]);
+}
+
+void FeatureHistory::clear() {
+    head_ = 0;
+    size_ = 0;
+}
+
+FeatureHistory FeatureHistory::clone() const {
+    FeatureHistory copy;
+    copy.head_ = head_;
+    copy.size_ = size_;
+    for (size_t i = 0; i < kCapacity; ++i) {
+        copy.slots_[i] = slots_[i].clone();
+    }
+    return copy;
+}
+
+size_t TrackingState::byteSize() const {
+    size_t bytes = sizeof(TrackingState) + matBytes(previousFrame);
+    for (const auto& track : tracks) {
+        bytes += sizeof(track) + kalmanBytes(track.kalmanFilter);
+    }
+    for (const auto& track : advancedTracks) {
+        bytes += sizeof(track) + kalmanBytes(track.kalmanFilter) +
+                 matBytes(track.appearanceFeatures) + track.uniqueSignature.capacity();
+        for (size_t i = 0; i < track.featureHistory.size(); ++i) {
+            bytes += matBytes(track.featureHistory[i]);
+        }
+    }
+    return bytes;
+}
+
 AdvancedTrackingSystem::AdvancedTrackingSystem() 
     : primaryTargetId_(-1), partialTrackingEnabled_(true), reIdEnabled_(true),
       cameraMotionCompensationEnabled_(true), occlusionThreshold_(0.3f),
-      reIdThreshold_(0.7f), cameraMotionSensitivity_(0.1f) {
+      reIdThreshold_(0.7f), cameraMotionSensitivity_(0.1f), latencyStats_(nullptr),
+      reIdHits_(0),
+      appearanceHog_(cv::Size(64, 64), cv::Size(16, 16), cv::Size(8, 8), cv::Size(8, 8), 9),
+      correlationTargetId_(-1) {
 }
 
 AdvancedTrackingSystem::~AdvancedTrackingSystem() {
@@ -15,13 +121,18 @@ AdvancedTrackingSystem::~AdvancedTrackingSystem() {
 
 void AdvancedTrackingSystem::initialize() {
     TrackingSystem::initialize();
-    advancedTracks_.clear();
+    clearAdvancedTracks();
     primaryTargetId_ = -1;
     globalCameraMotion_ = cv::Point2f(0, 0);
+    resetPrimaryCorrelation();
 }
 
-std::vector<AdvancedTrackedVehicle> AdvancedTrackingSystem::updateAdvanced(
-    const std::vector<Detection>& detections, const cv::Mat& frame) {
+TrackView<AdvancedTrackedVehicle> AdvancedTrackingSystem::updateAdvanced(
+    ConstSpan<Detection> detections, const cv::Mat& frame, float dt) {
+    TRACE_SCOPE("updateAdvanced");
+    FrameArenaScope arenaScope(frameArena_);
+    
+    StageTimer cameraMotionTimer(latencyStats_, LatencyStage::CameraMotion);
     
     // Update camera motion if enabled
     if (cameraMotionCompensationEnabled_ && !previousFrame_.empty()) {
@@ -29,13 +140,19 @@ std::vector<AdvancedTrackedVehicle> AdvancedTrackingSystem::updateAdvanced(
     }
     
     // Compensate for camera motion in detections
-    std::vector<Detection> compensatedDetections = detections;
+    ArenaVector<Detection> compensatedDetections(detections.begin(), detections.end(),
+                                                 ArenaAllocator<Detection>(&frameArena_));
     if (cameraMotionCompensationEnabled_) {
         compensateCameraMotion(compensatedDetections);
     }
+    cameraMotionTimer.stop();
     
     // Update advanced tracks
-    updateAdvancedTracks(compensatedDetections, frame);
+    StageTimer associationTimer(latencyStats_, LatencyStage::Association);
+    updateAdvancedTracks(compensatedDetections, frame, dt);
+    associationTimer.stop();
+    
+    StageTimer appearanceTimer(latencyStats_, LatencyStage::Appearance);
     
     // Handle partial occlusion for all tracks
     for (auto& track : advancedTracks_) {
@@ -47,46 +164,66 @@ std::vector<AdvancedTrackedVehicle> AdvancedTrackingSystem::updateAdvanced(
     
     // Handle target reacquisition for primary target
     if (primaryTargetId_ >= 0) {
-        auto primaryTrack = std::find_if(advancedTracks_.begin(), advancedTracks_.end(),
-            [this](const AdvancedTrackedVehicle& track) {
-                return track.id == primaryTargetId_;
-            });
-        
-        if (primaryTrack != advancedTracks_.end() && primaryTrack->isActive) {
-            handleTargetReacquisition(*primaryTrack, compensatedDetections);
+        AdvancedTrackedVehicle* primaryTrack = findAdvancedTrack(primaryTargetId_);
+        if (primaryTrack && primaryTrack->isActive) {
+            handleTargetReacquisition(*primaryTrack, compensatedDetections, frame);
         }
     }
     
     // Merge similar tracks
-    mergeSimilarTracks();
+    {
+        TRACE_SCOPE("merge_tracks");
+        mergeSimilarTracks();
+    }
+    appearanceTimer.stop();
     
     // Store current frame for next iteration
     frame.copyTo(previousFrame_);
     
-    // Return active tracks
-    std::vector<AdvancedTrackedVehicle> activeTracks;
-    for (const auto& track : advancedTracks_) {
-        if (track.isActive) {
-            activeTracks.push_back(track);
-        }
-    }
-    
-    return activeTracks;
+    return getAdvancedTracks();
+}
+
+TrackView<AdvancedTrackedVehicle> AdvancedTrackingSystem::getAdvancedTracks() const {
+    return TrackView<AdvancedTrackedVehicle>(advancedTracks_.data(),
+                                             advancedTracks_.data() + advancedTracks_.size());
+}
+
+AdvancedTrackedVehicle* AdvancedTrackingSystem::findAdvancedTrack(int id) {
+    auto slot = advancedTrackSlots_.find(id);
+    return slot != advancedTrackSlots_.end() ? advancedTracks_.get(slot->second) : nullptr;
+}
+
+AdvancedTrackedVehicle& AdvancedTrackingSystem::addAdvancedTrack(AdvancedTrackedVehicle track) {
+    int id = track.id;
+    SlotHandle handle = advancedTracks_.insert(std::move(track));
+    advancedTrackSlots_[id] = handle;
+    return *advancedTracks_.get(handle);
+}
+
+// The base tracker dropped this track; without this the advanced table
+// would keep it, and iterate over it, for the rest of the video
+void AdvancedTrackingSystem::retireTrack(const TrackedVehicle& track) {
+    auto slot = advancedTrackSlots_.find(track.id);
+    if (slot == advancedTrackSlots_.end()) return;
+    advancedTracks_.erase(slot->second);
+    advancedTrackSlots_.erase(slot);
+}
+
+void AdvancedTrackingSystem::clearAdvancedTracks() {
+    advancedTracks_.clear();
+    advancedTrackSlots_.clear();
 }
 
-void AdvancedTrackingSystem::updateAdvancedTracks(const std::vector<Detection>& detections, 
-                                                  const cv::Mat& frame) {
+void AdvancedTrackingSystem::updateAdvancedTracks(ConstSpan<Detection> detections, 
+                                                  const cv::Mat& frame, float dt) {
     // First, update basic tracking
-    std::vector<TrackedVehicle> basicTracks = TrackingSystem::update(detections, frame);
+    TrackView<TrackedVehicle> basicTracks = TrackingSystem::update(detections, frame, dt);
     
     // Update advanced tracks with basic tracking results
     for (const auto& basicTrack : basicTracks) {
-        auto advancedTrack = std::find_if(advancedTracks_.begin(), advancedTracks_.end(),
-            [&basicTrack](const AdvancedTrackedVehicle& track) {
-                return track.id == basicTrack.id;
-            });
+        AdvancedTrackedVehicle* advancedTrack = findAdvancedTrack(basicTrack.id);
         
-        if (advancedTrack != advancedTracks_.end()) {
+        if (advancedTrack) {
             // Update basic properties
             advancedTrack->boundingBox = basicTrack.boundingBox;
             advancedTrack->confidence = basicTrack.confidence;
@@ -95,14 +232,9 @@ void AdvancedTrackingSystem::updateAdvancedTracks(const std::vector<Detection>&
             advancedTrack->isActive = basicTrack.isActive;
             
             // Update appearance features
-            if (!frame.empty() && !basicTrack.boundingBox.empty()) {
-                advancedTrack->appearanceFeatures = extractAppearanceFeatures(frame, basicTrack.boundingBox);
-                advancedTrack->featureHistory.push_back(advancedTrack->appearanceFeatures.clone());
-                
-                // Keep only last 10 features
-                if (advancedTrack->featureHistory.size() > 10) {
-                    advancedTrack->featureHistory.pop_front();
-                }
+            if (!frame.empty() && !basicTrack.boundingBox.empty() &&
+                extractAppearanceFeatures(frame, basicTrack.boundingBox, advancedTrack->appearanceFeatures)) {
+                advancedTrack->featureHistory.push(advancedTrack->appearanceFeatures);
             }
             
             // Update velocity history
@@ -111,22 +243,22 @@ void AdvancedTrackingSystem::updateAdvancedTracks(const std::vector<Detection>&
             // Generate unique signature
             generateUniqueSignature(*advancedTrack);
         } else {
-            // Create new advanced track
-            AdvancedTrackedVehicle newTrack;
-            newTrack.id = basicTrack.id;
+            // Create new advanced track in place
+            AdvancedTrackedVehicle created;
+            created.id = basicTrack.id;
+            AdvancedTrackedVehicle& newTrack = addAdvancedTrack(std::move(created));
             newTrack.boundingBox = basicTrack.boundingBox;
             newTrack.confidence = basicTrack.confidence;
             newTrack.label = basicTrack.label;
             newTrack.velocity = basicTrack.velocity;
             newTrack.isActive = basicTrack.isActive;
             
-            if (!frame.empty() && !basicTrack.boundingBox.empty()) {
-                newTrack.appearanceFeatures = extractAppearanceFeatures(frame, basicTrack.boundingBox);
-                newTrack.featureHistory.push_back(newTrack.appearanceFeatures.clone());
+            if (!frame.empty() && !basicTrack.boundingBox.empty() &&
+                extractAppearanceFeatures(frame, basicTrack.boundingBox, newTrack.appearanceFeatures)) {
+                newTrack.featureHistory.push(newTrack.appearanceFeatures);
             }
             
             generateUniqueSignature(newTrack);
-            advancedTracks_.push_back(newTrack);
         }
     }
 }
@@ -192,34 +324,32 @@ void AdvancedTrackingSystem::estimateFullBoundingBox(AdvancedTrackedVehicle& tra
     }
 }
 
-cv::Mat AdvancedTrackingSystem::extractAppearanceFeatures(const cv::Mat& frame, const cv::Rect& roi) {
+bool AdvancedTrackingSystem::extractAppearanceFeatures(const cv::Mat& frame, const cv::Rect& roi,
+                                                       cv::Mat& features) {
     if (roi.empty() || roi.x < 0 || roi.y < 0 || 
         roi.x + roi.width > frame.cols || roi.y + roi.height > frame.rows) {
-        return cv::Mat();
+        features.release();
+        return false;
     }
     
     cv::Mat roiMat = frame(roi);
     
     // Resize to standard size for feature extraction
-    cv::Mat resizedRoi;
-    cv::resize(roiMat, resizedRoi, cv::Size(64, 64));
+    cv::resize(roiMat, resizedRoi_, cv::Size(64, 64));
     
     // Convert to grayscale
-    cv::Mat grayRoi;
-    if (resizedRoi.channels() == 3) {
-        cv::cvtColor(resizedRoi, grayRoi, cv::COLOR_BGR2GRAY);
-    } else {
-        grayRoi = resizedRoi.clone();
+    const cv::Mat* grayRoi = &resizedRoi_;
+    if (resizedRoi_.channels() == 3) {
+        cv::cvtColor(resizedRoi_, grayRoi_, cv::COLOR_BGR2GRAY);
+        grayRoi = &grayRoi_;
     }
     
     // Extract HOG features
-    cv::HOGDescriptor hog(cv::Size(64, 64), cv::Size(16, 16), cv::Size(8, 8), cv::Size(8, 8), 9);
-    std::vector<float> descriptors;
-    hog.compute(grayRoi, descriptors);
+    appearanceHog_.compute(*grayRoi, descriptors_);
     
-    // Convert to Mat
-    cv::Mat features(descriptors);
-    return features.reshape(1, 1);
+    // Copy out of the scratch vector, which the next call overwrites
+    cv::Mat(descriptors_).reshape(1, 1).copyTo(features);
+    return true;
 }
 
 float AdvancedTrackingSystem::calculateReIdScore(const cv::Mat& features1, const cv::Mat& features2) {
@@ -239,20 +369,19 @@ float AdvancedTrackingSystem::calculateReIdScore(const cv::Mat& features1, const
 
 void AdvancedTrackingSystem::updateCameraMotion(const cv::Mat& currentFrame, const cv::Mat& previousFrame) {
     // Use optical flow to estimate camera motion
-    cv::Mat grayCurrent, grayPrevious;
-    cv::cvtColor(currentFrame, grayCurrent, cv::COLOR_BGR2GRAY);
-    cv::cvtColor(previousFrame, grayPrevious, cv::COLOR_BGR2GRAY);
+    cv::cvtColor(currentFrame, grayCurrent_, cv::COLOR_BGR2GRAY);
+    cv::cvtColor(previousFrame, grayPrevious_, cv::COLOR_BGR2GRAY);
     
     // Detect good features to track
-    std::vector<cv::Point2f> prevPts, nextPts;
-    cv::goodFeaturesToTrack(grayPrevious, prevPts, 100, 0.01, 10);
+    std::vector<cv::Point2f>& prevPts = previousPoints_;
+    std::vector<cv::Point2f>& nextPts = nextPoints_;
+    cv::goodFeaturesToTrack(grayPrevious_, prevPts, 100, 0.01, 10);
     
     if (prevPts.empty()) return;
     
     // Calculate optical flow
-    std::vector<uchar> status;
-    std::vector<float> err;
-    cv::calcOpticalFlowPyrLK(grayPrevious, grayCurrent, prevPts, nextPts, status, err);
+    std::vector<uchar>& status = flowStatus_;
+    cv::calcOpticalFlowPyrLK(grayPrevious_, grayCurrent_, prevPts, nextPts, status, flowError_);
     
     // Calculate average motion
     cv::Point2f totalMotion(0, 0);
@@ -270,7 +399,7 @@ void AdvancedTrackingSystem::updateCameraMotion(const cv::Mat& currentFrame, con
     }
 }
 
-void AdvancedTrackingSystem::compensateCameraMotion(std::vector<Detection>& detections) {
+void AdvancedTrackingSystem::compensateCameraMotion(ArenaVector<Detection>& detections) {
     for (auto& detection : detections) {
         detection.boundingBox.x += static_cast<int>(globalCameraMotion_.x);
         detection.boundingBox.y += static_cast<int>(globalCameraMotion_.y);
@@ -315,7 +444,10 @@ cv::Point2f AdvancedTrackingSystem::calculatePredictedPosition(const AdvancedTra
 }
 
 void AdvancedTrackingSystem::handleTargetReacquisition(AdvancedTrackedVehicle& track, 
-                                                       const std::vector<Detection>& detections) {
+                                                       ConstSpan<Detection> detections,
+                                                       const cv::Mat& frame) {
+    fusePrimaryCorrelation(track, frame);
+    
     if (!reIdEnabled_) return;
     
     // If primary target is lost, try to re-identify it
@@ -325,12 +457,12 @@ void AdvancedTrackingSystem::handleTargetReacquisition(AdvancedTrackedVehicle& t
         
         for (size_t i = 0; i < detections.size(); ++i) {
             // Calculate re-identification score
-            cv::Mat detectionFeatures = extractAppearanceFeatures(cv::Mat(), detections[i].boundingBox);
-            float score = calculateReIdScore(track.appearanceFeatures, detectionFeatures);
+            if (!extractAppearanceFeatures(frame, detections[i].boundingBox, detectionFeatures_)) continue;
+            float score = calculateReIdScore(track.appearanceFeatures, detectionFeatures_);
             
             if (score > bestScore && score > reIdThreshold_) {
                 bestScore = score;
-                bestDetectionIdx = i;
+                bestDetectionIdx = static_cast<int>(i);
             }
         }
         
@@ -343,6 +475,9 @@ void AdvancedTrackingSystem::handleTargetReacquisition(AdvancedTrackedVehicle& t
             track.isPartiallyOccluded = false;
             track.visibilityRatio = 1.0f;
             track.reIdScore = static_cast<int>(bestScore * 100);
+            reIdHits_++;
+            primaryCorrelation_.initialize(frame, track.boundingBox);
+            correlationTargetId_ = track.id;
             
             std::cout << "Re-acquired primary target " << track.id 
                       << " with score: " << bestScore << std::endl;
@@ -383,21 +518,25 @@ void AdvancedTrackingSystem::mergeSimilarTracks() {
 
 void AdvancedTrackingSystem::generateUniqueSignature(AdvancedTrackedVehicle& track) {
     // Generate a unique signature based on appearance and motion
-    std::string signature = track.label + "_";
-    signature += std::to_string(track.boundingBox.width) + "x" + std::to_string(track.boundingBox.height) + "_";
-    signature += std::to_string(static_cast<int>(track.velocity.x)) + "_" + std::to_string(static_cast<int>(track.velocity.y));
-    
-    track.uniqueSignature = signature;
+    // Formatted in place: once the string has grown, updates reuse its buffer
+    char signature[128];
+    int length = std::snprintf(signature, sizeof(signature), "%s_%dx%d_%d_%d",
+                               labelName(track.label).c_str(),
+                               track.boundingBox.width, track.boundingBox.height,
+                               static_cast<int>(track.velocity.x), static_cast<int>(track.velocity.y));
+    track.uniqueSignature.assign(signature, std::min<size_t>(std::max(length, 0), sizeof(signature) - 1));
 }
 
 // Target management methods
 void AdvancedTrackingSystem::setPrimaryTarget(int targetId) {
     primaryTargetId_ = targetId;
+    resetPrimaryCorrelation();
     std::cout << "Primary target set to: " << targetId << std::endl;
 }
 
 void AdvancedTrackingSystem::clearPrimaryTarget() {
     primaryTargetId_ = -1;
+    resetPrimaryCorrelation();
 }
 
 int AdvancedTrackingSystem::getPrimaryTargetId() const {
@@ -408,6 +547,102 @@ bool AdvancedTrackingSystem::isPrimaryTarget(int trackId) const {
     return trackId == primaryTargetId_;
 }
 
+bool AdvancedTrackingSystem::trackPrimaryTarget(const cv::Mat& frame, float framesSinceUpdate) {
+    TRACE_SCOPE("trackPrimaryTarget");
+    if (primaryTargetId_ < 0 || frame.empty()) return false;
+    
+    AdvancedTrackedVehicle* track = findAdvancedTrack(primaryTargetId_);
+    if (!track || !track->isActive) return false;
+    
+    if (correlationTargetId_ != track->id) {
+        // First sighting of this target: train on it, nothing to move yet
+        if (primaryCorrelation_.initialize(frame, track->boundingBox)) {
+            correlationTargetId_ = track->id;
+        }
+        return false;
+    }
+    
+    cv::Rect box;
+    if (!primaryCorrelation_.update(frame, box)) return false;
+    anchorPrimaryTrack(*track, box, framesSinceUpdate);
+    return true;
+}
+
+TrackView<AdvancedTrackedVehicle> AdvancedTrackingSystem::coastTracks(float framesSinceUpdate) {
+    TRACE_SCOPE("coastTracks");
+    size_t count = 0;
+    for (const auto& track : getAdvancedTracks()) {
+        if (count == coastedTracks_.size()) coastedTracks_.emplace_back();
+        AdvancedTrackedVehicle& coasted = coastedTracks_[count++];
+        // Only what drawing and export read; the filter, features and
+        // signature stay behind in the live table
+        coasted.id = track.id;
+        coasted.boundingBox = track.boundingBox;
+        coasted.velocity = track.velocity;
+        coasted.confidence = track.confidence;
+        coasted.label = track.label;
+        coasted.isActive = track.isActive;
+        coasted.visibilityRatio = track.visibilityRatio;
+        coasted.isPartiallyOccluded = track.isPartiallyOccluded;
+        coasted.estimatedFullBox = track.estimatedFullBox;
+        
+        // A re-anchored primary target is already part of the way there
+        const TrackedVehicle* base = findTrack(track.id);
+        if (!base) continue;
+        float step = std::max(framesSinceUpdate - base->framesAhead, 0.0f);
+        coasted.boundingBox = predictKalmanPosition(*base, step);
+        coasted.estimatedFullBox += coasted.boundingBox.tl() - track.boundingBox.tl();
+    }
+    return TrackView<AdvancedTrackedVehicle>(coastedTracks_.data(), coastedTracks_.data() + count);
+}
+
+void AdvancedTrackingSystem::fusePrimaryCorrelation(AdvancedTrackedVehicle& track, const cv::Mat& frame) {
+    if (frame.empty() || !track.isActive) return;
+    
+    if (correlationTargetId_ != track.id) {
+        if (primaryCorrelation_.initialize(frame, track.boundingBox)) {
+            correlationTargetId_ = track.id;
+        }
+        return;
+    }
+    
+    // A detector hit wins: re-anchor the filter on it so it cannot drift.
+    // Otherwise the filter bridges the detector's miss.
+    const TrackedVehicle* base = findTrack(track.id);
+    if (base && base->consecutiveMisses == 0) {
+        primaryCorrelation_.correct(frame, track.boundingBox);
+        return;
+    }
+    
+    cv::Rect box;
+    if (primaryCorrelation_.update(frame, box)) {
+        // This frame's predict has already run
+        anchorPrimaryTrack(track, box, 0.0f);
+    }
+}
+
+void AdvancedTrackingSystem::anchorPrimaryTrack(AdvancedTrackedVehicle& track, const cv::Rect& box,
+                                                float framesSinceUpdate) {
+    track.boundingBox = box;
+    
+    TrackedVehicle* base = findTrack(track.id);
+    if (!base) return;
+    if (framesSinceUpdate > base->framesAhead) {
+        // Carry the filter from its last frame to this one before correcting
+        KalmanMotion::setTimeStep(base->kalmanFilter, framesSinceUpdate - base->framesAhead);
+        base->kalmanFilter.predict();
+        base->framesAhead = framesSinceUpdate;
+    }
+    updateKalmanFilter(*base, box);
+    base->boundingBox = box;
+    base->consecutiveMisses = 0;
+}
+
+void AdvancedTrackingSystem::resetPrimaryCorrelation() {
+    primaryCorrelation_.reset();
+    correlationTargetId_ = -1;
+}
+
 // Configuration methods
 void AdvancedTrackingSystem::setOcclusionThreshold(float threshold) {
     occlusionThreshold_ = threshold;
@@ -433,21 +668,65 @@ void AdvancedTrackingSystem::setCameraMotionSensitivity(float sensitivity) {
     cameraMotionSensitivity_ = sensitivity;
 }
 
+void AdvancedTrackingSystem::setLatencyStats(LatencyStats* stats) {
+    latencyStats_ = stats;
+}
+
+TrackingState AdvancedTrackingSystem::saveState() const {
+    TrackingState state;
+    state.tracks = cloneTracks(tracks_);
+    state.advancedTracks = cloneTracks(advancedTracks_.values());
+    state.nextId = nextId_;
+    state.primaryTargetId = primaryTargetId_;
+    state.previousFrame = previousFrame_.clone();
+    state.globalCameraMotion = globalCameraMotion_;
+    state.reIdHits = reIdHits_;
+    return state;
+}
+
+void AdvancedTrackingSystem::restoreState(const TrackingState& state) {
+    // Cloned again so the saved state can be restored more than once
+    tracks_ = cloneTracks(state.tracks);
+    rebuildTrackIndex();
+    clearAdvancedTracks();
+    for (auto& track : cloneTracks(state.advancedTracks)) {
+        addAdvancedTrack(std::move(track));
+    }
+    nextId_ = state.nextId;
+    primaryTargetId_ = state.primaryTargetId;
+    previousFrame_ = state.previousFrame.clone();
+    globalCameraMotion_ = state.globalCameraMotion;
+    reIdHits_ = state.reIdHits;
+    // The filter is not part of the state; it retrains on the next frame
+    resetPrimaryCorrelation();
+}
+
+size_t AdvancedTrackingSystem::getLostTrackCount() const {
+    // Retired tracks are erased, so lost means alive but missed this frame
+    return std::count_if(tracks_.begin(), tracks_.end(),
+                         [](const TrackedVehicle& track) { return track.isActive && track.consecutiveMisses > 0; });
+}
+
+uint64_t AdvancedTrackingSystem::getReIdHits() const {
+    return reIdHits_;
+}
+
 // Visualization methods
 void AdvancedTrackingSystem::drawAdvancedTracks(cv::Mat& frame, 
-                                                const std::vector<AdvancedTrackedVehicle>& tracks) {
+                                                TrackView<AdvancedTrackedVehicle> tracks) {
     for (const auto& track : tracks) {
-        if (!track.isActive) continue;
-        
         // Choose color based on track status
+        static const LabelId car = internLabel("car");
+        static const LabelId truck = internLabel("truck");
+        
         cv::Scalar color;
         if (track.id == primaryTargetId_) {
             color = cv::Scalar(0, 255, 255); // Yellow for primary target
         } else if (track.isPartiallyOccluded) {
             color = cv::Scalar(0, 165, 255); // Orange for occluded
-        } else if (track.label == "car") {
+        } else if (track.label == car) {
             color = cv::Scalar(0, 255, 0); // Green for cars
-        } else if (track.label == "truck") {
+        } else if (track.label == truck) {
             color = cv::Scalar(0, 0, 255); // Red for trucks
         } else {
             color = cv::Scalar(255, 255, 0); // Cyan for others
@@ -462,7 +741,7 @@ void AdvancedTrackingSystem::drawAdvancedTracks(cv::Mat& frame,
         }
         
         // Draw ID and label
-        std::string label = track.label + " #" + std::to_string(track.id);
+        std::string label = labelName(track.label) + " #" + std::to_string(track.id);
         if (track.id == primaryTargetId_) {
             label += " [PRIMARY]";
         }
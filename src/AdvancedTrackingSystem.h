@@ -1,16 +1,42 @@
 #pragma once
 
 #include "TrackingSystem.h"
+#include "LatencyHistogram.h"
+#include "SlotMap.h"
+#include "CorrelationTracker.h"
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <memory>
 #include <unordered_map>
-#include <deque>
+#include <array>
+
+// The last kCapacity appearance feature vectors of a track, oldest first.
+// Every slot is sized on the first push and overwritten in place after
+// that, so recording features each frame does not allocate.
+class FeatureHistory {
+public:
+    static constexpr size_t kCapacity = 10;
+    
+    FeatureHistory() : head_(0), size_(0) {}
+    
+    // Copies features into the ring, replacing the oldest entry when full
+    void push(const cv::Mat& features);
+    void clear();
+    size_t size() const { return size_; }
+    const cv::Mat& operator[](size_t index) const { return slots_[(head_ + index) % kCapacity]; }
+    // Copies share slot buffers with the original; saved states need this
+    FeatureHistory clone() const;
+    
+private:
+    std::array<cv::Mat, kCapacity> slots_;
+    size_t head_;  // Slot of the oldest entry
+    size_t size_;
+};
 
 struct AdvancedTrackedVehicle : public TrackedVehicle {
     // Appearance features for re-identification
     cv::Mat appearanceFeatures;
-    std::deque<cv::Mat> featureHistory;
+    FeatureHistory featureHistory;
     
     // Occlusion handling
     float visibilityRatio;  // 0.0 = fully occluded, 1.0 = fully visible
@@ -33,20 +59,50 @@ struct AdvancedTrackedVehicle : public TrackedVehicle {
                               motionConfidence(0.0f), reIdScore(0) {}
 };
 
+// Everything updateAdvanced() carries from one frame to the next. Matrices
+// are deep copies, so a saved state is unaffected by later frames.
+struct TrackingState {
+    std::vector<TrackedVehicle> tracks;
+    std::vector<AdvancedTrackedVehicle> advancedTracks;
+    int nextId;
+    int primaryTargetId;
+    cv::Mat previousFrame;
+    cv::Point2f globalCameraMotion;
+    uint64_t reIdHits;
+    
+    TrackingState() : nextId(0), primaryTargetId(-1), reIdHits(0) {}
+    
+    // Approximate heap footprint, for cache budgets
+    size_t byteSize() const;
+};
+
 class AdvancedTrackingSystem : public TrackingSystem {
 public:
     AdvancedTrackingSystem();
     ~AdvancedTrackingSystem();
     
     void initialize();
-    std::vector<AdvancedTrackedVehicle> updateAdvanced(const std::vector<Detection>& detections, 
-                                                       const cv::Mat& frame);
+    // Active tracks after this frame; a view of the live table, no copies.
+    // dt is the time since the previous update in frames, as for update().
+    TrackView<AdvancedTrackedVehicle> updateAdvanced(ConstSpan<Detection> detections, 
+                                                     const cv::Mat& frame, float dt = 1.0f);
+    TrackView<AdvancedTrackedVehicle> getAdvancedTracks() const;
     
     // Target selection and management
     void setPrimaryTarget(int targetId);
     void clearPrimaryTarget();
     int getPrimaryTargetId() const;
     bool isPrimaryTarget(int trackId) const;
+    // Moves the primary target with its correlation tracker alone, for
+    // frames the detector skips; framesSinceUpdate is this frame's distance
+    // from the last updateAdvanced(). False when there is no target to move
+    // or the tracker lost it; the next updateAdvanced() re-anchors it.
+    bool trackPrimaryTarget(const cv::Mat& frame, float framesSinceUpdate = 1.0f);
+    // Active tracks with each box carried along its filter to a frame the
+    // detector skips, for drawing and export. A view of scratch entries that
+    // hold only the display fields (no filter or appearance state), valid
+    // until the next call; the live tracks are not moved.
+    TrackView<AdvancedTrackedVehicle> coastTracks(float framesSinceUpdate);
     
     // Occlusion handling
     void setOcclusionThreshold(float threshold);
@@ -60,12 +116,26 @@ public:
     void enableCameraMotionCompensation(bool enable);
     void setCameraMotionSensitivity(float sensitivity);
     
+    // Records association/appearance/camera motion times; null disables
+    void setLatencyStats(LatencyStats* stats);
+    
+    // Snapshot and rewind; a default-constructed state starts over with no tracks
+    TrackingState saveState() const;
+    void restoreState(const TrackingState& state);
+    
+    // Statistics
+    size_t getLostTrackCount() const;  // Live tracks the last update found no detection for
+    uint64_t getReIdHits() const;  // Lost or occluded targets re-acquired by appearance
+    
     // Advanced visualization
-    void drawAdvancedTracks(cv::Mat& frame, const std::vector<AdvancedTrackedVehicle>& tracks);
+    void drawAdvancedTracks(cv::Mat& frame, TrackView<AdvancedTrackedVehicle> tracks);
     void drawTargetSelection(cv::Mat& frame);
 
 protected:
-    std::vector<AdvancedTrackedVehicle> advancedTracks_;
+    // Per-track advanced state, indexed by track id. Entries are retired
+    // together with their base track.
+    SlotMap<AdvancedTrackedVehicle> advancedTracks_;
+    std::unordered_map<int, SlotHandle> advancedTrackSlots_;
     int primaryTargetId_;
     bool partialTrackingEnabled_;
     bool reIdEnabled_;
@@ -77,19 +147,57 @@ protected:
     
     cv::Mat previousFrame_;
     cv::Point2f globalCameraMotion_;
+    LatencyStats* latencyStats_;
+    uint64_t reIdHits_;
+    
+    // Scratch reused across frames by camera motion and appearance features
+    cv::Mat grayCurrent_;
+    cv::Mat grayPrevious_;
+    std::vector<cv::Point2f> previousPoints_;
+    std::vector<cv::Point2f> nextPoints_;
+    std::vector<uchar> flowStatus_;
+    std::vector<float> flowError_;
+    cv::Mat resizedRoi_;
+    cv::Mat grayRoi_;
+    cv::HOGDescriptor appearanceHog_;
+    std::vector<float> descriptors_;
+    cv::Mat detectionFeatures_;
+    
+    // Predicted copies handed out by coastTracks()
+    std::vector<AdvancedTrackedVehicle> coastedTracks_;
+    
+    // Follows the primary target every frame; re-anchored on detector hits
+    CorrelationTracker primaryCorrelation_;
+    int correlationTargetId_;
+    
+    // Advanced track table
+    AdvancedTrackedVehicle* findAdvancedTrack(int id);
+    AdvancedTrackedVehicle& addAdvancedTrack(AdvancedTrackedVehicle track);
+    void retireTrack(const TrackedVehicle& track) override;
+    void clearAdvancedTracks();
     
     // Advanced tracking methods
-    void updateAdvancedTracks(const std::vector<Detection>& detections, const cv::Mat& frame);
+    void updateAdvancedTracks(ConstSpan<Detection> detections, const cv::Mat& frame, float dt);
     void handlePartialOcclusion(AdvancedTrackedVehicle& track, const cv::Mat& frame);
     void estimateFullBoundingBox(AdvancedTrackedVehicle& track);
-    cv::Mat extractAppearanceFeatures(const cv::Mat& frame, const cv::Rect& roi);
+    // Writes into features, reusing its buffer; false, leaving features
+    // empty, when roi is not inside the frame
+    bool extractAppearanceFeatures(const cv::Mat& frame, const cv::Rect& roi, cv::Mat& features);
     float calculateReIdScore(const cv::Mat& features1, const cv::Mat& features2);
     void updateCameraMotion(const cv::Mat& currentFrame, const cv::Mat& previousFrame);
-    void compensateCameraMotion(std::vector<Detection>& detections);
+    void compensateCameraMotion(ArenaVector<Detection>& detections);
     void predictMotion(AdvancedTrackedVehicle& track);
     void updateVelocityHistory(AdvancedTrackedVehicle& track);
     cv::Point2f calculatePredictedPosition(const AdvancedTrackedVehicle& track);
-    void handleTargetReacquisition(AdvancedTrackedVehicle& track, const std::vector<Detection>& detections);
+    void handleTargetReacquisition(AdvancedTrackedVehicle& track, ConstSpan<Detection> detections,
+                                   const cv::Mat& frame);
+    void fusePrimaryCorrelation(AdvancedTrackedVehicle& track, const cv::Mat& frame);
+    // Moves both the advanced and the base track to a correlation box and
+    // corrects the filter on it. Between updates (framesSinceUpdate > 0)
+    // the filter is first predicted up to this frame, and the base track
+    // remembers how far, so the next update predicts only the remainder.
+    void anchorPrimaryTrack(AdvancedTrackedVehicle& track, const cv::Rect& box, float framesSinceUpdate);
+    void resetPrimaryCorrelation();
     bool isSimilarVehicle(const AdvancedTrackedVehicle& track1, const AdvancedTrackedVehicle& track2);
     void mergeSimilarTracks();
     void generateUniqueSignature(AdvancedTrackedVehicle& track);
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Minimal micro-benchmark harness in the style of Google Benchmark.
+//
+// A benchmark body loops on state.keepRunning(); the runner grows the
+// iteration count until one batch takes at least the minimum time, then
+// repeats the batch and reports the median time per iteration. Setup that
+// must happen inside the loop goes between pauseTiming()/resumeTiming().
+// A body that cannot run calls skip() and returns; nothing is recorded.
+//
+// Results can be written as CSV and compared against an earlier CSV; the
+// run fails when any benchmark is slower than the baseline by more than the
+// allowed margin.
+template <typename T>
+inline void benchDoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+class BenchState {
+public:
+    explicit BenchState(size_t iterations)
+        : iterations_(iterations), remaining_(iterations), started_(false), skipped_(false), paused_(0) {}
+
+    bool keepRunning() {
+        if (!started_) {
+            started_ = true;
+            start_ = Clock::now();
+        }
+        if (remaining_ == 0) {
+            end_ = Clock::now();
+            return false;
+        }
+        --remaining_;
+        return true;
+    }
+
+    void pauseTiming() { pauseStart_ = Clock::now(); }
+    void resumeTiming() { paused_ += Clock::now() - pauseStart_; }
+
+    // Marks the benchmark as not runnable; the body should return right away
+    void skip(const std::string& reason) {
+        skipped_ = true;
+        skipReason_ = reason;
+    }
+    bool skipped() const { return skipped_; }
+    const std::string& skipReason() const { return skipReason_; }
+
+    size_t iterations() const { return iterations_; }
+    double elapsedNs() const {
+        return std::chrono::duration<double, std::nano>(end_ - start_ - paused_).count();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    size_t iterations_;
+    size_t remaining_;
+    bool started_;
+    bool skipped_;
+    std::string skipReason_;
+    Clock::time_point start_, end_, pauseStart_;
+    Clock::duration paused_;
+};
+
+struct BenchResult {
+    std::string name;
+    size_t iterations;
+    double nsPerIteration;
+};
+
+class BenchRunner {
+public:
+    using Body = std::function<void(BenchState&)>;
+
+    BenchRunner() : minTimeNs_(200e6), repetitions_(3) {}
+
+    void add(const std::string& name, Body body) {
+        benchmarks_.push_back({name, std::move(body)});
+    }
+
+    void setFilter(const std::string& filter) { filter_ = filter; }
+    void setMinTimeMs(double ms) { minTimeNs_ = ms * 1e6; }
+    void setRepetitions(int repetitions) { repetitions_ = std::max(1, repetitions); }
+
+    std::vector<std::string> names() const {
+        std::vector<std::string> matching;
+        for (const auto& benchmark : benchmarks_) {
+            if (filter_.empty() || benchmark.name.find(filter_) != std::string::npos) {
+                matching.push_back(benchmark.name);
+            }
+        }
+        return matching;
+    }
+
+    std::vector<BenchResult> run() {
+        std::vector<BenchResult> results;
+        std::printf("%-48s %12s %16s\n", "Benchmark", "Iterations", "Time/iter");
+        for (const auto& benchmark : benchmarks_) {
+            if (!filter_.empty() && benchmark.name.find(filter_) == std::string::npos) continue;
+
+            // Grow the batch until it is long enough to time reliably
+            size_t iterations = 1;
+            bool skipped = false;
+            std::string skipReason;
+            while (true) {
+                BenchState state(iterations);
+                benchmark.body(state);
+                if (state.skipped()) {
+                    skipped = true;
+                    skipReason = state.skipReason();
+                    break;
+                }
+                if (state.elapsedNs() >= minTimeNs_ || iterations >= (size_t(1) << 30)) break;
+                double scale = state.elapsedNs() > 0 ? minTimeNs_ / state.elapsedNs() * 1.4 : 10.0;
+                iterations = static_cast<size_t>(iterations * std::min(10.0, std::max(2.0, scale)));
+            }
+
+            std::vector<double> samples;
+            for (int r = 0; r < repetitions_ && !skipped; ++r) {
+                BenchState state(iterations);
+                benchmark.body(state);
+                if (state.skipped()) {
+                    skipped = true;
+                    skipReason = state.skipReason();
+                }
+                samples.push_back(state.elapsedNs() / iterations);
+            }
+            if (skipped) {
+                std::printf("%-48s %12s %16s  %s\n", benchmark.name.c_str(), "-", "SKIPPED",
+                            skipReason.c_str());
+                std::fflush(stdout);
+                continue;
+            }
+            std::sort(samples.begin(), samples.end());
+            double median = samples[samples.size() / 2];
+
+            results.push_back({benchmark.name, iterations, median});
+            std::printf("%-48s %12zu %16s\n", benchmark.name.c_str(), iterations, formatNs(median).c_str());
+            std::fflush(stdout);
+        }
+        return results;
+    }
+
+    static bool writeCsv(const std::string& path, const std::vector<BenchResult>& results) {
+        std::ofstream csv(path);
+        if (!csv.is_open()) {
+            std::cerr << "Error: Could not write " << path << std::endl;
+            return false;
+        }
+        csv << "name,iterations,ns_per_iteration\n";
+        for (const auto& result : results) {
+            csv << result.name << "," << result.iterations << "," << result.nsPerIteration << "\n";
+        }
+        return true;
+    }
+
+    // Returns false if any benchmark regressed by more than maxRegression
+    // (0.10 = 10% slower) against the baseline CSV
+    static bool compare(const std::string& baselinePath, const std::vector<BenchResult>& results,
+                        double maxRegression) {
+        std::ifstream csv(baselinePath);
+        if (!csv.is_open()) {
+            std::cerr << "Error: Could not read baseline " << baselinePath << std::endl;
+            return false;
+        }
+
+        std::map<std::string, double> baseline;
+        std::string line;
+        std::getline(csv, line);  // Header
+        while (std::getline(csv, line)) {
+            std::stringstream fields(line);
+            std::string name, iterations, ns;
+            if (std::getline(fields, name, ',') && std::getline(fields, iterations, ',') &&
+                std::getline(fields, ns, ',')) {
+                baseline[name] = std::stod(ns);
+            }
+        }
+
+        bool ok = true;
+        std::printf("\n%-48s %12s %12s %9s\n", "Benchmark", "Baseline", "Current", "Change");
+        for (const auto& result : results) {
+            auto it = baseline.find(result.name);
+            if (it == baseline.end() || it->second <= 0) continue;
+            double change = result.nsPerIteration / it->second - 1.0;
+            bool regressed = change > maxRegression;
+            ok = ok && !regressed;
+            std::printf("%-48s %12s %12s %+8.1f%%%s\n", result.name.c_str(),
+                        formatNs(it->second).c_str(), formatNs(result.nsPerIteration).c_str(),
+                        change * 100.0, regressed ? "  REGRESSION" : "");
+        }
+        return ok;
+    }
+
+    static std::string formatNs(double ns) {
+        char text[32];
+        if (ns < 1e3) std::snprintf(text, sizeof(text), "%.1f ns", ns);
+        else if (ns < 1e6) std::snprintf(text, sizeof(text), "%.2f us", ns / 1e3);
+        else std::snprintf(text, sizeof(text), "%.2f ms", ns / 1e6);
+        return text;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        Body body;
+    };
+    std::vector<Entry> benchmarks_;
+    std::string filter_;
+    double minTimeNs_;
+    int repetitions_;
+};
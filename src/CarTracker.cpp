@@ -1,10 +1,9 @@
 #include "CarTracker.h"
 #include <iostream>
-#include <chrono>
 #include <iomanip>
 
 CarTracker::CarTracker() 
-    : displayEnabled_(true), totalVehiclesDetected_(0) {
+    : displayEnabled_(true), framesProcessed_(0), totalVehiclesDetected_(0) {
 }
 
 CarTracker::~CarTracker() {
@@ -19,6 +18,7 @@ bool CarTracker::initialize() {
     }
     
     tracker_.initialize();
+    detector_.setLatencyStats(&latencyStats_);
     
     std::cout << "Car Chase Tracking System initialized successfully!" << std::endl;
     return true;
@@ -59,25 +59,26 @@ bool CarTracker::processVideo(const std::string& videoPath, const std::string& o
     std::cout << "Starting video processing..." << std::endl;
     
     while (true) {
+        StageTimer decodeTimer(&latencyStats_, LatencyStage::Decode);
         cap >> frame;
-        if (frame.empty()) break;
+        if (frame.empty()) {
+            decodeTimer.cancel();
+            break;
+        }
+        decodeTimer.stop();
         
         frameCount++;
         
         // Process frame
-        auto startTime = std::chrono::high_resolution_clock::now();
+        StageTimer frameTimer(&latencyStats_, LatencyStage::Frame);
         bool success = processFrame(frame, outputFrame);
-        auto endTime = std::chrono::high_resolution_clock::now();
+        frameTimer.stop();
         
         if (!success) {
             std::cerr << "Error processing frame " << frameCount << std::endl;
             continue;
         }
         
-        // Calculate processing time
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-        updateStatistics(duration.count());
-        
         // Display progress
         if (frameCount % 30 == 0) {
             double progress = (double)frameCount / totalFrames * 100.0;
@@ -88,6 +89,7 @@ bool CarTracker::processVideo(const std::string& videoPath, const std::string& o
         
         // Write to output video
         if (videoWriter.isOpened()) {
+            StageTimer encodeTimer(&latencyStats_, LatencyStage::Encode);
             videoWriter.write(outputFrame);
         }
         
@@ -109,6 +111,9 @@ bool CarTracker::processVideo(const std::string& videoPath, const std::string& o
     if (videoWriter.isOpened()) {
         videoWriter.release();
     }
+    for (auto& exporter : exporters_) {
+        exporter->close();
+    }
     
     if (displayEnabled_) {
         cv::destroyAllWindows();
@@ -119,6 +124,7 @@ bool CarTracker::processVideo(const std::string& videoPath, const std::string& o
     std::cout << "Total frames processed: " << frameCount << std::endl;
     std::cout << "Total vehicles detected: " << totalVehiclesDetected_ << std::endl;
     std::cout << "Average processing time: " << getAverageProcessingTime() << " ms" << std::endl;
+    latencyStats_.printSummary(std::cout);
     
     if (!outputPath.empty()) {
         std::cout << "Output saved to: " << outputPath << std::endl;
@@ -136,12 +142,19 @@ bool CarTracker::processFrame(const cv::Mat& frame, cv::Mat& outputFrame) {
         std::vector<Detection> detections = detector_.detectVehicles(frame);
         
         // Update tracking system
-        std::vector<TrackedVehicle> tracks = tracker_.update(detections, frame);
+        StageTimer associationTimer(&latencyStats_, LatencyStage::Association);
+        TrackView<TrackedVehicle> tracks = tracker_.update(detections, frame);
+        associationTimer.stop();
+        framesProcessed_++;
+        for (auto& exporter : exporters_) {
+            exporter->writeFrame(framesProcessed_, tracks);
+        }
         
         // Update statistics
         totalVehiclesDetected_ += detections.size();
         
         // Draw tracks on output frame
+        StageTimer renderTimer(&latencyStats_, LatencyStage::Render);
         tracker_.drawTracks(outputFrame, tracks);
         
         // Draw statistics
@@ -177,6 +190,15 @@ void CarTracker::setOutputPath(const std::string& path) {
     outputPath_ = path;
 }
 
+bool CarTracker::addExporter(const std::string& path, ExportFormat format) {
+    auto exporter = std::make_unique<TrackExporter>();
+    if (!exporter->open(path, format)) {
+        return false;
+    }
+    exporters_.push_back(std::move(exporter));
+    return true;
+}
+
 int CarTracker::getTotalVehiclesDetected() const {
     return totalVehiclesDetected_;
 }
@@ -187,13 +209,11 @@ int CarTracker::getCurrentActiveTracks() const {
 }
 
 double CarTracker::getAverageProcessingTime() const {
-    if (processingTimes_.empty()) return 0.0;
-    
-    double sum = 0.0;
-    for (double time : processingTimes_) {
-        sum += time;
-    }
-    return sum / processingTimes_.size();
+    return latencyStats_.get(LatencyStage::Frame).getMean() / 1e6;
+}
+
+const LatencyStats& CarTracker::getLatencyStats() const {
+    return latencyStats_;
 }
 
 void CarTracker::drawStatistics(cv::Mat& frame) {
@@ -218,12 +238,4 @@ void CarTracker::saveFrame(const cv::Mat& frame, int frameNumber) {
         cv::imwrite(filename, frame);
     }
 }
-
-void CarTracker::updateStatistics(double processingTime) {
-    processingTimes_.push_back(processingTime);
-    
-    // Keep only last 100 measurements to avoid memory issues
-    if (processingTimes_.size() > 100) {
-        processingTimes_.erase(processingTimes_.begin());
-    }
-} 
\ No newline at end of file
+ 
\ No newline at end of file
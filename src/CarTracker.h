@@ -2,7 +2,10 @@
 
 #include "VehicleDetector.h"
 #include "TrackingSystem.h"
+#include "TrackExporter.h"
+#include "LatencyHistogram.h"
 #include <opencv2/opencv.hpp>
+#include <memory>
 #include <string>
 
 class CarTracker {
@@ -18,23 +21,26 @@ public:
     void setTrackingParameters(int maxAge, int minHits, float iouThreshold);
     void enableDisplay(bool enable);
     void setOutputPath(const std::string& path);
+    bool addExporter(const std::string& path, ExportFormat format);
     
     // Statistics
     int getTotalVehiclesDetected() const;
     int getCurrentActiveTracks() const;
     double getAverageProcessingTime() const;
+    const LatencyStats& getLatencyStats() const;
     
 private:
     VehicleDetector detector_;
     TrackingSystem tracker_;
     bool displayEnabled_;
     std::string outputPath_;
+    std::vector<std::unique_ptr<TrackExporter>> exporters_;
+    int framesProcessed_;
     
     // Statistics
     int totalVehiclesDetected_;
-    std::vector<double> processingTimes_;
+    LatencyStats latencyStats_;
     
     void drawStatistics(cv::Mat& frame);
     void saveFrame(const cv::Mat& frame, int frameNumber);
-    void updateStatistics(double processingTime);
 }; 
\ No newline at end of file
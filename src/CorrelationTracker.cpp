@@ -0,0 +1,219 @@
+#include "CorrelationTracker.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Context around the box that goes into the patch
+const float kRegionPadding = 2.0f;
+// Width of the desired response peak, in patch pixels
+const double kTargetSigma = 2.0;
+// Regularizes the filter against near-zero spectral energy
+const float kFilterEpsilon = 1e-5f;
+// Excluded around the peak when measuring the sidelobe
+const int kPeakExclusion = 5;
+// Small rotations trained on at initialization, so one frame is enough
+const double kInitRotationsDeg[] = {-8.0, -4.0, 4.0, 8.0};
+
+}  // namespace
+
+CorrelationTracker::CorrelationTracker()
+    : initialized_(false), learningRate_(0.125f), minPeakToSidelobeRatio_(7.0f),
+      peakToSidelobeRatio_(0.0f) {
+    cv::createHanningWindow(window_, cv::Size(kPatchSize, kPatchSize), CV_32F);
+
+    // Gaussian peak at the patch center: a centred target responds there
+    cv::Mat target(kPatchSize, kPatchSize, CV_32F);
+    double center = kPatchSize / 2;
+    for (int y = 0; y < kPatchSize; ++y) {
+        float* row = target.ptr<float>(y);
+        for (int x = 0; x < kPatchSize; ++x) {
+            double distance2 = (x - center) * (x - center) + (y - center) * (y - center);
+            row[x] = static_cast<float>(std::exp(-distance2 / (2.0 * kTargetSigma * kTargetSigma)));
+        }
+    }
+    cv::dft(target, targetSpectrum_, cv::DFT_COMPLEX_OUTPUT);
+}
+
+bool CorrelationTracker::initialize(const cv::Mat& frame, const cv::Rect& box) {
+    reset();
+    if (frame.empty() || box.area() <= 0) return false;
+
+    setRegion(cv::Point2f(box.x + box.width / 2.0f, box.y + box.height / 2.0f), box.size());
+    extractPatch(frame);
+
+    numerator_ = cv::Mat::zeros(kPatchSize, kPatchSize, CV_32FC2);
+    denominator_ = cv::Mat::zeros(kPatchSize, kPatchSize, CV_32FC2);
+    train(patch_, 1.0f);
+
+    // Rotated copies of the first patch stand in for the frames MOSSE would
+    // otherwise need before the filter generalizes; all samples weigh the same
+    cv::Mat rotated;
+    cv::Point2f patchCenter(kPatchSize / 2.0f, kPatchSize / 2.0f);
+    int samples = 1;
+    for (double degrees : kInitRotationsDeg) {
+        double radians = degrees * CV_PI / 180.0;
+        double c = std::cos(radians), s = std::sin(radians);
+        cv::Mat rotation = (cv::Mat_<double>(2, 3) <<
+            c, s, (1 - c) * patchCenter.x - s * patchCenter.y,
+            -s, c, s * patchCenter.x + (1 - c) * patchCenter.y);
+        cv::warpAffine(gray_, rotated, rotation, gray_.size(), cv::INTER_LINEAR, cv::BORDER_REFLECT);
+        rotated.convertTo(rotated, CV_32F);
+        preprocess(rotated);
+        train(rotated, 1.0f / ++samples);
+    }
+
+    updateFilter();
+    initialized_ = true;
+    peakToSidelobeRatio_ = 0.0f;
+    return true;
+}
+
+bool CorrelationTracker::update(const cv::Mat& frame, cv::Rect& box) {
+    if (!initialized_ || frame.empty()) return false;
+
+    extractPatch(frame);
+    cv::dft(patch_, spectrum_, cv::DFT_COMPLEX_OUTPUT);
+    cv::mulSpectrums(spectrum_, filter_, product_, 0);
+    cv::dft(product_, response_, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+
+    double peak = 0.0;
+    cv::Point peakLocation;
+    cv::minMaxLoc(response_, nullptr, &peak, nullptr, &peakLocation);
+
+    // Sidelobe statistics over everything outside a window around the peak
+    double sum = 0.0, sumSquares = 0.0;
+    int count = 0;
+    for (int y = 0; y < kPatchSize; ++y) {
+        const float* row = response_.ptr<float>(y);
+        bool nearRow = std::abs(y - peakLocation.y) <= kPeakExclusion;
+        for (int x = 0; x < kPatchSize; ++x) {
+            if (nearRow && std::abs(x - peakLocation.x) <= kPeakExclusion) continue;
+            sum += row[x];
+            sumSquares += row[x] * row[x];
+            count++;
+        }
+    }
+    double mean = sum / count;
+    double stddev = std::sqrt(std::max(sumSquares / count - mean * mean, 1e-12));
+    peakToSidelobeRatio_ = static_cast<float>((peak - mean) / stddev);
+    if (peakToSidelobeRatio_ < minPeakToSidelobeRatio_) return false;
+
+    // Patch pixels back to frame pixels
+    float scaleX = regionSize_.width / kPatchSize;
+    float scaleY = regionSize_.height / kPatchSize;
+    center_.x += (peakLocation.x - kPatchSize / 2) * scaleX;
+    center_.y += (peakLocation.y - kPatchSize / 2) * scaleY;
+
+    // Adapt on the patch at the new position
+    extractPatch(frame);
+    train(patch_, learningRate_);
+    updateFilter();
+
+    box = cv::Rect(cvRound(center_.x - boxSize_.width / 2.0f), cvRound(center_.y - boxSize_.height / 2.0f),
+                   boxSize_.width, boxSize_.height);
+    return true;
+}
+
+void CorrelationTracker::correct(const cv::Mat& frame, const cv::Rect& box) {
+    if (!initialized_) {
+        initialize(frame, box);
+        return;
+    }
+    if (frame.empty() || box.area() <= 0) return;
+
+    cv::Size previousSize = boxSize_;
+    setRegion(cv::Point2f(box.x + box.width / 2.0f, box.y + box.height / 2.0f), box.size());
+    // A large change of scale makes the old filter useless; start over
+    float scaleChange = static_cast<float>(box.area()) / std::max(previousSize.area(), 1);
+    if (scaleChange < 0.5f || scaleChange > 2.0f) {
+        initialize(frame, box);
+        return;
+    }
+
+    extractPatch(frame);
+    train(patch_, learningRate_);
+    updateFilter();
+}
+
+void CorrelationTracker::reset() {
+    initialized_ = false;
+    peakToSidelobeRatio_ = 0.0f;
+}
+
+bool CorrelationTracker::isInitialized() const {
+    return initialized_;
+}
+
+float CorrelationTracker::getPeakToSidelobeRatio() const {
+    return peakToSidelobeRatio_;
+}
+
+void CorrelationTracker::setLearningRate(float rate) {
+    learningRate_ = std::max(0.0f, std::min(1.0f, rate));
+}
+
+void CorrelationTracker::setMinPeakToSidelobeRatio(float ratio) {
+    minPeakToSidelobeRatio_ = ratio;
+}
+
+void CorrelationTracker::setRegion(const cv::Point2f& center, const cv::Size& boxSize) {
+    center_ = center;
+    boxSize_ = boxSize;
+    regionSize_ = cv::Size2f(std::max(boxSize.width * kRegionPadding, 1.0f),
+                             std::max(boxSize.height * kRegionPadding, 1.0f));
+}
+
+void CorrelationTracker::extractPatch(const cv::Mat& frame) {
+    // Crop first, then shrink and convert: the colour conversion only ever
+    // touches kPatchSize^2 pixels. getRectSubPix replicates the border when
+    // the region leaves the frame.
+    cv::Size regionPixels(cvRound(regionSize_.width), cvRound(regionSize_.height));
+    cv::getRectSubPix(frame, regionPixels, center_, region_);
+    cv::resize(region_, resized_, cv::Size(kPatchSize, kPatchSize), 0, 0, cv::INTER_AREA);
+    if (resized_.channels() == 3) {
+        cv::cvtColor(resized_, gray_, cv::COLOR_BGR2GRAY);
+    } else {
+        resized_.copyTo(gray_);
+    }
+    gray_.convertTo(patch_, CV_32F);
+    preprocess(patch_);
+}
+
+void CorrelationTracker::preprocess(cv::Mat& patch) const {
+    // Log compresses lighting contrast
+    patch += 1.0f;
+    cv::log(patch, patch);
+
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(patch, mean, stddev);
+    patch -= mean[0];
+    patch *= 1.0 / (stddev[0] + 1e-5);
+
+    // Tapers the edges the DFT would otherwise treat as wrapping around
+    cv::multiply(patch, window_, patch);
+}
+
+void CorrelationTracker::train(const cv::Mat& patch, float rate) {
+    cv::dft(patch, spectrum_, cv::DFT_COMPLEX_OUTPUT);
+
+    // A = G . conj(F), B = F . conj(F), as running averages
+    cv::mulSpectrums(targetSpectrum_, spectrum_, product_, 0, true);
+    cv::addWeighted(numerator_, 1.0 - rate, product_, rate, 0.0, numerator_);
+    cv::mulSpectrums(spectrum_, spectrum_, product_, 0, true);
+    cv::addWeighted(denominator_, 1.0 - rate, product_, rate, 0.0, denominator_);
+}
+
+void CorrelationTracker::updateFilter() {
+    // B is real, so H = A / B is a per-element scale; this loop vectorizes
+    filter_.create(numerator_.size(), CV_32FC2);
+    const int values = numerator_.rows * numerator_.cols;
+    const cv::Vec2f* a = numerator_.ptr<cv::Vec2f>();
+    const cv::Vec2f* b = denominator_.ptr<cv::Vec2f>();
+    cv::Vec2f* h = filter_.ptr<cv::Vec2f>();
+    for (int i = 0; i < values; ++i) {
+        float inverse = 1.0f / (b[i][0] + kFilterEpsilon);
+        h[i][0] = a[i][0] * inverse;
+        h[i][1] = a[i][1] * inverse;
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+// MOSSE correlation-filter tracker for a single target (Bolme et al.,
+// "Visual Object Tracking using Adaptive Correlation Filters", CVPR 2010).
+//
+// The region around the target is resampled to a fixed 64x64 grey patch and
+// correlated with a learned filter in the Fourier domain; the response peak
+// gives the target's shift. Cost is a few small DFTs per frame regardless of
+// box or frame size, so it can run on every frame between detector runs.
+// The box keeps its size; a detector hit passed to correct() resizes it.
+class CorrelationTracker {
+public:
+    CorrelationTracker();
+
+    // Trains a fresh filter on box in frame; false if the box is empty
+    bool initialize(const cv::Mat& frame, const cv::Rect& box);
+    // Locates the target in frame and adapts the filter. Returns false,
+    // leaving box and filter untouched, when the peak is too weak to trust.
+    bool update(const cv::Mat& frame, cv::Rect& box);
+    // Re-centres on a box found by other means (a detector hit) and trains
+    // on it, so the filter follows the detector instead of drifting
+    void correct(const cv::Mat& frame, const cv::Rect& box);
+    void reset();
+
+    bool isInitialized() const;
+    // Peak-to-sidelobe ratio of the last update; ~20+ for a solid lock
+    float getPeakToSidelobeRatio() const;
+
+    void setLearningRate(float rate);
+    void setMinPeakToSidelobeRatio(float ratio);
+
+    static constexpr int kPatchSize = 64;
+
+private:
+    bool initialized_;
+    float learningRate_;
+    float minPeakToSidelobeRatio_;
+    float peakToSidelobeRatio_;
+    cv::Point2f center_;
+    cv::Size boxSize_;
+    cv::Size2f regionSize_;  // Frame area resampled into the patch
+
+    cv::Mat window_;          // Hanning window, kPatchSize^2 CV_32F
+    cv::Mat targetSpectrum_;  // DFT of the desired Gaussian response
+    cv::Mat numerator_;       // A = sum G . conj(F)
+    cv::Mat denominator_;     // B = sum F . conj(F), stored as complex
+    cv::Mat filter_;          // A / B
+
+    // Scratch, reused every frame
+    cv::Mat region_;
+    cv::Mat resized_;
+    cv::Mat gray_;
+    cv::Mat patch_;
+    cv::Mat spectrum_;
+    cv::Mat product_;
+    cv::Mat response_;
+
+    void setRegion(const cv::Point2f& center, const cv::Size& boxSize);
+    // Preprocessed patch of frame around center_, in patch_
+    void extractPatch(const cv::Mat& frame);
+    // Log, zero-mean and unit-norm, then windowed
+    void preprocess(cv::Mat& patch) const;
+    void train(const cv::Mat& patch, float rate);
+    void updateFilter();
+};
@@ -0,0 +1,276 @@
+#include "DetectionCache.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint64_t kFnvOffset = DetectionCache::kHashSeed;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+// Fingerprint sampling: this many blocks of this size, evenly spaced
+constexpr int kFingerprintBlocks = 64;
+constexpr size_t kFingerprintBlockBytes = 64 * 1024;
+
+uint64_t fnv1a(const void* data, size_t length, uint64_t hash = kFnvOffset) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < length; ++i) {
+        hash ^= bytes[i];
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+int16_t clampCoord(int value) {
+    return static_cast<int16_t>(std::max<int>(std::numeric_limits<int16_t>::min(),
+                                std::min<int>(std::numeric_limits<int16_t>::max(), value)));
+}
+
+} // namespace
+
+DetectionCache::DetectionCache()
+    : file_(nullptr), replayOnly_(false), floorThreshold_(kDefaultFloorThreshold), hits_(0), misses_(0) {
+}
+
+DetectionCache::~DetectionCache() {
+    close();
+}
+
+uint64_t DetectionCache::fingerprintFile(const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) return 0;
+
+    std::fseek(file, 0, SEEK_END);
+    long fileSize = std::ftell(file);
+    uint64_t hash = fnv1a(&fileSize, sizeof(fileSize));
+
+    std::vector<char> block(kFingerprintBlockBytes);
+    long span = std::max<long>(0, fileSize - static_cast<long>(kFingerprintBlockBytes));
+    for (int i = 0; i < kFingerprintBlocks; ++i) {
+        // First block at the start, last one flush with the end of the file
+        long offset = span * i / (kFingerprintBlocks - 1);
+        std::fseek(file, offset, SEEK_SET);
+        size_t got = std::fread(block.data(), 1, block.size(), file);
+        hash = fnv1a(block.data(), got, hash);
+        if (span == 0) break;
+    }
+
+    std::fclose(file);
+    return hash;
+}
+
+uint64_t DetectionCache::hashString(const std::string& text) {
+    return fnv1a(text.data(), text.size());
+}
+
+uint64_t DetectionCache::hashBytes(const void* data, size_t length, uint64_t hash) {
+    return fnv1a(data, length, hash);
+}
+
+std::string DetectionCache::cachePath(const std::string& directory, uint64_t videoHash, uint64_t configHash) {
+    std::ostringstream path;
+    path << directory;
+    if (!directory.empty() && directory.back() != '/') path << '/';
+    path << std::hex << std::setfill('0') << std::setw(16) << videoHash
+         << '_' << std::setw(16) << configHash << ".detcache";
+    return path.str();
+}
+
+bool DetectionCache::open(const std::string& path, uint64_t videoHash, uint64_t configHash,
+                          float floorThreshold) {
+    close();
+    floorThreshold_ = floorThreshold;
+
+#ifndef _WIN32
+    // Create the cache directory on first use
+    std::string::size_type slash = path.rfind('/');
+    if (slash != std::string::npos && slash > 0) {
+        mkdir(path.substr(0, slash).c_str(), 0755);
+    }
+#endif
+
+    long validEnd = 0;
+    if (FILE* existing = std::fopen(path.c_str(), "rb")) {
+        if (!load(existing, videoHash, configHash, floorThreshold, validEnd)) {
+            entries_.clear();
+            frames_.clear();
+            validEnd = 0;
+        }
+        std::fclose(existing);
+    }
+
+    if (validEnd > 0) {
+#ifndef _WIN32
+        if (truncate(path.c_str(), validEnd) != 0) {
+            std::cerr << "Error: Could not trim detection cache: " << path << std::endl;
+            return false;
+        }
+#endif
+        file_ = std::fopen(path.c_str(), "ab");
+    } else {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (file_) {
+            DetectionCacheHeader header = {kDetectionCacheMagic, kDetectionCacheVersion,
+                                           videoHash, configHash, floorThreshold, 0};
+            std::fwrite(&header, sizeof(header), 1, file_);
+        }
+    }
+
+    if (!file_) {
+        std::cerr << "Error: Could not open detection cache: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool DetectionCache::openForReplay(const std::string& path) {
+    close();
+
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Error: Could not open detection cache: " << path << std::endl;
+        return false;
+    }
+
+    DetectionCacheHeader header;
+    long validBytes = 0;
+    bool loaded = std::fread(&header, sizeof(header), 1, file) == 1;
+    if (loaded) {
+        std::rewind(file);
+        loaded = load(file, header.videoHash, header.configHash, header.floorThreshold, validBytes);
+    }
+    std::fclose(file);
+
+    if (!loaded) {
+        std::cerr << "Error: Not a detection cache: " << path << std::endl;
+        entries_.clear();
+        frames_.clear();
+        return false;
+    }
+    floorThreshold_ = header.floorThreshold;
+    replayOnly_ = true;
+    return true;
+}
+
+bool DetectionCache::load(FILE* file, uint64_t videoHash, uint64_t configHash,
+                          float floorThreshold, long& validBytes) {
+    DetectionCacheHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != kDetectionCacheMagic || header.version != kDetectionCacheVersion ||
+        header.videoHash != videoHash || header.configHash != configHash ||
+        header.floorThreshold != floorThreshold) {
+        return false;
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    long fileSize = std::ftell(file);
+    validBytes = sizeof(header);
+    std::fseek(file, validBytes, SEEK_SET);
+
+    DetectionCacheFrame record;
+    while (std::fread(&record, sizeof(record), 1, file) == 1) {
+        long end = validBytes + static_cast<long>(sizeof(record) + record.count * sizeof(DetectionCacheEntry));
+        if (end > fileSize) break;
+
+        size_t first = entries_.size();
+        entries_.resize(first + record.count);
+        if (record.count > 0 &&
+            std::fread(&entries_[first], sizeof(DetectionCacheEntry), record.count, file) != record.count) {
+            entries_.resize(first);
+            break;
+        }
+        // Later records for the same frame win
+        frames_[record.frameIndex] = std::make_pair(first, record.count);
+        validBytes = end;
+    }
+    return true;
+}
+
+void DetectionCache::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    replayOnly_ = false;
+    entries_.clear();
+    frames_.clear();
+}
+
+bool DetectionCache::isOpen() const {
+    return file_ != nullptr || replayOnly_;
+}
+
+bool DetectionCache::lookup(int frameIndex, std::vector<Detection>& detections) const {
+    auto it = frames_.find(frameIndex);
+    if (it == frames_.end()) {
+        misses_++;
+        return false;
+    }
+    hits_++;
+
+    detections.clear();
+    detections.reserve(it->second.second);
+    for (uint32_t i = 0; i < it->second.second; ++i) {
+        const DetectionCacheEntry& entry = entries_[it->second.first + i];
+        Detection detection;
+        detection.boundingBox = cv::Rect(entry.x, entry.y, entry.width, entry.height);
+        detection.confidence = entry.confidence;
+        detection.classId = entry.classId;
+        detections.push_back(detection);
+    }
+    return true;
+}
+
+void DetectionCache::store(int frameIndex, const std::vector<Detection>& detections) {
+    if (!file_) return;
+
+    size_t first = entries_.size();
+    for (const auto& detection : detections) {
+        if (detection.confidence < floorThreshold_) continue;
+        const cv::Rect& box = detection.boundingBox;
+        DetectionCacheEntry entry = {clampCoord(box.x), clampCoord(box.y),
+                                     clampCoord(box.width), clampCoord(box.height),
+                                     detection.confidence, static_cast<int16_t>(detection.classId), 0};
+        entries_.push_back(entry);
+    }
+
+    DetectionCacheFrame record = {frameIndex, static_cast<uint32_t>(entries_.size() - first)};
+    std::fwrite(&record, sizeof(record), 1, file_);
+    if (record.count > 0) {
+        std::fwrite(&entries_[first], sizeof(DetectionCacheEntry), record.count, file_);
+    }
+    frames_[frameIndex] = std::make_pair(first, record.count);
+}
+
+float DetectionCache::getFloorThreshold() const {
+    return floorThreshold_;
+}
+
+size_t DetectionCache::getCachedFrameCount() const {
+    return frames_.size();
+}
+
+std::vector<int> DetectionCache::getFrameIndices() const {
+    std::vector<int> indices;
+    indices.reserve(frames_.size());
+    for (const auto& frame : frames_) {
+        indices.push_back(frame.first);
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+uint64_t DetectionCache::getHits() const {
+    return hits_;
+}
+
+uint64_t DetectionCache::getMisses() const {
+    return misses_;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "VehicleDetector.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Per-frame detector output stored on disk so that re-runs with different
+// tracker parameters skip detection entirely.
+//
+// Detections are stored "raw": after NMS but at a low floor threshold, so
+// any confidence threshold at or above the floor can be applied on replay.
+// The file is keyed by a content fingerprint of the source video and a hash
+// of everything else detections depend on (model, input scale, frame
+// geometry), so renamed or re-uploaded copies of a video still hit.
+//
+// File layout:
+//   [DetectionCacheHeader][frame record][frame record]...
+//   frame record = [DetectionCacheFrame][DetectionCacheEntry x count]
+//
+// Records are appended as frames are detected, in any order. A record cut
+// short by a crash is dropped on the next open and overwritten.
+constexpr uint32_t kDetectionCacheMagic = 0x43444343;  // "CCDC"
+constexpr uint32_t kDetectionCacheVersion = 1;
+
+struct DetectionCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t videoHash;
+    uint64_t configHash;
+    float floorThreshold;
+    uint32_t reserved;
+};
+
+struct DetectionCacheFrame {
+    int32_t frameIndex;
+    uint32_t count;
+};
+
+struct DetectionCacheEntry {
+    int16_t x, y, width, height;
+    float confidence;
+    int16_t classId;
+    uint16_t reserved;
+};
+
+static_assert(sizeof(DetectionCacheHeader) == 32, "detection cache header layout changed");
+static_assert(sizeof(DetectionCacheFrame) == 8, "detection cache frame layout changed");
+static_assert(sizeof(DetectionCacheEntry) == 16, "detection cache entry layout changed");
+
+class DetectionCache {
+public:
+    static constexpr float kDefaultFloorThreshold = 0.05f;
+    static constexpr uint64_t kHashSeed = 1469598103934665603ULL;  // FNV-1a offset basis
+
+    DetectionCache();
+    ~DetectionCache();
+
+    // Sampled content hash: file size plus fixed-size blocks spread evenly
+    // through the file. Cheap on multi-gigabyte videos; returns 0 on error.
+    static uint64_t fingerprintFile(const std::string& path);
+    static uint64_t hashString(const std::string& text);
+    // FNV-1a over every byte; continue a hash by passing it back in
+    static uint64_t hashBytes(const void* data, size_t length, uint64_t hash = kHashSeed);
+    static std::string cachePath(const std::string& directory, uint64_t videoHash, uint64_t configHash);
+
+    // Loads existing records for this key and opens the file for appending.
+    // A file with a different key or floor is discarded and started fresh.
+    bool open(const std::string& path, uint64_t videoHash, uint64_t configHash,
+              float floorThreshold = kDefaultFloorThreshold);
+    // Read-only access for offline tools; takes whatever key the file has
+    bool openForReplay(const std::string& path);
+    void close();
+    bool isOpen() const;
+
+    // Fills classId/boundingBox/confidence; labels are left to the caller
+    bool lookup(int frameIndex, std::vector<Detection>& detections) const;
+    void store(int frameIndex, const std::vector<Detection>& detections);
+
+    float getFloorThreshold() const;
+    size_t getCachedFrameCount() const;
+    std::vector<int> getFrameIndices() const;  // Sorted
+    uint64_t getHits() const;
+    uint64_t getMisses() const;
+
+private:
+    FILE* file_;
+    bool replayOnly_;
+    float floorThreshold_;
+    std::vector<DetectionCacheEntry> entries_;
+    // frameIndex -> (first entry, count)
+    std::unordered_map<int32_t, std::pair<size_t, uint32_t>> frames_;
+    mutable uint64_t hits_;
+    mutable uint64_t misses_;
+
+    bool load(FILE* file, uint64_t videoHash, uint64_t configHash, float floorThreshold, long& validBytes);
+};
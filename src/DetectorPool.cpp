@@ -0,0 +1,168 @@
+#include "DetectorPool.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+DetectorPool::DetectorPool()
+    : settings_{0.5f, 0.4f, nullptr}, stopping_(true) {
+}
+
+DetectorPool::~DetectorPool() {
+    stop();
+}
+
+bool DetectorPool::start(int workers) {
+    stop();
+
+    if (workers <= 0) {
+        workers = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    model_ = VehicleDetector::loadDefaultModel();
+    if (!model_) {
+        std::cout << "YOLO model not found, detector pool uses HOG..." << std::endl;
+    }
+
+    Settings settings;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        settings = settings_;
+        stopping_ = false;
+    }
+    for (int i = 0; i < workers; ++i) {
+        auto replica = std::make_unique<VehicleDetector>();
+        if (!replica->initialize(model_)) {
+            std::cerr << "Error: detector replica " << i << " failed to initialize" << std::endl;
+            replicas_.clear();
+            failQueuedJobs();
+            return false;
+        }
+        replica->setConfidenceThreshold(settings.confidenceThreshold);
+        replica->setNMSThreshold(settings.nmsThreshold);
+        replica->setLatencyStats(settings.latencyStats);
+        replicas_.push_back(std::move(replica));
+    }
+
+    // Threads start once every replica is built, so a failure leaves none behind
+    for (auto& replica : replicas_) {
+        workers_.emplace_back(&DetectorPool::workerLoop, this, replica.get());
+    }
+    return true;
+}
+
+void DetectorPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    replicas_.clear();
+}
+
+void DetectorPool::failQueuedJobs() {
+    std::deque<Job> orphaned;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        orphaned.swap(queue_);
+    }
+    for (auto& job : orphaned) {
+        job.result.set_exception(std::make_exception_ptr(std::runtime_error("detector pool is not running")));
+    }
+}
+
+bool DetectorPool::isRunning() const {
+    return !workers_.empty();
+}
+
+std::future<std::vector<Detection>> DetectorPool::submit(const cv::Mat& frame) {
+    return submit(frame, std::vector<cv::Rect>());
+}
+
+std::future<std::vector<Detection>> DetectorPool::submit(const cv::Mat& frame, std::vector<cv::Rect> regions) {
+    Job job;
+    job.frame = frame;
+    job.regions = std::move(regions);
+    std::future<std::vector<Detection>> result = job.result.get_future();
+
+    // Checked under the lock stop() takes, so a job is either queued before
+    // the workers drain the queue and exit, or refused here
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!stopping_) {
+            queue_.push_back(std::move(job));
+            cv_.notify_one();
+            return result;
+        }
+    }
+    job.result.set_exception(std::make_exception_ptr(std::runtime_error("detector pool is not running")));
+    return result;
+}
+
+void DetectorPool::setConfidenceThreshold(float threshold) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    settings_.confidenceThreshold = threshold;
+}
+
+void DetectorPool::setNMSThreshold(float threshold) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    settings_.nmsThreshold = threshold;
+}
+
+void DetectorPool::setLatencyStats(LatencyStats* stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    settings_.latencyStats = stats;
+}
+
+int DetectorPool::getWorkerCount() const {
+    return static_cast<int>(workers_.size());
+}
+
+size_t DetectorPool::getQueuedFrames() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+std::string DetectorPool::getModelFingerprint() const {
+    if (replicas_.empty()) return std::string();
+    // From the pool's own copies: the replicas' settings belong to their workers
+    std::lock_guard<std::mutex> lock(mutex_);
+    return VehicleDetector::fingerprintFor(model_.get(), replicas_.front()->getInputSize(),
+                                           settings_.nmsThreshold);
+}
+
+LabelId DetectorPool::labelForClass(int classId) const {
+    // Class labels are fixed once a replica is built; reading them is safe
+    return replicas_.empty() ? kUnknownLabel : replicas_.front()->labelForClass(classId);
+}
+
+void DetectorPool::workerLoop(VehicleDetector* detector) {
+    while (true) {
+        Job job;
+        Settings settings;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            // Queued frames are finished before the workers exit
+            if (queue_.empty()) return;
+            job = std::move(queue_.front());
+            queue_.pop_front();
+            settings = settings_;
+        }
+
+        detector->setConfidenceThreshold(settings.confidenceThreshold);
+        detector->setNMSThreshold(settings.nmsThreshold);
+        detector->setLatencyStats(settings.latencyStats);
+        try {
+            job.result.set_value(detector->detectVehiclesInRegions(job.frame, job.regions));
+        } catch (...) {
+            job.result.set_exception(std::current_exception());
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "VehicleDetector.h"
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Parallel vehicle detection for multi-stream and pipelined processing.
+//
+// The model files are read once. Each worker owns a VehicleDetector replica
+// built from those bytes, with its own network, input blob and scratch, so
+// workers share no mutable state and a frame gives the same detections on
+// any of them as on a lone VehicleDetector. submit() queues a frame and
+// returns a future; the next free worker takes it.
+//
+// All replicas run on OpenCV's one process-wide worker pool (cv::dnn and
+// HOG parallelize internally), so the worker count is the thread budget:
+// a few workers keep more forward passes in flight than one, and cores
+// beyond that are shared between them.
+class DetectorPool {
+public:
+    DetectorPool();
+    ~DetectorPool();
+
+    // Loads the model and starts `workers` replicas (0: one per core).
+    // False when a replica fails to build; the pool is then stopped.
+    bool start(int workers = 0);
+    // Finishes the queued frames, then joins the workers
+    void stop();
+    bool isRunning() const;
+
+    // Frame pixels are shared, not copied: leave them unmodified until the
+    // future is ready. Regions restrict the scan as in
+    // VehicleDetector::detectVehiclesInRegions; empty scans the whole frame.
+    // On a pool that is not running, the future holds a runtime_error.
+    std::future<std::vector<Detection>> submit(const cv::Mat& frame);
+    std::future<std::vector<Detection>> submit(const cv::Mat& frame, std::vector<cv::Rect> regions);
+
+    // Safe from any thread; frames a worker has already taken keep the old values
+    void setConfidenceThreshold(float threshold);
+    void setNMSThreshold(float threshold);
+    void setLatencyStats(LatencyStats* stats);
+
+    int getWorkerCount() const;
+    size_t getQueuedFrames() const;
+    std::string getModelFingerprint() const;
+    LabelId labelForClass(int classId) const;
+
+private:
+    struct Job {
+        cv::Mat frame;
+        std::vector<cv::Rect> regions;
+        std::promise<std::vector<Detection>> result;
+    };
+
+    // Applied by each worker to its own replica when it takes a job
+    struct Settings {
+        float confidenceThreshold;
+        float nmsThreshold;
+        LatencyStats* latencyStats;
+    };
+
+    std::shared_ptr<const DetectorModel> model_;
+    std::vector<std::unique_ptr<VehicleDetector>> replicas_;
+    std::vector<std::thread> workers_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Job> queue_;
+    Settings settings_;
+    bool stopping_;
+
+    void workerLoop(VehicleDetector* detector);
+    // Refuses new jobs and fails the ones queued while start() was building
+    void failQueuedJobs();
+};
@@ -0,0 +1,76 @@
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+FrameArena::FrameArena(size_t initialBytes)
+    : current_(0), offset_(0), scopeDepth_(0) {
+    addBlock(initialBytes);
+}
+
+void* FrameArena::allocate(size_t bytes, size_t alignment) {
+    if (bytes == 0) {
+        bytes = 1;
+    }
+    while (true) {
+        Block& block = blocks_[current_];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.data.get());
+        uintptr_t aligned = (base + offset_ + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        size_t start = static_cast<size_t>(aligned - base);
+        if (start + bytes <= block.size) {
+            offset_ = start + bytes;
+            return block.data.get() + start;
+        }
+        // reset() leaves a single block, so any later ones were added this
+        // frame and are still empty
+        if (current_ + 1 == blocks_.size()) {
+            addBlock(bytes + alignment);
+        }
+        ++current_;
+        offset_ = 0;
+    }
+}
+
+void FrameArena::reset() {
+    if (blocks_.size() > 1) {
+        // Room for the whole of this frame in one block from now on
+        size_t capacity = getCapacity();
+        blocks_.clear();
+        addBlock(capacity);
+    }
+    current_ = 0;
+    offset_ = 0;
+}
+
+size_t FrameArena::getCapacity() const {
+    size_t capacity = 0;
+    for (const auto& block : blocks_) {
+        capacity += block.size;
+    }
+    return capacity;
+}
+
+size_t FrameArena::getUsedBytes() const {
+    size_t used = offset_;
+    for (size_t i = 0; i < current_; ++i) {
+        used += blocks_[i].size;
+    }
+    return used;
+}
+
+void FrameArena::addBlock(size_t minBytes) {
+    size_t size = std::max(minBytes, blocks_.empty() ? size_t(0) : blocks_.back().size * 2);
+    Block block;
+    block.data.reset(new unsigned char[size]);
+    block.size = size;
+    blocks_.push_back(std::move(block));
+}
+
+FrameArenaScope::FrameArenaScope(FrameArena& arena) : arena_(arena) {
+    ++arena_.scopeDepth_;
+}
+
+FrameArenaScope::~FrameArenaScope() {
+    if (--arena_.scopeDepth_ == 0) {
+        arena_.reset();
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Monotonic scratch memory for one frame of tracking. Allocation bumps a
+// pointer; nothing is freed individually, and reset() rewinds everything at
+// frame end. Blocks are kept across frames, so once the arena has grown to a
+// frame's peak it stops touching the heap. Not thread-safe: one arena per
+// tracker.
+class FrameArena {
+public:
+    explicit FrameArena(size_t initialBytes = kDefaultBlockBytes);
+
+    void* allocate(size_t bytes, size_t alignment);
+    // Frees nothing; if the frame spilled into several blocks they are
+    // merged into one, so the next frame fits in a single block
+    void reset();
+
+    size_t getCapacity() const;
+    size_t getUsedBytes() const;
+
+    static constexpr size_t kDefaultBlockBytes = 64 * 1024;
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        size_t size;
+    };
+
+    std::vector<Block> blocks_;
+    size_t current_;  // Block being bumped
+    size_t offset_;   // Into blocks_[current_]
+    int scopeDepth_;  // Open FrameArenaScopes
+
+    void addBlock(size_t minBytes);
+
+    friend class FrameArenaScope;
+};
+
+// Scopes one frame of arena use. Scopes nest (updateAdvanced calls update);
+// the arena is reset when the outermost one ends.
+class FrameArenaScope {
+public:
+    explicit FrameArenaScope(FrameArena& arena);
+    ~FrameArenaScope();
+
+    FrameArenaScope(const FrameArenaScope&) = delete;
+    FrameArenaScope& operator=(const FrameArenaScope&) = delete;
+
+private:
+    FrameArena& arena_;
+};
+
+// Standard allocator over a FrameArena; deallocate is a no-op
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(FrameArena* arena) : arena_(arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.getArena()) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena_->allocate(count * sizeof(T), alignof(T)));
+    }
+    void deallocate(T*, size_t) {}
+
+    FrameArena* getArena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena_ == other.getArena(); }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena_ != other.getArena(); }
+
+private:
+    FrameArena* arena_;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Read-only pointer-and-length view, so one signature accepts a std::vector
+// or an ArenaVector
+template <typename T>
+class ConstSpan {
+public:
+    ConstSpan() : data_(nullptr), size_(0) {}
+    ConstSpan(const T* data, size_t size) : data_(data), size_(size) {}
+    template <typename Allocator>
+    ConstSpan(const std::vector<T, Allocator>& values) : data_(values.data()), size_(values.size()) {}
+
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + size_; }
+    const T& operator[](size_t index) const { return data_[index]; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+private:
+    const T* data_;
+    size_t size_;
+};
@@ -0,0 +1,147 @@
+#include "FrameCache.h"
+#include <algorithm>
+
+FrameCache::FrameCache(size_t maxBytes, int checkpointInterval)
+    : maxBytes_(maxBytes), baseCheckpointInterval_(std::max(1, checkpointInterval)),
+      checkpointInterval_(baseCheckpointInterval_), bytes_(0), checkpointBytes_(0),
+      hits_(0), misses_(0) {
+}
+
+void FrameCache::insert(int frameIndex, const cv::Mat& frame, double timestampMs,
+                        std::shared_ptr<const TrackingState> state) {
+    auto existing = entries_.find(frameIndex);
+    if (existing != entries_.end()) {
+        bytes_ -= existing->second.entry.bytes;
+        recency_.erase(existing->second.position);
+        entries_.erase(existing);
+    }
+    
+    size_t stateBytes = state ? state->byteSize() : 0;
+    if (state && frameIndex % checkpointInterval_ == 0) {
+        addCheckpoint(frameIndex, state);
+    }
+    
+    recency_.push_front(frameIndex);
+    Slot& slot = entries_[frameIndex];
+    slot.entry.frame = frame;
+    slot.entry.timestampMs = timestampMs;
+    slot.entry.state = std::move(state);
+    slot.entry.bytes = frame.total() * frame.elemSize() + stateBytes;
+    slot.position = recency_.begin();
+    bytes_ += slot.entry.bytes;
+    evict();
+}
+
+void FrameCache::addCheckpoint(int frameIndex, std::shared_ptr<const TrackingState> state) {
+    if (!state) return;
+    auto& checkpoint = checkpoints_[frameIndex];
+    if (checkpoint) {
+        checkpointBytes_ -= checkpoint->byteSize();
+    }
+    checkpointBytes_ += state->byteSize();
+    checkpoint = std::move(state);
+    thinCheckpoints();
+}
+
+const FrameCache::Entry* FrameCache::find(int frameIndex) {
+    auto it = entries_.find(frameIndex);
+    if (it == entries_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+    ++hits_;
+    recency_.splice(recency_.begin(), recency_, it->second.position);
+    return &it->second.entry;
+}
+
+std::shared_ptr<const TrackingState> FrameCache::findState(int frameIndex) const {
+    auto it = entries_.find(frameIndex);
+    if (it != entries_.end() && it->second.entry.state) {
+        return it->second.entry.state;
+    }
+    auto checkpoint = checkpoints_.find(frameIndex);
+    return checkpoint != checkpoints_.end() ? checkpoint->second : nullptr;
+}
+
+std::shared_ptr<const TrackingState> FrameCache::findCheckpoint(int frameIndex, int& checkpointFrame) const {
+    auto it = checkpoints_.upper_bound(frameIndex);
+    if (it == checkpoints_.begin()) {
+        checkpointFrame = -1;
+        return nullptr;
+    }
+    --it;
+    checkpointFrame = it->first;
+    return it->second;
+}
+
+void FrameCache::eraseAfter(int frameIndex) {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->first > frameIndex) {
+            bytes_ -= it->second.entry.bytes;
+            recency_.erase(it->second.position);
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (auto it = checkpoints_.upper_bound(frameIndex); it != checkpoints_.end();) {
+        checkpointBytes_ -= it->second->byteSize();
+        it = checkpoints_.erase(it);
+    }
+}
+
+void FrameCache::clear() {
+    recency_.clear();
+    entries_.clear();
+    checkpoints_.clear();
+    bytes_ = 0;
+    checkpointBytes_ = 0;
+    checkpointInterval_ = baseCheckpointInterval_;
+}
+
+size_t FrameCache::size() const {
+    return entries_.size();
+}
+
+size_t FrameCache::getBytes() const {
+    return bytes_ + checkpointBytes_;
+}
+
+size_t FrameCache::getCheckpointCount() const {
+    return checkpoints_.size();
+}
+
+uint64_t FrameCache::getHits() const {
+    return hits_;
+}
+
+uint64_t FrameCache::getMisses() const {
+    return misses_;
+}
+
+void FrameCache::evict() {
+    // Always keep the newest entry, however large
+    while (bytes_ > maxBytes_ && recency_.size() > 1) {
+        int oldest = recency_.back();
+        recency_.pop_back();
+        auto it = entries_.find(oldest);
+        bytes_ -= it->second.entry.bytes;
+        entries_.erase(it);
+    }
+}
+
+void FrameCache::thinCheckpoints() {
+    while (checkpointBytes_ > maxBytes_ / 4 && checkpoints_.size() > 1) {
+        checkpointInterval_ *= 2;
+        // Every other one by position, so checkpoints added off the interval thin out evenly too
+        bool keep = true;
+        for (auto it = checkpoints_.begin(); it != checkpoints_.end(); keep = !keep) {
+            if (!keep) {
+                checkpointBytes_ -= it->second->byteSize();
+                it = checkpoints_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "AdvancedTrackingSystem.h"
+#include <opencv2/opencv.hpp>
+#include <list>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+// Recently processed frames for the controller's step and scrub controls.
+//
+// Each entry holds the rendered frame and the tracker state right after it,
+// so revisiting a frame needs neither a decode nor a tracker update, and
+// tracking can resume from any cached frame. Entries are evicted least
+// recently used once maxBytes is exceeded.
+//
+// Every checkpointInterval-th state is also kept as a checkpoint that
+// survives eviction; a seek outside the cache replays the tracker from the
+// nearest earlier checkpoint. Checkpoints get a quarter of the budget; when
+// they outgrow it every other one is dropped and the interval doubles.
+class FrameCache {
+public:
+    static constexpr size_t kDefaultMaxBytes = 512u * 1024 * 1024;
+    static constexpr int kDefaultCheckpointInterval = 30;
+
+    struct Entry {
+        cv::Mat frame;
+        double timestampMs;  // Source presentation time
+        std::shared_ptr<const TrackingState> state;
+        size_t bytes;
+    };
+
+    explicit FrameCache(size_t maxBytes = kDefaultMaxBytes,
+                        int checkpointInterval = kDefaultCheckpointInterval);
+
+    void insert(int frameIndex, const cv::Mat& frame, double timestampMs,
+                std::shared_ptr<const TrackingState> state);
+    // Checkpoint from elsewhere, e.g. a snapshot file written by a batch run
+    void addCheckpoint(int frameIndex, std::shared_ptr<const TrackingState> state);
+    // Marks the entry as recently used; null on a miss
+    const Entry* find(int frameIndex);
+    // Tracker state after frameIndex from an entry or checkpoint; null if neither
+    std::shared_ptr<const TrackingState> findState(int frameIndex) const;
+    // Latest checkpoint at or before frameIndex; checkpointFrame is -1 if none
+    std::shared_ptr<const TrackingState> findCheckpoint(int frameIndex, int& checkpointFrame) const;
+
+    // Drops everything after frameIndex, e.g. once a parameter change makes
+    // later results stale
+    void eraseAfter(int frameIndex);
+    void clear();
+
+    size_t size() const;
+    size_t getBytes() const;
+    size_t getCheckpointCount() const;
+    uint64_t getHits() const;
+    uint64_t getMisses() const;
+
+private:
+    struct Slot {
+        Entry entry;
+        std::list<int>::iterator position;
+    };
+
+    size_t maxBytes_;
+    int baseCheckpointInterval_;
+    int checkpointInterval_;
+    std::list<int> recency_;  // Most recently used first
+    std::unordered_map<int, Slot> entries_;
+    std::map<int, std::shared_ptr<const TrackingState>> checkpoints_;
+    size_t bytes_;
+    size_t checkpointBytes_;
+    uint64_t hits_;
+    uint64_t misses_;
+
+    void evict();
+    void thinCheckpoints();
+};
@@ -0,0 +1,58 @@
+#include "KeyframeIndex.h"
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+KeyframeIndex::KeyframeIndex()
+    : frameCount_(0) {
+}
+
+bool KeyframeIndex::build(const std::string& videoPath) {
+    clear();
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+    // Raw stream mode hands back compressed packets; grab() only demuxes
+    cv::VideoCapture demuxer(videoPath, cv::CAP_FFMPEG, {cv::CAP_PROP_FORMAT, -1});
+    if (!demuxer.isOpened()) {
+        return false;
+    }
+    int frameIndex = 0;
+    while (demuxer.grab()) {
+        if (demuxer.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0.0) {
+            keyframes_.push_back(frameIndex);
+        }
+        ++frameIndex;
+    }
+    if (keyframes_.empty()) {
+        return false;
+    }
+    frameCount_ = frameIndex;
+    return true;
+#else
+    (void)videoPath;
+    return false;
+#endif
+}
+
+void KeyframeIndex::clear() {
+    keyframes_.clear();
+    frameCount_ = 0;
+}
+
+bool KeyframeIndex::empty() const {
+    return keyframes_.empty();
+}
+
+int KeyframeIndex::keyframeAtOrBefore(int frameIndex) const {
+    if (keyframes_.empty()) {
+        return frameIndex;
+    }
+    auto it = std::upper_bound(keyframes_.begin(), keyframes_.end(), frameIndex);
+    return it == keyframes_.begin() ? 0 : *(it - 1);
+}
+
+size_t KeyframeIndex::getKeyframeCount() const {
+    return keyframes_.size();
+}
+
+int KeyframeIndex::getFrameCount() const {
+    return frameCount_;
+}
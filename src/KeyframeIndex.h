@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Frame numbers of a video's keyframes, read from the container without
+// decoding. Seeking anywhere between two keyframes decodes from the earlier
+// one, so the index tells the controller when stepping forward with grab()
+// is cheaper than a seek, and where a cold restart of the tracker can begin.
+//
+// Needs OpenCV 4.6+ with the FFmpeg backend; otherwise build() fails and
+// every frame is treated as a keyframe.
+class KeyframeIndex {
+public:
+    KeyframeIndex();
+
+    bool build(const std::string& videoPath);
+    void clear();
+    bool empty() const;
+
+    // Latest keyframe at or before frameIndex
+    int keyframeAtOrBefore(int frameIndex) const;
+    size_t getKeyframeCount() const;
+    // Frames seen by the demuxer; 0 when the index is empty
+    int getFrameCount() const;
+
+private:
+    std::vector<int> keyframes_;
+    int frameCount_;
+};
@@ -0,0 +1,51 @@
+#include "LabelTable.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+struct LabelTable {
+    std::mutex mutex;
+    std::unordered_map<std::string, LabelId> ids;
+    // Slots below count are immutable once published
+    std::string names[kMaxLabels];
+    std::atomic<size_t> count;
+
+    LabelTable() : count(1) {
+        names[kUnknownLabel] = "unknown";
+        ids.emplace(names[kUnknownLabel], kUnknownLabel);
+    }
+};
+
+LabelTable& table() {
+    static LabelTable instance;
+    return instance;
+}
+
+} // namespace
+
+LabelId internLabel(const std::string& name) {
+    LabelTable& labels = table();
+    std::lock_guard<std::mutex> lock(labels.mutex);
+    auto found = labels.ids.find(name);
+    if (found != labels.ids.end()) {
+        return found->second;
+    }
+    size_t count = labels.count.load(std::memory_order_relaxed);
+    if (count >= kMaxLabels) {
+        return kUnknownLabel;
+    }
+    labels.names[count] = name;
+    labels.ids.emplace(name, static_cast<LabelId>(count));
+    labels.count.store(count + 1, std::memory_order_release);
+    return static_cast<LabelId>(count);
+}
+
+const std::string& labelName(LabelId id) {
+    LabelTable& labels = table();
+    if (id >= labels.count.load(std::memory_order_acquire)) {
+        return labels.names[kUnknownLabel];
+    }
+    return labels.names[id];
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Class labels are interned once and carried as small ids, so detections
+// and tracks copy a uint16_t per frame instead of a std::string.
+//
+// Ids are process-local; anything persisted (snapshots, exports) writes the
+// name. Names are never removed, so a labelName() reference stays valid for
+// the life of the process. Interning takes a lock; labelName() does not.
+using LabelId = uint16_t;
+
+// Always interned as "unknown"; also returned once the table is full
+constexpr LabelId kUnknownLabel = 0;
+constexpr size_t kMaxLabels = 1024;
+
+LabelId internLabel(const std::string& name);
+const std::string& labelName(LabelId id);
@@ -0,0 +1,183 @@
+#include "LatencyHistogram.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+
+int highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) ++bit;
+    return bit;
+#endif
+}
+
+double toMs(uint64_t nanoseconds) {
+    return nanoseconds / 1e6;
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+int LatencyHistogram::bucketIndex(uint64_t value) {
+    // Values below one sub-bucket range are counted exactly
+    if (value < static_cast<uint64_t>(kSubBucketCount)) {
+        return static_cast<int>(value);
+    }
+    int shift = highestBit(value) - kSubBucketBits;
+    int subBucket = static_cast<int>((value >> shift) & (kSubBucketCount - 1));
+    return (shift + 1) * kSubBucketCount + subBucket;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(int index) {
+    if (index < kSubBucketCount) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = index / kSubBucketCount - 1;
+    uint64_t subBucket = static_cast<uint64_t>(index % kSubBucketCount);
+    uint64_t lower = (static_cast<uint64_t>(kSubBucketCount) + subBucket) << shift;
+    return lower + ((1ULL << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    counts_[bucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+
+    uint64_t max = max_.load(std::memory_order_relaxed);
+    while (nanoseconds > max &&
+           !max_.compare_exchange_weak(max, nanoseconds, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return count_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getMax() const {
+    return max_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getSum() const {
+    return sum_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getMean() const {
+    uint64_t count = getCount();
+    return count > 0 ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / count : 0.0;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    uint64_t count = getCount();
+    if (count == 0) return 0;
+
+    double fraction = std::max(0.0, std::min(100.0, percentile)) / 100.0;
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * count)));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBucketCount; ++i) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(bucketUpperBound(i), getMax());
+        }
+    }
+    // Counts raced ahead of count_ while reading
+    return getMax();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : counts_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+const char* LatencyStats::stageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::Decode: return "decode";
+        case LatencyStage::Preprocess: return "preprocess";
+        case LatencyStage::Inference: return "inference";
+        case LatencyStage::Postprocess: return "postprocess";
+        case LatencyStage::Association: return "association";
+        case LatencyStage::Appearance: return "appearance";
+        case LatencyStage::CameraMotion: return "camera_motion";
+        case LatencyStage::Render: return "render";
+        case LatencyStage::Encode: return "encode";
+        case LatencyStage::Frame: return "frame";
+        default: return "unknown";
+    }
+}
+
+void LatencyStats::record(LatencyStage stage, uint64_t nanoseconds) {
+    histograms_[static_cast<int>(stage)].record(nanoseconds);
+}
+
+const LatencyHistogram& LatencyStats::get(LatencyStage stage) const {
+    return histograms_[static_cast<int>(stage)];
+}
+
+void LatencyStats::reset() {
+    for (auto& histogram : histograms_) {
+        histogram.reset();
+    }
+}
+
+void LatencyStats::printSummary(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << "Stage latency (ms):" << std::endl;
+    out << "  " << std::left << std::setw(15) << "stage" << std::right
+        << std::setw(10) << "count" << std::setw(10) << "p50" << std::setw(10) << "p95"
+        << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+    out << std::fixed << std::setprecision(2);
+    for (int i = 0; i < kStageCount; ++i) {
+        const LatencyHistogram& histogram = histograms_[i];
+        if (histogram.getCount() == 0) continue;
+        out << "  " << std::left << std::setw(15) << stageName(static_cast<LatencyStage>(i)) << std::right
+            << std::setw(10) << histogram.getCount()
+            << std::setw(10) << toMs(histogram.getPercentile(50.0))
+            << std::setw(10) << toMs(histogram.getPercentile(95.0))
+            << std::setw(10) << toMs(histogram.getPercentile(99.0))
+            << std::setw(10) << toMs(histogram.getMax()) << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+StageTimer::StageTimer(LatencyStats* stats, LatencyStage stage)
+    : stats_(stats), stage_(stage), start_(std::chrono::steady_clock::now()),
+      elapsed_(0), stopped_(false) {
+}
+
+StageTimer::~StageTimer() {
+    stop();
+}
+
+uint64_t StageTimer::stop() {
+    if (!stopped_) {
+        stopped_ = true;
+        elapsed_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start_).count());
+        if (stats_) {
+            stats_->record(stage_, elapsed_);
+        }
+        if (Tracer::isEnabled()) {
+            Tracer::recordComplete(LatencyStats::stageName(stage_), start_, elapsed_);
+        }
+    }
+    return elapsed_;
+}
+
+void StageTimer::cancel() {
+    stopped_ = true;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+// Log-linear latency histogram in the style of HdrHistogram.
+//
+// Values are nanoseconds. Each power of two is split into 32 linear
+// sub-buckets, so any reported value is within ~3% of the true one across the
+// full 64-bit range, in a fixed 15 KB. record() is lock-free (relaxed atomic
+// increments), so a reporting thread can read percentiles while the
+// pipeline is still recording.
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t nanoseconds);
+
+    uint64_t getCount() const;
+    uint64_t getMax() const;
+    uint64_t getSum() const;
+    double getMean() const;
+    // percentile is 0-100; returns the bucket's upper bound, capped at the max
+    uint64_t getPercentile(double percentile) const;
+
+    // Not atomic with respect to concurrent record() calls
+    void reset();
+
+private:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+    static constexpr int kBucketCount = (64 - kSubBucketBits + 1) * kSubBucketCount;
+
+    std::atomic<uint64_t> counts_[kBucketCount];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(int index);
+};
+
+enum class LatencyStage {
+    Decode,        // Reading the next frame from the source
+    Preprocess,    // Detector input preparation (blob conversion)
+    Inference,     // Network forward pass or HOG scan
+    Postprocess,   // Decoding network output and NMS
+    Association,   // Matching detections to tracks and updating track state
+    Appearance,    // Occlusion handling, re-identification and track merging
+    CameraMotion,  // Global motion estimation and compensation
+    Render,        // Drawing tracks and overlays
+    Encode,        // Writing the output frame
+    Frame,         // Whole processed frame, decode excluded
+    Count
+};
+
+// One histogram per pipeline stage, shared by the components that time them
+class LatencyStats {
+public:
+    static constexpr int kStageCount = static_cast<int>(LatencyStage::Count);
+
+    static const char* stageName(LatencyStage stage);
+
+    void record(LatencyStage stage, uint64_t nanoseconds);
+    const LatencyHistogram& get(LatencyStage stage) const;
+    void reset();
+
+    // p50/p95/p99/max in milliseconds for every stage with samples
+    void printSummary(std::ostream& out) const;
+
+private:
+    LatencyHistogram histograms_[kStageCount];
+};
+
+// Times a scope with the monotonic clock and records it into stats on
+// destruction, and onto the trace timeline when tracing is on. With a null
+// stats pointer it only measures, so components can be instrumented
+// unconditionally.
+class StageTimer {
+public:
+    StageTimer(LatencyStats* stats, LatencyStage stage);
+    ~StageTimer();
+
+    // Records now rather than at scope exit; returns the elapsed nanoseconds.
+    // Only the first call records.
+    uint64_t stop();
+    // Drops the sample, e.g. for a read that hit the end of the stream
+    void cancel();
+
+private:
+    LatencyStats* stats_;
+    LatencyStage stage_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t elapsed_;
+    bool stopped_;
+};
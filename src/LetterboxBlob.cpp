@@ -0,0 +1,136 @@
+#include "LetterboxBlob.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Bilinear taps mapping `outputs` samples onto `inputs`, pixel centres aligned
+void computeTaps(int inputs, int outputs, std::vector<int>& first, std::vector<int>& second,
+                 std::vector<float>& weights) {
+    first.resize(outputs);
+    second.resize(outputs);
+    weights.resize(outputs);
+    const double ratio = static_cast<double>(inputs) / outputs;
+    for (int i = 0; i < outputs; ++i) {
+        double position = std::max(0.0, (i + 0.5) * ratio - 0.5);
+        int left = std::min(static_cast<int>(position), inputs - 1);
+        first[i] = left;
+        second[i] = std::min(left + 1, inputs - 1);
+        weights[i] = static_cast<float>(std::min(position - left, 1.0));
+    }
+}
+
+}  // namespace
+
+cv::Rect LetterboxTransform::toFrame(float centerX, float centerY, float width, float height) const {
+    float inverse = 1.0f / scale;
+    float left = (centerX - width / 2 - padX) * inverse;
+    float top = (centerY - height / 2 - padY) * inverse;
+    return cv::Rect(static_cast<int>(left), static_cast<int>(top),
+                    static_cast<int>(width * inverse), static_cast<int>(height * inverse));
+}
+
+LetterboxBlob::LetterboxBlob() {
+}
+
+const cv::Mat& LetterboxBlob::prepare(const cv::Mat& frame, const cv::Size& inputSize) {
+    const cv::Mat* source = &frame;
+    if (frame.type() == CV_8UC1) {
+        cv::cvtColor(frame, bgr_, cv::COLOR_GRAY2BGR);
+        source = &bgr_;
+    }
+    CV_Assert(source->type() == CV_8UC3 && !source->empty());
+
+    if (source->size() != frameSize_ || inputSize != inputSize_) {
+        configure(source->size(), inputSize);
+    }
+
+    const int width = inputSize_.width;
+    const int planeSize = width * inputSize_.height;
+    float* red = blob_.ptr<float>();
+    float* green = red + planeSize;
+    float* blue = green + planeSize;
+    const int contentWidth = transform_.content.width;
+    const float normalize = 1.0f / 255.0f;
+
+    // Consecutive output rows often share source rows; keep the last two
+    int upperIndex = -1, lowerIndex = -1;
+    for (int y = 0; y < transform_.content.height; ++y) {
+        int top = rowTop_[y];
+        int bottom = rowBottom_[y];
+        if (top != upperIndex) {
+            if (top == lowerIndex) {
+                std::swap(upperRow_, lowerRow_);
+                std::swap(upperIndex, lowerIndex);
+            } else {
+                resampleRow(source->ptr<uchar>(top), upperRow_);
+                upperIndex = top;
+            }
+        }
+        if (bottom != lowerIndex) {
+            resampleRow(source->ptr<uchar>(bottom), lowerRow_);
+            lowerIndex = bottom;
+        }
+
+        // Vertical blend, normalization, channel swap and planar store
+        const float lowerWeight = rowWeights_[y] * normalize;
+        const float upperWeight = normalize - lowerWeight;
+        const float* upper = upperRow_.data();
+        const float* lower = lowerRow_.data();
+        size_t offset = static_cast<size_t>(transform_.padY + y) * width + transform_.padX;
+        float* r = red + offset;
+        float* g = green + offset;
+        float* b = blue + offset;
+        for (int x = 0; x < contentWidth; ++x) {
+            b[x] = upper[3 * x] * upperWeight + lower[3 * x] * lowerWeight;
+            g[x] = upper[3 * x + 1] * upperWeight + lower[3 * x + 1] * lowerWeight;
+            r[x] = upper[3 * x + 2] * upperWeight + lower[3 * x + 2] * lowerWeight;
+        }
+    }
+    return blob_;
+}
+
+const LetterboxTransform& LetterboxBlob::transform() const {
+    return transform_;
+}
+
+void LetterboxBlob::configure(const cv::Size& frameSize, const cv::Size& inputSize) {
+    frameSize_ = frameSize;
+    inputSize_ = inputSize;
+
+    float scale = std::min(static_cast<float>(inputSize.width) / frameSize.width,
+                           static_cast<float>(inputSize.height) / frameSize.height);
+    transform_.scale = scale;
+    transform_.content = cv::Size(
+        std::max(1, std::min(inputSize.width, static_cast<int>(std::lround(frameSize.width * scale)))),
+        std::max(1, std::min(inputSize.height, static_cast<int>(std::lround(frameSize.height * scale)))));
+    transform_.padX = (inputSize.width - transform_.content.width) / 2;
+    transform_.padY = (inputSize.height - transform_.content.height) / 2;
+
+    const int dims[4] = {1, 3, inputSize.height, inputSize.width};
+    blob_.create(4, dims, CV_32F);
+    blob_.setTo(cv::Scalar(kPadValue));
+
+    computeTaps(frameSize.width, transform_.content.width, columnLeft_, columnRight_, columnWeights_);
+    for (size_t i = 0; i < columnLeft_.size(); ++i) {
+        columnLeft_[i] *= 3;
+        columnRight_[i] *= 3;
+    }
+    computeTaps(frameSize.height, transform_.content.height, rowTop_, rowBottom_, rowWeights_);
+
+    upperRow_.resize(static_cast<size_t>(transform_.content.width) * 3);
+    lowerRow_.resize(upperRow_.size());
+}
+
+void LetterboxBlob::resampleRow(const uchar* source, std::vector<float>& row) const {
+    float* out = row.data();
+    const int count = static_cast<int>(columnLeft_.size());
+    for (int x = 0; x < count; ++x) {
+        const uchar* left = source + columnLeft_[x];
+        const uchar* right = source + columnRight_[x];
+        float weight = columnWeights_[x];
+        out[3 * x] = left[0] + (right[0] - left[0]) * weight;
+        out[3 * x + 1] = left[1] + (right[1] - left[1]) * weight;
+        out[3 * x + 2] = left[2] + (right[2] - left[2]) * weight;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Placement of a frame inside a letterboxed network input: scaled by
+// `scale` on both axes, so the aspect ratio is kept, and centred with
+// padX / padY pixels of border.
+struct LetterboxTransform {
+    float scale;
+    int padX;
+    int padY;
+    cv::Size content;  // The scaled frame, in input pixels
+
+    LetterboxTransform() : scale(1.0f), padX(0), padY(0) {}
+
+    // Box in input pixels, by center and size, back to frame pixels
+    cv::Rect toFrame(float centerX, float centerY, float width, float height) const;
+};
+
+// Detector input built in place.
+//
+// prepare() writes the frame letterboxed into a 1x3xHxW float blob in one
+// pass: bilinear resampling, BGR to RGB, scaling to [0, 1] and the planar
+// CHW store happen per output row, with only two resampled source rows as
+// intermediates. blobFromImage does the same in separate full-image passes
+// and stretches the frame. The blob is allocated once (cv::Mat data is
+// 64-byte aligned) and reused; the border is painted only when the frame
+// or input size changes.
+class LetterboxBlob {
+public:
+    // Darknet's letterbox fill
+    static constexpr float kPadValue = 0.5f;
+
+    LetterboxBlob();
+
+    // 8-bit BGR or grey frame in, blob out; valid until the next call
+    const cv::Mat& prepare(const cv::Mat& frame, const cv::Size& inputSize);
+    const LetterboxTransform& transform() const;
+
+private:
+    cv::Mat blob_;
+    cv::Size inputSize_;
+    cv::Size frameSize_;
+    LetterboxTransform transform_;
+
+    // Bilinear taps, per output column (byte offsets into a BGR row) and row
+    std::vector<int> columnLeft_;
+    std::vector<int> columnRight_;
+    std::vector<float> columnWeights_;
+    std::vector<int> rowTop_;
+    std::vector<int> rowBottom_;
+    std::vector<float> rowWeights_;
+
+    // Source rows resampled to the content width, interleaved BGR
+    std::vector<float> upperRow_;
+    std::vector<float> lowerRow_;
+    cv::Mat bgr_;  // Grey frames, expanded
+
+    void configure(const cv::Size& frameSize, const cv::Size& inputSize);
+    void resampleRow(const uchar* source, std::vector<float>& row) const;
+};
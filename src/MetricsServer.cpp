@@ -0,0 +1,227 @@
+#include "MetricsServer.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// How often the accept loop checks for stop()
+constexpr int kPollIntervalMs = 200;
+constexpr size_t kMaxRequestBytes = 8192;
+
+#ifndef _WIN32
+void sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+void sendResponse(int fd, const char* status, const char* contentType, const std::string& body) {
+    std::string response = std::string("HTTP/1.1 ") + status + "\r\n" +
+        "Content-Type: " + contentType + "\r\n" +
+        "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+        "Connection: close\r\n\r\n" + body;
+    sendAll(fd, response);
+}
+#endif
+
+} // namespace
+
+MetricsServer::MetricsServer()
+    : listenFd_(-1), stopping_(false) {
+}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(const std::string& endpoint, RenderFunction render) {
+    stop();
+#ifdef _WIN32
+    (void)endpoint;
+    (void)render;
+    std::cerr << "Error: The metrics endpoint is not supported on Windows" << std::endl;
+    return false;
+#else
+    bool listening = false;
+    if (endpoint.compare(0, 5, "unix:") == 0) {
+        listening = listenUnix(endpoint.substr(5));
+    } else {
+        std::string host = "127.0.0.1";
+        std::string port = endpoint;
+        std::string::size_type colon = endpoint.rfind(':');
+        if (colon != std::string::npos) {
+            host = endpoint.substr(0, colon);
+            port = endpoint.substr(colon + 1);
+        }
+        try {
+            listening = listenTcp(host, std::stoi(port));
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid metrics endpoint: " << endpoint << std::endl;
+            return false;
+        }
+    }
+    if (!listening) {
+        return false;
+    }
+
+    render_ = std::move(render);
+    stopping_ = false;
+    thread_ = std::thread(&MetricsServer::serveLoop, this);
+    std::cout << "Serving metrics on " << endpoint << " (GET /metrics)" << std::endl;
+    return true;
+#endif
+}
+
+void MetricsServer::stop() {
+    stopping_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+#ifndef _WIN32
+    if (listenFd_ >= 0) {
+        close(listenFd_);
+        listenFd_ = -1;
+    }
+    if (!unixPath_.empty()) {
+        unlink(unixPath_.c_str());
+        unixPath_.clear();
+    }
+#endif
+}
+
+bool MetricsServer::isRunning() const {
+    return thread_.joinable() && !stopping_;
+}
+
+bool MetricsServer::listenTcp(const std::string& host, int port) {
+#ifndef _WIN32
+    sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (port <= 0 || port > 65535 || inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Error: Invalid metrics address " << host << ":" << port << std::endl;
+        return false;
+    }
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    if (listenFd_ < 0 ||
+        setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+        bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd_, 8) != 0) {
+        std::cerr << "Error: Could not listen on " << host << ":" << port << ": "
+                  << std::strerror(errno) << std::endl;
+        if (listenFd_ >= 0) close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    return true;
+#else
+    (void)host;
+    (void)port;
+    return false;
+#endif
+}
+
+bool MetricsServer::listenUnix(const std::string& path) {
+#ifndef _WIN32
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Invalid metrics socket path: " << path << std::endl;
+        return false;
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    // A stale socket from a crashed run would make bind fail; anything else
+    // at the path is not ours to remove
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            std::cerr << "Error: Metrics socket path exists and is not a socket: " << path << std::endl;
+            return false;
+        }
+        unlink(path.c_str());
+    }
+    listenFd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd_ < 0 ||
+        bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenFd_, 8) != 0) {
+        std::cerr << "Error: Could not listen on " << path << ": " << std::strerror(errno) << std::endl;
+        if (listenFd_ >= 0) close(listenFd_);
+        listenFd_ = -1;
+        return false;
+    }
+    unixPath_ = path;
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+void MetricsServer::serveLoop() {
+#ifndef _WIN32
+    while (!stopping_) {
+        pollfd listener = {listenFd_, POLLIN, 0};
+        if (poll(&listener, 1, kPollIntervalMs) <= 0) continue;
+
+        int client = accept(listenFd_, nullptr, nullptr);
+        if (client < 0) continue;
+        handleClient(client);
+        close(client);
+    }
+#endif
+}
+
+void MetricsServer::handleClient(int fd) {
+#ifndef _WIN32
+    // A stalled client must not hold up the next scrape for long
+    timeval timeout = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestBytes) {
+        ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+        if (n <= 0) break;
+        request.append(buffer, static_cast<size_t>(n));
+    }
+
+    std::string::size_type lineEnd = request.find("\r\n");
+    std::string requestLine = request.substr(0, lineEnd);
+    if (requestLine.compare(0, 4, "GET ") != 0) {
+        sendResponse(fd, "405 Method Not Allowed", "text/plain", "Only GET is supported\n");
+        return;
+    }
+
+    std::string target = requestLine.substr(4, requestLine.find(' ', 4) - 4);
+    if (target == "/metrics" || target.compare(0, 9, "/metrics?") == 0) {
+        sendResponse(fd, "200 OK", "text/plain; version=0.0.4; charset=utf-8", render_());
+    } else if (target == "/") {
+        sendResponse(fd, "200 OK", "text/plain", "Car chase tracker metrics: GET /metrics\n");
+    } else {
+        sendResponse(fd, "404 Not Found", "text/plain", "Not found\n");
+    }
+#else
+    (void)fd;
+#endif
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+// Minimal HTTP endpoint for Prometheus scrapes.
+//
+// Serves GET /metrics from a background thread, one connection at a time;
+// the render callback runs on that thread for every scrape, so it must only
+// read state that is safe to read concurrently (atomics). Listens on
+// loopback TCP ("9464" or "host:9464") or a Unix socket ("unix:/path").
+class MetricsServer {
+public:
+    using RenderFunction = std::function<std::string()>;
+
+    MetricsServer();
+    ~MetricsServer();
+
+    bool start(const std::string& endpoint, RenderFunction render);
+    void stop();
+    bool isRunning() const;
+
+private:
+    int listenFd_;
+    std::string unixPath_;
+    RenderFunction render_;
+    std::thread thread_;
+    std::atomic<bool> stopping_;
+
+    bool listenTcp(const std::string& host, int port);
+    bool listenUnix(const std::string& path);
+    void serveLoop();
+    void handleClient(int fd);
+};
@@ -0,0 +1,192 @@
+#include "MotionGate.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Width of the grey image motion is measured on
+const int kGateWidth = 320;
+// Proposals covering more than this share of the frame are not worth
+// cutting up; the detector scans the whole frame instead
+const double kFullScanCoverage = 0.6;
+
+}  // namespace
+
+MotionGate::MotionGate()
+    : tileSize_(128), fullScanInterval_(15), differenceThreshold_(25), minChangedFraction_(0.02f),
+      framesSinceFullScan_(0), scannedFraction_(0.0), frameCount_(0), fullScans_(0),
+      gatedFrames_(0) {
+}
+
+bool MotionGate::propose(const cv::Mat& frame, const std::vector<cv::Rect>& trackBoxes,
+                         std::vector<cv::Rect>& regions) {
+    regions.clear();
+    if (frame.empty()) return false;
+    frameCount_++;
+
+    // Shrink first so the colour conversion only touches the small image
+    double scale = std::max(1.0, static_cast<double>(frame.cols) / kGateWidth);
+    cv::Size smallSize(std::max(1, cvRound(frame.cols / scale)), std::max(1, cvRound(frame.rows / scale)));
+    cv::resize(frame, warped_, smallSize, 0, 0, cv::INTER_AREA);
+    if (warped_.channels() == 3) {
+        cv::cvtColor(warped_, small_, cv::COLOR_BGR2GRAY);
+    } else {
+        warped_.copyTo(small_);
+    }
+    small_.convertTo(smallFloat_, CV_32F);
+
+    bool haveReference = !previousSmall_.empty() && previousSmall_.size() == small_.size();
+    bool proposed = false;
+    if (haveReference && framesSinceFullScan_ + 1 < fullScanInterval_) {
+        // Camera motion between the two frames, then the residual motion
+        if (hanning_.size() != small_.size()) {
+            cv::createHanningWindow(hanning_, small_.size(), CV_32F);
+        }
+        cv::Point2d shift = cv::phaseCorrelate(previousSmallFloat_, smallFloat_, hanning_);
+        cv::Mat transform = (cv::Mat_<double>(2, 3) << 1, 0, shift.x, 0, 1, shift.y);
+        cv::warpAffine(previousSmall_, warped_, transform, small_.size(), cv::INTER_LINEAR,
+                       cv::BORDER_REPLICATE);
+        cv::absdiff(small_, warped_, difference_);
+        cv::threshold(difference_, mask_, differenceThreshold_, 255, cv::THRESH_BINARY);
+
+        int tileSmall = std::max(4, cvRound(tileSize_ / scale));
+        int columns = (small_.cols + tileSmall - 1) / tileSmall;
+        int rows = (small_.rows + tileSmall - 1) / tileSmall;
+        activeTiles_.assign(static_cast<size_t>(columns) * rows, 0);
+
+        for (int row = 0; row < rows; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                cv::Rect tile(column * tileSmall, row * tileSmall, tileSmall, tileSmall);
+                tile &= cv::Rect(0, 0, small_.cols, small_.rows);
+                int changed = cv::countNonZero(mask_(tile));
+                if (changed >= minChangedFraction_ * tile.area()) {
+                    activeTiles_[row * columns + column] = 1;
+                }
+            }
+        }
+
+        // Tracked vehicles are rescanned even when they are standing still
+        for (const auto& box : trackBoxes) {
+            int firstColumn = std::max(0, static_cast<int>(box.x / scale) / tileSmall);
+            int firstRow = std::max(0, static_cast<int>(box.y / scale) / tileSmall);
+            int lastColumn = std::min(columns - 1, static_cast<int>((box.x + box.width) / scale) / tileSmall);
+            int lastRow = std::min(rows - 1, static_cast<int>((box.y + box.height) / scale) / tileSmall);
+            for (int row = firstRow; row <= lastRow; ++row) {
+                for (int column = firstColumn; column <= lastColumn; ++column) {
+                    activeTiles_[row * columns + column] = 1;
+                }
+            }
+        }
+
+        mergeTiles(columns, rows, frame.size(), tileSmall * scale, regions);
+
+        double covered = 0.0;
+        for (const auto& region : regions) {
+            covered += region.area();
+        }
+        double coverage = covered / (static_cast<double>(frame.cols) * frame.rows);
+        if (coverage < kFullScanCoverage) {
+            proposed = true;
+            framesSinceFullScan_++;
+            gatedFrames_++;
+            scannedFraction_ += coverage;
+        }
+    }
+
+    // Next frame is compared against this one
+    cv::swap(previousSmall_, small_);
+    cv::swap(previousSmallFloat_, smallFloat_);
+
+    return proposed || fullScan(regions);
+}
+
+void MotionGate::reset() {
+    previousSmall_.release();
+    previousSmallFloat_.release();
+    framesSinceFullScan_ = 0;
+}
+
+bool MotionGate::fullScan(std::vector<cv::Rect>& regions) {
+    regions.clear();
+    framesSinceFullScan_ = 0;
+    fullScans_++;
+    scannedFraction_ += 1.0;
+    return false;
+}
+
+void MotionGate::mergeTiles(int columns, int rows, const cv::Size& frameSize, double tilePixels,
+                            std::vector<cv::Rect>& regions) {
+    // Connected groups of active tiles, one region each
+    tileComponent_.assign(activeTiles_.size(), -1);
+    const cv::Rect frameRect(0, 0, frameSize.width, frameSize.height);
+    // Vehicles cut by a tile edge still fit whole in the padded region
+    const int padding = cvRound(tilePixels / 2);
+
+    for (int start = 0; start < static_cast<int>(activeTiles_.size()); ++start) {
+        if (!activeTiles_[start] || tileComponent_[start] >= 0) continue;
+
+        int component = static_cast<int>(regions.size());
+        int minColumn = columns, minRow = rows, maxColumn = -1, maxRow = -1;
+        stack_.clear();
+        stack_.push_back(start);
+        tileComponent_[start] = component;
+        while (!stack_.empty()) {
+            int tile = stack_.back();
+            stack_.pop_back();
+            int column = tile % columns;
+            int row = tile / columns;
+            minColumn = std::min(minColumn, column);
+            maxColumn = std::max(maxColumn, column);
+            minRow = std::min(minRow, row);
+            maxRow = std::max(maxRow, row);
+
+            const int neighbours[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+            for (const auto& offset : neighbours) {
+                int nextColumn = column + offset[0];
+                int nextRow = row + offset[1];
+                if (nextColumn < 0 || nextColumn >= columns || nextRow < 0 || nextRow >= rows) continue;
+                int next = nextRow * columns + nextColumn;
+                if (activeTiles_[next] && tileComponent_[next] < 0) {
+                    tileComponent_[next] = component;
+                    stack_.push_back(next);
+                }
+            }
+        }
+
+        cv::Rect region(cvRound(minColumn * tilePixels) - padding, cvRound(minRow * tilePixels) - padding,
+                        cvRound((maxColumn - minColumn + 1) * tilePixels) + 2 * padding,
+                        cvRound((maxRow - minRow + 1) * tilePixels) + 2 * padding);
+        region &= frameRect;
+        if (region.area() > 0) {
+            regions.push_back(region);
+        }
+    }
+}
+
+void MotionGate::setTileSize(int pixels) {
+    tileSize_ = std::max(16, pixels);
+}
+
+void MotionGate::setFullScanInterval(int frames) {
+    fullScanInterval_ = std::max(1, frames);
+}
+
+void MotionGate::setDifferenceThreshold(int greyLevels) {
+    differenceThreshold_ = std::max(1, std::min(255, greyLevels));
+}
+
+void MotionGate::setMinChangedFraction(float fraction) {
+    minChangedFraction_ = std::max(0.0f, std::min(1.0f, fraction));
+}
+
+double MotionGate::getScannedFraction() const {
+    return frameCount_ > 0 ? scannedFraction_ / frameCount_ : 1.0;
+}
+
+uint64_t MotionGate::getFullScanCount() const {
+    return fullScans_;
+}
+
+uint64_t MotionGate::getGatedFrameCount() const {
+    return gatedFrames_;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// Region proposals for the detector on footage where most of the frame is
+// static once the camera's own motion is removed.
+//
+// Each frame is shrunk to a small grey image. The global shift against the
+// previous one is estimated by phase correlation, the previous image is
+// warped by it and differenced, and the frame is cut into tiles. Tiles with
+// enough changed pixels, or under an existing track, are merged into
+// rectangles for the detector. Every fullScanInterval frames, and whenever
+// the proposals would cover most of the frame anyway, the whole frame is
+// scanned instead so vehicles that stopped or were missed are picked up.
+class MotionGate {
+public:
+    MotionGate();
+
+    // Regions of frame the detector should scan, in frame pixels. Returns
+    // false when the whole frame should be scanned; regions is then empty.
+    // trackBoxes are the current tracks, in the same pixels as frame.
+    bool propose(const cv::Mat& frame, const std::vector<cv::Rect>& trackBoxes,
+                 std::vector<cv::Rect>& regions);
+    // Forces a full scan on the next frame (seeks, source changes)
+    void reset();
+
+    void setTileSize(int pixels);
+    void setFullScanInterval(int frames);
+    void setDifferenceThreshold(int greyLevels);
+    void setMinChangedFraction(float fraction);
+
+    // Share of frame pixels handed to the detector so far, full scans
+    // counted as 1; the detector work saved is roughly 1 minus this
+    double getScannedFraction() const;
+    uint64_t getFullScanCount() const;
+    uint64_t getGatedFrameCount() const;
+
+private:
+    int tileSize_;            // In frame pixels
+    int fullScanInterval_;
+    int differenceThreshold_;
+    float minChangedFraction_;
+    int framesSinceFullScan_;
+
+    cv::Mat small_;           // This frame, shrunk and grey
+    cv::Mat previousSmall_;
+    cv::Mat smallFloat_;
+    cv::Mat previousSmallFloat_;
+    cv::Mat hanning_;
+    cv::Mat warped_;
+    cv::Mat difference_;
+    cv::Mat mask_;
+    std::vector<uchar> activeTiles_;
+    std::vector<int> tileComponent_;
+    std::vector<int> stack_;
+
+    double scannedFraction_;  // Summed over frames
+    uint64_t frameCount_;
+    uint64_t fullScans_;
+    uint64_t gatedFrames_;
+
+    bool fullScan(std::vector<cv::Rect>& regions);
+    void mergeTiles(int columns, int rows, const cv::Size& frameSize, double scale,
+                    std::vector<cv::Rect>& regions);
+};
@@ -0,0 +1,56 @@
+#include "PlaybackClock.h"
+#include <algorithm>
+
+PlaybackClock::PlaybackClock()
+    : anchorWall_(Clock::now()), anchorMedia_(0.0), speed_(1.0), paused_(true) {
+}
+
+void PlaybackClock::start(double mediaSeconds) {
+    anchorWall_ = Clock::now();
+    anchorMedia_ = mediaSeconds;
+    paused_ = false;
+}
+
+void PlaybackClock::setSpeed(double speed) {
+    double media = getMediaTime();
+    anchorWall_ = Clock::now();
+    anchorMedia_ = media;
+    speed_ = std::max(speed, 0.01);
+}
+
+void PlaybackClock::pause() {
+    if (paused_) return;
+    anchorMedia_ = getMediaTime();
+    paused_ = true;
+}
+
+void PlaybackClock::resume() {
+    if (!paused_) return;
+    anchorWall_ = Clock::now();
+    paused_ = false;
+}
+
+bool PlaybackClock::isPaused() const {
+    return paused_;
+}
+
+double PlaybackClock::getSpeed() const {
+    return speed_;
+}
+
+double PlaybackClock::getMediaTime() const {
+    if (paused_) {
+        return anchorMedia_;
+    }
+    std::chrono::duration<double> elapsed = Clock::now() - anchorWall_;
+    return anchorMedia_ + elapsed.count() * speed_;
+}
+
+PlaybackClock::Clock::time_point PlaybackClock::deadlineFor(double mediaSeconds) const {
+    // A paused clock never reaches any deadline
+    if (paused_) {
+        return Clock::time_point::max();
+    }
+    std::chrono::duration<double> offset((mediaSeconds - anchorMedia_) / speed_);
+    return anchorWall_ + std::chrono::duration_cast<Clock::duration>(offset);
+}
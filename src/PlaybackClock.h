@@ -0,0 +1,33 @@
+#pragma once
+
+#include <chrono>
+
+// Maps source timestamps to wall-clock deadlines for playback at any speed.
+//
+// Deadlines are absolute: each frame is due at anchor + (pts - anchorPts) /
+// speed, so time spent processing or drawing never accumulates as drift.
+// Changing speed or pausing re-anchors at the current media time, so the
+// position never jumps. Not thread-safe.
+class PlaybackClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PlaybackClock();
+
+    // Media time mediaSeconds is "now"; clears pause
+    void start(double mediaSeconds);
+    void setSpeed(double speed);
+    void pause();
+    void resume();
+
+    bool isPaused() const;
+    double getSpeed() const;
+    double getMediaTime() const;
+    Clock::time_point deadlineFor(double mediaSeconds) const;
+
+private:
+    Clock::time_point anchorWall_;
+    double anchorMedia_;
+    double speed_;
+    bool paused_;
+};
@@ -0,0 +1,322 @@
+#include "SharedFrameRing.h"
+#include <algorithm>
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+std::string normalizeShmName(const std::string& name) {
+    // POSIX shm names must start with a single slash; Python's
+    // multiprocessing.shared_memory adds it implicitly.
+    return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void pollDelay() {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+}
+
+} // namespace
+
+SharedFrameRing::SharedFrameRing()
+    : fd_(-1), mapping_(nullptr), mappingSize_(0), isOwner_(false), header_(nullptr),
+      nextRead_(0), slotHeld_(false), heldSequence_(0), droppedFrames_(0) {
+}
+
+SharedFrameRing::~SharedFrameRing() {
+    close();
+}
+
+bool SharedFrameRing::create(const std::string& name, int width, int height, int channels,
+                             int slotCount, double fps, int64_t totalFrames) {
+#ifdef _WIN32
+    std::cerr << "Shared-memory frame ring is not supported on Windows" << std::endl;
+    return false;
+#else
+    close();
+    if (width <= 0 || height <= 0 || channels <= 0 || slotCount <= 0) {
+        std::cerr << "Error: Invalid shared frame ring geometry" << std::endl;
+        return false;
+    }
+
+    name_ = normalizeShmName(name);
+    fd_ = shm_open(name_.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd_ < 0) {
+        std::cerr << "Error: Could not create shared memory segment: " << name_ << std::endl;
+        return false;
+    }
+    isOwner_ = true;
+
+    size_t frameBytes = static_cast<size_t>(width) * height * channels;
+    size_t slotStride = alignUp(sizeof(SharedFrameSlotHeader) + frameBytes, kSlotAlignment);
+    size_t totalSize = kHeaderSize + slotStride * slotCount;
+
+    if (ftruncate(fd_, static_cast<off_t>(totalSize)) != 0 || !map(totalSize, true)) {
+        std::cerr << "Error: Could not size shared memory segment: " << name_ << std::endl;
+        close();
+        return false;
+    }
+
+    std::memset(mapping_, 0, totalSize);
+    header_->version = kSharedFrameRingVersion;
+    header_->slotCount = static_cast<uint32_t>(slotCount);
+    header_->width = static_cast<uint32_t>(width);
+    header_->height = static_cast<uint32_t>(height);
+    header_->channels = static_cast<uint32_t>(channels);
+    header_->slotStride = slotStride;
+    header_->fps = fps;
+    header_->totalFrames = totalFrames;
+
+    // Publish the magic last so a consumer never sees a half-built header
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->magic = kSharedFrameRingMagic;
+    return true;
+#endif
+}
+
+bool SharedFrameRing::open(const std::string& name, int timeoutMs) {
+#ifdef _WIN32
+    std::cerr << "Shared-memory frame ring is not supported on Windows" << std::endl;
+    return false;
+#else
+    close();
+    name_ = normalizeShmName(name);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    // The producer may still be setting the segment up; wait for it
+    while (true) {
+        if (fd_ < 0) {
+            fd_ = shm_open(name_.c_str(), O_RDWR, 0600);
+        }
+        if (fd_ >= 0) {
+            struct stat st;
+            if (fstat(fd_, &st) == 0 && static_cast<size_t>(st.st_size) >= kHeaderSize) {
+                if (!mapping_ && !map(static_cast<size_t>(st.st_size), true)) {
+                    close();
+                    return false;
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (header_->magic == kSharedFrameRingMagic) break;
+            }
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            std::cerr << "Error: Timed out waiting for shared frame ring: " << name_ << std::endl;
+            close();
+            return false;
+        }
+        pollDelay();
+    }
+
+    if (header_->version != kSharedFrameRingVersion) {
+        std::cerr << "Error: Shared frame ring version mismatch (got " << header_->version
+                  << ", expected " << kSharedFrameRingVersion << ")" << std::endl;
+        close();
+        return false;
+    }
+
+    size_t expectedSize = kHeaderSize + header_->slotStride * header_->slotCount;
+    if (mappingSize_ < expectedSize) {
+        std::cerr << "Error: Shared frame ring is truncated: " << name_ << std::endl;
+        close();
+        return false;
+    }
+
+    nextRead_ = header_->readIndex.load(std::memory_order_acquire);
+    return true;
+#endif
+}
+
+void SharedFrameRing::close() {
+#ifndef _WIN32
+    if (mapping_) {
+        munmap(mapping_, mappingSize_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    if (isOwner_ && !name_.empty()) {
+        shm_unlink(name_.c_str());
+    }
+#endif
+    fd_ = -1;
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    header_ = nullptr;
+    isOwner_ = false;
+    slotHeld_ = false;
+    nextRead_ = 0;
+}
+
+bool SharedFrameRing::map(size_t size, bool writable) {
+#ifdef _WIN32
+    return false;
+#else
+    int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+    void* addr = mmap(nullptr, size, prot, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "Error: Could not map shared memory segment: " << name_ << std::endl;
+        return false;
+    }
+    mapping_ = addr;
+    mappingSize_ = size;
+    header_ = static_cast<SharedFrameRingHeader*>(addr);
+    return true;
+#endif
+}
+
+SharedFrameSlotHeader* SharedFrameRing::slotHeader(uint64_t index) const {
+    uint8_t* base = static_cast<uint8_t*>(mapping_) + kHeaderSize;
+    return reinterpret_cast<SharedFrameSlotHeader*>(
+        base + (index % header_->slotCount) * header_->slotStride);
+}
+
+uint8_t* SharedFrameRing::slotData(uint64_t index) const {
+    return reinterpret_cast<uint8_t*>(slotHeader(index)) + sizeof(SharedFrameSlotHeader);
+}
+
+bool SharedFrameRing::write(const cv::Mat& frame, int64_t frameIndex, double timestampMs, bool blocking) {
+    if (!header_ || frame.empty()) return false;
+
+    uint64_t n = header_->writeIndex.load(std::memory_order_relaxed);
+    if (blocking) {
+        while (n - header_->readIndex.load(std::memory_order_acquire) >= header_->slotCount) {
+            pollDelay();
+        }
+    }
+
+    SharedFrameSlotHeader* slot = slotHeader(n);
+    slot->sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Resize straight into the slot so the producer needs no scratch frame
+    cv::Mat target(static_cast<int>(header_->height), static_cast<int>(header_->width),
+                   CV_8UC(static_cast<int>(header_->channels)), slotData(n));
+    if (frame.size() == target.size() && frame.type() == target.type()) {
+        frame.copyTo(target);
+    } else if (frame.type() == target.type()) {
+        cv::resize(frame, target, target.size(), 0, 0, cv::INTER_AREA);
+    } else {
+        std::cerr << "Error: Frame type does not match shared frame ring" << std::endl;
+        slot->sequence.store(2 * n, std::memory_order_release);
+        return false;
+    }
+
+    slot->frameIndex = frameIndex;
+    slot->timestampMs = timestampMs;
+    slot->sequence.store(2 * n + 2, std::memory_order_release);
+    header_->writeIndex.store(n + 1, std::memory_order_release);
+    return true;
+}
+
+void SharedFrameRing::markDone() {
+    if (header_) {
+        header_->producerDone.store(1, std::memory_order_release);
+    }
+}
+
+bool SharedFrameRing::acquire(cv::Mat& frame, int64_t& frameIndex, double& timestampMs, int timeoutMs) {
+    if (!header_) return false;
+    if (slotHeld_) release();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    const uint64_t slotCount = header_->slotCount;
+
+    while (true) {
+        uint64_t written = header_->writeIndex.load(std::memory_order_acquire);
+        if (nextRead_ < written) {
+            // A non-blocking producer may have lapped us; skip to the oldest live slot
+            if (written - nextRead_ > slotCount) {
+                droppedFrames_ += written - slotCount - nextRead_;
+                nextRead_ = written - slotCount;
+            }
+
+            uint64_t expected = 2 * nextRead_ + 2;
+            uint64_t sequence = slotHeader(nextRead_)->sequence.load(std::memory_order_acquire);
+            if (sequence == expected) {
+                SharedFrameSlotHeader* slot = slotHeader(nextRead_);
+                frame = cv::Mat(static_cast<int>(header_->height), static_cast<int>(header_->width),
+                                CV_8UC(static_cast<int>(header_->channels)), slotData(nextRead_));
+                frameIndex = slot->frameIndex;
+                timestampMs = slot->timestampMs;
+                heldSequence_ = sequence;
+                slotHeld_ = true;
+                return true;
+            }
+            if (sequence > expected) {
+                // Overwritten before we got to it
+                droppedFrames_++;
+                nextRead_++;
+                header_->readIndex.store(nextRead_, std::memory_order_release);
+                continue;
+            }
+            // Producer is mid-write on this slot; fall through and wait
+        } else if (header_->producerDone.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        pollDelay();
+    }
+}
+
+bool SharedFrameRing::release() {
+    if (!header_ || !slotHeld_) return true;
+
+    // Seqlock read side: all pixel reads happen-before this re-check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    bool intact = slotHeader(nextRead_)->sequence.load(std::memory_order_relaxed) == heldSequence_;
+
+    slotHeld_ = false;
+    nextRead_++;
+    header_->readIndex.store(nextRead_, std::memory_order_release);
+
+    if (!intact) {
+        droppedFrames_++;
+    }
+    return intact;
+}
+
+bool SharedFrameRing::isOpen() const {
+    return header_ != nullptr;
+}
+
+int SharedFrameRing::getWidth() const {
+    return header_ ? static_cast<int>(header_->width) : 0;
+}
+
+int SharedFrameRing::getHeight() const {
+    return header_ ? static_cast<int>(header_->height) : 0;
+}
+
+double SharedFrameRing::getFPS() const {
+    return header_ ? header_->fps : 0.0;
+}
+
+int64_t SharedFrameRing::getTotalFrames() const {
+    return header_ ? header_->totalFrames : 0;
+}
+
+uint64_t SharedFrameRing::getDroppedFrames() const {
+    return droppedFrames_;
+}
+
+uint64_t SharedFrameRing::getBacklog() const {
+    if (!header_) return 0;
+    uint64_t written = header_->writeIndex.load(std::memory_order_acquire);
+    uint64_t backlog = written > nextRead_ ? written - nextRead_ : 0;
+    return std::min<uint64_t>(backlog, header_->slotCount);
+}
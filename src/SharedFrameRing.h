@@ -0,0 +1,102 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Layout of the shared-memory frame ring. The same offsets are mirrored in
+// backend/shm_ring.py, so any change here must bump kSharedFrameRingVersion.
+//
+//   [RingHeader][slot 0][slot 1]...[slot N-1]
+//   slot = [SlotHeader][width * height * channels bytes of BGR pixels]
+//
+// Each slot is guarded by a seqlock: the producer makes the sequence odd
+// while writing frame n and publishes it as 2n + 2 when done. The consumer
+// reads pixels in place and re-checks the sequence when it releases the
+// slot, so a frame overwritten mid-use is detected instead of silently
+// tracked on torn data.
+constexpr uint32_t kSharedFrameRingMagic = 0x52544343; // "CCTR"
+constexpr uint32_t kSharedFrameRingVersion = 1;
+
+struct SharedFrameRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;
+    uint64_t slotStride;               // Bytes per slot, including SlotHeader
+    double fps;
+    int64_t totalFrames;               // 0 when unknown (live sources)
+    std::atomic<uint64_t> writeIndex;  // Frames published by the producer
+    std::atomic<uint64_t> readIndex;   // Frames released by the consumer
+    std::atomic<uint32_t> producerDone;
+    uint32_t reserved;
+};
+
+struct SharedFrameSlotHeader {
+    std::atomic<uint64_t> sequence;
+    int64_t frameIndex;
+    double timestampMs;
+    uint64_t reserved;
+};
+
+static_assert(offsetof(SharedFrameRingHeader, writeIndex) == 48, "ring header layout changed");
+static_assert(offsetof(SharedFrameRingHeader, producerDone) == 64, "ring header layout changed");
+static_assert(sizeof(SharedFrameSlotHeader) == 32, "slot header layout changed");
+
+class SharedFrameRing {
+public:
+    static constexpr size_t kHeaderSize = 128;
+    static constexpr size_t kSlotAlignment = 64;
+
+    SharedFrameRing();
+    ~SharedFrameRing();
+
+    // Producer side: creates (or truncates) the named segment.
+    bool create(const std::string& name, int width, int height, int channels,
+                int slotCount, double fps = 30.0, int64_t totalFrames = 0);
+    // Consumer side: attaches to a segment created by a producer.
+    bool open(const std::string& name, int timeoutMs = 5000);
+    void close();
+
+    // Producer API. Blocks while the ring is full so a file-backed producer
+    // never laps the consumer; live producers can pass blocking = false and
+    // overwrite the oldest slot instead.
+    bool write(const cv::Mat& frame, int64_t frameIndex, double timestampMs, bool blocking = true);
+    void markDone();
+
+    // Consumer API. acquire() returns a Mat header that points directly into
+    // the shared segment; it stays valid until release(). release() returns
+    // false if the producer overwrote the slot while it was in use.
+    bool acquire(cv::Mat& frame, int64_t& frameIndex, double& timestampMs, int timeoutMs = 5000);
+    bool release();
+
+    bool isOpen() const;
+    int getWidth() const;
+    int getHeight() const;
+    double getFPS() const;
+    int64_t getTotalFrames() const;
+    uint64_t getDroppedFrames() const;
+    // Consumer side: frames published but not yet acquired
+    uint64_t getBacklog() const;
+
+private:
+    std::string name_;
+    int fd_;
+    void* mapping_;
+    size_t mappingSize_;
+    bool isOwner_;
+    SharedFrameRingHeader* header_;
+
+    uint64_t nextRead_;
+    bool slotHeld_;
+    uint64_t heldSequence_;
+    uint64_t droppedFrames_;
+
+    SharedFrameSlotHeader* slotHeader(uint64_t index) const;
+    uint8_t* slotData(uint64_t index) const;
+    bool map(size_t size, bool writable);
+};
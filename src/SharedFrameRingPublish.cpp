@@ -0,0 +1,29 @@
+#include <atomic>
+#include <cstdint>
+
+// Ordered stores for producers outside C++ (backend/shm_ring.py loads this
+// library through ctypes). Python's own buffer stores carry no ordering, so
+// on weakly ordered CPUs the pixels could land after the sequence that
+// publishes them; these give the Python writer the same fences as
+// SharedFrameRing::write. Addresses point at the fields laid out in
+// SharedFrameRing.h.
+
+extern "C" {
+
+// Marks a slot as being written: the odd sequence becomes visible before
+// any of the pixel stores that follow
+void cct_ring_begin_slot(void* sequence, uint64_t value) {
+    static_cast<std::atomic<uint64_t>*>(sequence)->store(value, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+// Publishes a sequence or index after everything written before it
+void cct_ring_publish_u64(void* address, uint64_t value) {
+    static_cast<std::atomic<uint64_t>*>(address)->store(value, std::memory_order_release);
+}
+
+void cct_ring_publish_u32(void* address, uint32_t value) {
+    static_cast<std::atomic<uint32_t>*>(address)->store(value, std::memory_order_release);
+}
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Handle to a SlotMap element. The generation tells a handle to an erased
+// element apart from a newer element that reused its slot.
+struct SlotHandle {
+    uint32_t index;
+    uint32_t generation;
+
+    SlotHandle() : index(UINT32_MAX), generation(0) {}
+    SlotHandle(uint32_t slotIndex, uint32_t slotGeneration)
+        : index(slotIndex), generation(slotGeneration) {}
+};
+
+// Table with O(1) insert, lookup and erase through stable handles. Values
+// live densely packed, so iteration touches only live elements and a view
+// over data()..data() + size() stays cheap. Erasing moves the last value
+// into the hole: iteration order is not insertion order, and pointers into
+// the table are invalidated by insert and erase (handles are not).
+template <typename T>
+class SlotMap {
+public:
+    using iterator = typename std::vector<T>::iterator;
+    using const_iterator = typename std::vector<T>::const_iterator;
+
+    SlotHandle insert(T value) {
+        uint32_t index;
+        if (!freeSlots_.empty()) {
+            index = freeSlots_.back();
+            freeSlots_.pop_back();
+        } else {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.push_back(Slot());
+        }
+        slots_[index].dense = static_cast<uint32_t>(values_.size());
+        values_.push_back(std::move(value));
+        denseToSlot_.push_back(index);
+        return SlotHandle(index, slots_[index].generation);
+    }
+
+    // Null when the element was erased
+    T* get(SlotHandle handle) {
+        return contains(handle) ? &values_[slots_[handle.index].dense] : nullptr;
+    }
+    const T* get(SlotHandle handle) const {
+        return contains(handle) ? &values_[slots_[handle.index].dense] : nullptr;
+    }
+    bool contains(SlotHandle handle) const {
+        return handle.index < slots_.size() && slots_[handle.index].generation == handle.generation &&
+               slots_[handle.index].dense != kFree;
+    }
+
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) return false;
+        uint32_t dense = slots_[handle.index].dense;
+        uint32_t last = static_cast<uint32_t>(values_.size() - 1);
+        if (dense != last) {
+            values_[dense] = std::move(values_[last]);
+            denseToSlot_[dense] = denseToSlot_[last];
+            slots_[denseToSlot_[dense]].dense = dense;
+        }
+        values_.pop_back();
+        denseToSlot_.pop_back();
+
+        Slot& slot = slots_[handle.index];
+        slot.dense = kFree;
+        ++slot.generation;
+        freeSlots_.push_back(handle.index);
+        return true;
+    }
+
+    void clear() {
+        for (uint32_t index : denseToSlot_) {
+            slots_[index].dense = kFree;
+            ++slots_[index].generation;
+            freeSlots_.push_back(index);
+        }
+        values_.clear();
+        denseToSlot_.clear();
+    }
+
+    size_t size() const { return values_.size(); }
+    bool empty() const { return values_.empty(); }
+    T* data() { return values_.data(); }
+    const T* data() const { return values_.data(); }
+    iterator begin() { return values_.begin(); }
+    iterator end() { return values_.end(); }
+    const_iterator begin() const { return values_.begin(); }
+    const_iterator end() const { return values_.end(); }
+    // Live values in table order
+    const std::vector<T>& values() const { return values_; }
+
+private:
+    static constexpr uint32_t kFree = UINT32_MAX;
+
+    struct Slot {
+        uint32_t dense;
+        uint32_t generation;
+
+        Slot() : dense(kFree), generation(0) {}
+    };
+
+    std::vector<T> values_;
+    std::vector<uint32_t> denseToSlot_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> freeSlots_;
+};
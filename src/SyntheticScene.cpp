@@ -0,0 +1,197 @@
+#include "SyntheticScene.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+constexpr int kRoadSpacing = 320;   // World pixels between parallel roads
+constexpr int kRoadWidth = 64;
+constexpr float kLaneOffset = 16.0f;
+
+float wrap(float value, float range) {
+    float wrapped = std::fmod(value, range);
+    return wrapped < 0.0f ? wrapped + range : wrapped;
+}
+
+// Bounces between lo and hi, as a camera drifting back and forth
+float reflect(float value, float lo, float hi) {
+    float range = hi - lo;
+    if (range <= 0.0f) return lo;
+    float folded = wrap(value - lo, 2.0f * range);
+    return lo + (folded > range ? 2.0f * range - folded : folded);
+}
+
+int roadCenter(int index) {
+    return kRoadSpacing / 2 + index * kRoadSpacing;
+}
+
+} // namespace
+
+SyntheticScene::SyntheticScene(const SyntheticSceneConfig& config)
+    : config_(config) {
+    config_.zoomAmplitude = std::max(0.0f, std::min(0.5f, config_.zoomAmplitude));
+    config_.zoomPeriod = std::max(1, config_.zoomPeriod);
+    worldSize_ = cv::Size(config_.width * 3, config_.height * 3);
+
+    cv::RNG rng(config_.seed);
+    buildWorld(rng);
+
+    int horizontalRoads = worldSize_.height / kRoadSpacing;
+    int verticalRoads = worldSize_.width / kRoadSpacing;
+
+    for (int i = 0; i < config_.vehicleCount; ++i) {
+        Vehicle vehicle;
+        vehicle.horizontal = rng.uniform(0, 2) == 0;
+        int road = vehicle.horizontal ? rng.uniform(0, horizontalRoads) : rng.uniform(0, verticalRoads);
+        float direction = rng.uniform(0, 2) == 0 ? 1.0f : -1.0f;
+        vehicle.speed = direction * rng.uniform(config_.minSpeed, std::max(config_.minSpeed, config_.maxSpeed) + 1e-3f);
+        // Right-hand traffic: the lane depends on the direction of travel
+        vehicle.road = roadCenter(road) + direction * kLaneOffset * (vehicle.horizontal ? 1.0f : -1.0f);
+        vehicle.start = rng.uniform(0.0f, static_cast<float>(vehicle.horizontal ? worldSize_.width : worldSize_.height));
+
+        int length = rng.uniform(36, 57);
+        int breadth = rng.uniform(18, 25);
+        vehicle.size = vehicle.horizontal ? cv::Size(length, breadth) : cv::Size(breadth, length);
+        vehicle.color = cv::Scalar(rng.uniform(40, 256), rng.uniform(40, 256), rng.uniform(40, 256));
+        vehicles_.push_back(vehicle);
+    }
+
+    for (int i = 0; i < config_.occluderCount; ++i) {
+        // Centred on a road so they actually hide traffic
+        int size = rng.uniform(90, 181);
+        bool horizontal = rng.uniform(0, 2) == 0;
+        int along = rng.uniform(0, horizontal ? worldSize_.width : worldSize_.height);
+        int across = roadCenter(rng.uniform(0, std::max(1, horizontal ? horizontalRoads : verticalRoads)));
+        cv::Point center = horizontal ? cv::Point(along, across) : cv::Point(across, along);
+        occluders_.push_back(cv::Rect(center.x - size / 2, center.y - size / 2, size, size));
+        occluderColors_.push_back(cv::Scalar(rng.uniform(20, 60), rng.uniform(80, 140), rng.uniform(20, 60)));
+    }
+}
+
+const SyntheticSceneConfig& SyntheticScene::getConfig() const {
+    return config_;
+}
+
+void SyntheticScene::buildWorld(cv::RNG& rng) {
+    world_.create(worldSize_, CV_8UC3);
+    rng.fill(world_, cv::RNG::UNIFORM, cv::Scalar(40, 70, 50), cv::Scalar(90, 120, 100));
+    cv::GaussianBlur(world_, world_, cv::Size(0, 0), 2.0);
+
+    const cv::Scalar asphalt(70, 70, 70);
+    const cv::Scalar marking(220, 220, 220);
+    for (int y = roadCenter(0); y < worldSize_.height; y += kRoadSpacing) {
+        cv::rectangle(world_, cv::Rect(0, y - kRoadWidth / 2, worldSize_.width, kRoadWidth), asphalt, cv::FILLED);
+    }
+    for (int x = roadCenter(0); x < worldSize_.width; x += kRoadSpacing) {
+        cv::rectangle(world_, cv::Rect(x - kRoadWidth / 2, 0, kRoadWidth, worldSize_.height), asphalt, cv::FILLED);
+    }
+    // Dashed centre lines
+    for (int y = roadCenter(0); y < worldSize_.height; y += kRoadSpacing) {
+        for (int x = 0; x < worldSize_.width; x += 40) {
+            cv::line(world_, cv::Point(x, y), cv::Point(x + 20, y), marking, 2);
+        }
+    }
+    for (int x = roadCenter(0); x < worldSize_.width; x += kRoadSpacing) {
+        for (int y = 0; y < worldSize_.height; y += 40) {
+            cv::line(world_, cv::Point(x, y), cv::Point(x, y + 20), marking, 2);
+        }
+    }
+}
+
+cv::Point2f SyntheticScene::cameraCenter(int index) const {
+    // Keep the view inside the world even fully zoomed out
+    float x = worldSize_.width / 2.0f + config_.panVelocity.x * index;
+    float y = worldSize_.height / 2.0f + config_.panVelocity.y * index;
+    return cv::Point2f(reflect(x, config_.width, worldSize_.width - config_.width),
+                       reflect(y, config_.height, worldSize_.height - config_.height));
+}
+
+float SyntheticScene::cameraScale(int index) const {
+    return 1.0f + config_.zoomAmplitude *
+        static_cast<float>(std::sin(2.0 * CV_PI * index / config_.zoomPeriod));
+}
+
+cv::Rect2f SyntheticScene::vehicleBox(const Vehicle& vehicle, int index) const {
+    float range = static_cast<float>(vehicle.horizontal ? worldSize_.width : worldSize_.height);
+    float along = wrap(vehicle.start + vehicle.speed * index, range);
+    if (vehicle.horizontal) {
+        return cv::Rect2f(along - vehicle.size.width / 2.0f, vehicle.road - vehicle.size.height / 2.0f,
+                          static_cast<float>(vehicle.size.width), static_cast<float>(vehicle.size.height));
+    }
+    return cv::Rect2f(vehicle.road - vehicle.size.width / 2.0f, along - vehicle.size.height / 2.0f,
+                      static_cast<float>(vehicle.size.width), static_cast<float>(vehicle.size.height));
+}
+
+void SyntheticScene::renderFrame(int index, cv::Mat& frame, FrameBoxes& groundTruth,
+                                 std::vector<float>& visibility) const {
+    groundTruth.clear();
+    visibility.clear();
+
+    // World region in view, snapped to whole pixels
+    float scale = cameraScale(index);
+    cv::Point2f center = cameraCenter(index);
+    cv::Size viewSize(config_.width, config_.height);
+    cv::Rect roi(static_cast<int>(center.x - viewSize.width / (2.0f * scale)),
+                 static_cast<int>(center.y - viewSize.height / (2.0f * scale)),
+                 static_cast<int>(std::ceil(viewSize.width / scale)),
+                 static_cast<int>(std::ceil(viewSize.height / scale)));
+    roi &= cv::Rect(0, 0, worldSize_.width, worldSize_.height);
+    cv::resize(world_(roi), frame, viewSize, 0, 0, cv::INTER_LINEAR);
+
+    float sx = static_cast<float>(viewSize.width) / roi.width;
+    float sy = static_cast<float>(viewSize.height) / roi.height;
+    auto toView = [&](const cv::Rect2f& box) {
+        return cv::Rect(cvRound((box.x - roi.x) * sx), cvRound((box.y - roi.y) * sy),
+                        cvRound(box.width * sx), cvRound(box.height * sy));
+    };
+    const cv::Rect viewRect(0, 0, viewSize.width, viewSize.height);
+
+    std::vector<cv::Rect> occluders;
+    occluders.reserve(occluders_.size());
+    for (const auto& occluder : occluders_) {
+        occluders.push_back(toView(cv::Rect2f(occluder)));
+    }
+
+    for (size_t i = 0; i < vehicles_.size(); ++i) {
+        const Vehicle& vehicle = vehicles_[i];
+        cv::Rect box = toView(vehicleBox(vehicle, index));
+        cv::Rect visible = box & viewRect;
+        if (visible.area() <= 0) continue;
+
+        cv::rectangle(frame, box, vehicle.color, cv::FILLED);
+        // Dark windscreen at the front so orientation and motion are visible
+        bool forward = vehicle.speed > 0;
+        cv::Rect windscreen = vehicle.horizontal
+            ? cv::Rect(forward ? box.x + box.width * 3 / 5 : box.x + box.width / 5, box.y + 2,
+                       box.width / 5, std::max(1, box.height - 4))
+            : cv::Rect(box.x + 2, forward ? box.y + box.height * 3 / 5 : box.y + box.height / 5,
+                       std::max(1, box.width - 4), box.height / 5);
+        cv::rectangle(frame, windscreen, cv::Scalar(30, 30, 30), cv::FILLED);
+
+        int covered = 0;
+        for (const auto& occluder : occluders) {
+            covered += (visible & occluder).area();
+        }
+        float fraction = static_cast<float>(std::max(0, visible.area() - covered)) / std::max(1, box.area());
+
+        groundTruth.emplace_back(static_cast<int>(i) + 1, visible);
+        visibility.push_back(std::min(1.0f, fraction));
+    }
+
+    for (size_t i = 0; i < occluders.size(); ++i) {
+        cv::rectangle(frame, occluders[i], occluderColors_[i], cv::FILLED);
+        cv::rectangle(frame, occluders[i], occluderColors_[i] * 0.6, 2);
+    }
+}
+
+void SyntheticScene::writeGroundTruthRows(FILE* file, int index, const FrameBoxes& groundTruth,
+                                          const std::vector<float>& visibility) {
+    for (size_t i = 0; i < groundTruth.size(); ++i) {
+        const cv::Rect& box = groundTruth[i].second;
+        int consider = visibility[i] >= kMinVisibleFraction ? 1 : 0;
+        // MOT17 class 3 is "car"
+        std::fprintf(file, "%d,%d,%d,%d,%d,%d,%d,3,%.3f\n", index + 1, groundTruth[i].first,
+                     box.x, box.y, box.width, box.height, consider, visibility[i]);
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "TrackingMetrics.h"
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+struct SyntheticSceneConfig {
+    int width;
+    int height;
+    int frameCount;
+    double fps;
+    int vehicleCount;
+    float minSpeed;          // World pixels per frame
+    float maxSpeed;
+    int occluderCount;       // Overpasses/tree canopies drawn over the traffic
+    cv::Point2f panVelocity; // Camera drift, world pixels per frame
+    float zoomAmplitude;     // 0.2 = zoom oscillates between 0.8x and 1.2x
+    int zoomPeriod;          // Frames per zoom cycle
+    unsigned seed;
+
+    SyntheticSceneConfig()
+        : width(1280), height(720), frameCount(300), fps(30.0), vehicleCount(20),
+          minSpeed(2.0f), maxSpeed(8.0f), occluderCount(6), panVelocity(1.5f, 0.5f),
+          zoomAmplitude(0.1f), zoomPeriod(240), seed(1) {}
+};
+
+// Deterministic top-down traffic scene standing in for aerial chase footage.
+//
+// Vehicles drive along a road grid in a world three times the size of the
+// view; the camera pans across it and zooms in and out. Everything is a
+// closed-form function of the frame index, so any frame can be rendered
+// directly and the same config always produces the same pixels.
+class SyntheticScene {
+public:
+    // A vehicle is left out of the ground truth (consider flag 0) when less
+    // than this fraction of it is visible
+    static constexpr float kMinVisibleFraction = 0.1f;
+
+    explicit SyntheticScene(const SyntheticSceneConfig& config);
+
+    const SyntheticSceneConfig& getConfig() const;
+
+    // Renders one frame; groundTruth receives (vehicle id, box) for every
+    // vehicle at least partly in view, visibility the matching fractions
+    void renderFrame(int index, cv::Mat& frame, FrameBoxes& groundTruth,
+                     std::vector<float>& visibility) const;
+
+    // One MOTChallenge ground-truth row per box; frame numbers are 1-based
+    static void writeGroundTruthRows(FILE* file, int index, const FrameBoxes& groundTruth,
+                                     const std::vector<float>& visibility);
+
+private:
+    struct Vehicle {
+        bool horizontal;     // Drives along a horizontal road
+        float road;          // Lane centre across the direction of travel
+        float start;         // Position along the road at frame 0
+        float speed;         // Signed, world pixels per frame
+        cv::Size size;
+        cv::Scalar color;
+    };
+
+    SyntheticSceneConfig config_;
+    cv::Size worldSize_;
+    cv::Mat world_;          // Background: ground texture plus roads
+    std::vector<Vehicle> vehicles_;
+    std::vector<cv::Rect> occluders_;
+    std::vector<cv::Scalar> occluderColors_;
+
+    void buildWorld(cv::RNG& rng);
+    cv::Point2f cameraCenter(int index) const;
+    float cameraScale(int index) const;
+    cv::Rect2f vehicleBox(const Vehicle& vehicle, int index) const;
+};
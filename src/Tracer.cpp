@@ -0,0 +1,198 @@
+#include "Tracer.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    int64_t startNs;      // Since the trace started
+    uint64_t durationNs;
+    int frame;
+};
+
+// Written only by its owning thread; read by stop() once recording is off
+struct ThreadBuffer {
+    int tid;
+    std::string name;
+    std::vector<TraceEvent> events;
+    std::atomic<uint64_t> written;
+};
+
+struct TraceSession {
+    std::mutex mutex;
+    std::string path;
+    size_t eventsPerThread;
+    std::chrono::steady_clock::time_point origin;  // Set before recording is enabled
+    std::atomic<uint64_t> generation;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+};
+
+TraceSession& session() {
+    static TraceSession instance;
+    return instance;
+}
+
+// Buffers are re-registered when a new trace starts
+thread_local std::shared_ptr<ThreadBuffer> threadBuffer;
+thread_local uint64_t threadGeneration = 0;
+thread_local std::string threadName;
+thread_local int threadFrame = -1;
+
+ThreadBuffer* currentBuffer() {
+    TraceSession& trace = session();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    if (!threadBuffer || threadGeneration != trace.generation.load(std::memory_order_relaxed)) {
+        threadBuffer = std::make_shared<ThreadBuffer>();
+        threadBuffer->tid = static_cast<int>(trace.buffers.size()) + 1;
+        threadBuffer->name = threadName.empty() ? "thread " + std::to_string(threadBuffer->tid) : threadName;
+        threadBuffer->events.resize(trace.eventsPerThread);
+        threadBuffer->written.store(0, std::memory_order_relaxed);
+        threadGeneration = trace.generation.load(std::memory_order_relaxed);
+        trace.buffers.push_back(threadBuffer);
+    }
+    return threadBuffer.get();
+}
+
+void writeEscaped(FILE* file, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') std::fputc('\\', file);
+        if (static_cast<unsigned char>(c) >= 0x20) std::fputc(c, file);
+    }
+}
+
+} // namespace
+
+std::atomic<bool> Tracer::enabled_(false);
+
+bool Tracer::start(const std::string& path, size_t eventsPerThread) {
+    if (isEnabled()) {
+        stop();
+    }
+
+    TraceSession& trace = session();
+    {
+        std::lock_guard<std::mutex> lock(trace.mutex);
+        trace.path = path;
+        trace.eventsPerThread = std::max<size_t>(1, eventsPerThread);
+        trace.origin = std::chrono::steady_clock::now();
+        trace.generation.fetch_add(1, std::memory_order_relaxed);
+        trace.buffers.clear();
+    }
+
+    // Fail early rather than after a long run
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "Error: Could not open trace file: " << path << std::endl;
+        return false;
+    }
+    std::fclose(file);
+
+    enabled_.store(true, std::memory_order_release);
+    std::cout << "Tracing to: " << path << std::endl;
+    return true;
+}
+
+bool Tracer::stop() {
+    if (!enabled_.exchange(false, std::memory_order_acq_rel)) {
+        return false;
+    }
+
+    TraceSession& trace = session();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+
+    FILE* file = std::fopen(trace.path.c_str(), "w");
+    if (!file) {
+        std::cerr << "Error: Could not write trace file: " << trace.path << std::endl;
+        return false;
+    }
+
+#ifndef _WIN32
+    int pid = static_cast<int>(getpid());
+#else
+    int pid = 1;
+#endif
+
+    uint64_t recorded = 0;
+    uint64_t dropped = 0;
+    bool first = true;
+    std::fprintf(file, "{\"traceEvents\":[\n");
+    for (const auto& buffer : trace.buffers) {
+        std::fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"",
+                     first ? "" : ",\n", pid, buffer->tid);
+        writeEscaped(file, buffer->name);
+        std::fprintf(file, "\"}}");
+        first = false;
+
+        // Oldest surviving event first. A thread that saw tracing on just
+        // before it stopped may still be writing the slot after the last
+        // published event; once the ring has wrapped, that slot holds the
+        // oldest event, so it is dropped rather than read mid-write.
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t capacity = buffer->events.size();
+        uint64_t begin = written >= capacity ? written - capacity + 1 : 0;
+        dropped += begin;
+        for (uint64_t i = begin; i < written; ++i) {
+            const TraceEvent& event = buffer->events[i % capacity];
+            std::fprintf(file, ",\n{\"name\":\"");
+            writeEscaped(file, event.name);
+            std::fprintf(file, "\",\"cat\":\"pipeline\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d",
+                         event.startNs / 1000.0, event.durationNs / 1000.0, pid, buffer->tid);
+            if (event.frame >= 0) {
+                std::fprintf(file, ",\"args\":{\"frame\":%d}", event.frame);
+            }
+            std::fprintf(file, "}");
+        }
+        recorded += written - begin;
+    }
+    std::fprintf(file, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":%llu}}\n",
+                 static_cast<unsigned long long>(dropped));
+    bool ok = std::fclose(file) == 0;
+
+    std::cout << "Trace written to " << trace.path << ": " << recorded << " events from "
+              << trace.buffers.size() << " threads";
+    if (dropped > 0) {
+        std::cout << " (" << dropped << " oldest events dropped)";
+    }
+    std::cout << std::endl;
+
+    trace.buffers.clear();
+    return ok;
+}
+
+void Tracer::setThreadName(const std::string& name) {
+    threadName = name;
+    if (threadBuffer) {
+        std::lock_guard<std::mutex> lock(session().mutex);
+        threadBuffer->name = name;
+    }
+}
+
+void Tracer::setFrame(int frameIndex) {
+    threadFrame = frameIndex;
+}
+
+void Tracer::recordComplete(const char* name, std::chrono::steady_clock::time_point start,
+                            uint64_t durationNs) {
+    // Acquire pairs with start(), publishing the session origin and generation
+    if (!enabled_.load(std::memory_order_acquire)) return;
+
+    TraceSession& trace = session();
+    ThreadBuffer* buffer = threadBuffer && threadGeneration == trace.generation.load(std::memory_order_relaxed)
+        ? threadBuffer.get() : currentBuffer();
+    uint64_t index = buffer->written.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer->events[index % buffer->events.size()];
+    event.name = name;
+    event.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start - trace.origin).count();
+    event.durationNs = durationNs;
+    event.frame = threadFrame;
+    buffer->written.store(index + 1, std::memory_order_release);
+}
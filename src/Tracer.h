@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Opt-in timeline tracing in Chrome Trace Event format (chrome://tracing,
+// ui.perfetto.dev).
+//
+// Each thread records complete ("X") events into its own fixed-size ring
+// buffer, so recording takes no locks; when a ring wraps, the oldest events
+// are dropped. Events carry the thread and the frame the thread is working
+// on. Everything is written out by stop(). While tracing is off, a scope
+// costs one relaxed atomic load.
+class Tracer {
+public:
+    static constexpr size_t kDefaultEventsPerThread = 1 << 16;
+
+    // Starts recording; events are written to path on stop()
+    static bool start(const std::string& path, size_t eventsPerThread = kDefaultEventsPerThread);
+    // Stops recording and writes the trace. Threads still inside a traced
+    // scope may lose their last event, and a wrapped ring its oldest.
+    static bool stop();
+
+    static bool isEnabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Labels the calling thread in the timeline
+    static void setThreadName(const std::string& name);
+    // Frame attached to the calling thread's subsequent events; -1 for none
+    static void setFrame(int frameIndex);
+
+    // name must outlive the trace (string literals)
+    static void recordComplete(const char* name, std::chrono::steady_clock::time_point start,
+                               uint64_t durationNs);
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+// Records the enclosing scope as one event when tracing is on
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : name_(name), enabled_(Tracer::isEnabled()) {
+        if (enabled_) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~TraceScope() {
+        if (enabled_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            Tracer::recordComplete(name_, start_, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+private:
+    const char* name_;
+    bool enabled_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope_, __LINE__)(name)
@@ -0,0 +1,289 @@
+#include "TrackExporter.h"
+#include "Tracer.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+// At most two buffers queued for the writer before the producer blocks
+constexpr size_t kMaxPendingBuffers = 2;
+
+char* appendInt(char* out, char* end, long value) {
+    return std::to_chars(out, end, value).ptr;
+}
+
+// Fixed-point float formatting; avoids locale-aware iostreams and
+// std::to_chars(float), which is missing from older standard libraries
+char* appendFixed(char* out, char* end, float value, int decimals) {
+    static const long kScale[] = {1, 10, 100, 1000, 10000};
+    if (!std::isfinite(value)) {
+        *out++ = '0';
+        return out;
+    }
+    // Clamped so the scaled value fits a long and the row its fixed buffer;
+    // only a diverged filter gets anywhere near this
+    constexpr double kMaxMagnitude = 1e9;
+    double magnitude = std::min(std::fabs(static_cast<double>(value)), kMaxMagnitude);
+    // The product is exact in double, so rounding it to nearest-even
+    // matches printf; a value that rounds to zero loses its sign
+    long scaled = std::lrint(magnitude * kScale[decimals]);
+    if (value < 0.0f && scaled != 0) {
+        *out++ = '-';
+    }
+    out = appendInt(out, end, scaled / kScale[decimals]);
+    if (decimals > 0) {
+        *out++ = '.';
+        long frac = scaled % kScale[decimals];
+        for (int d = decimals - 1; d >= 0; --d) {
+            out[d] = static_cast<char>('0' + frac % 10);
+            frac /= 10;
+        }
+        out += decimals;
+    }
+    return out;
+}
+
+char* appendText(char* out, const char* text, size_t length) {
+    for (size_t i = 0; i < length; ++i) *out++ = text[i];
+    return out;
+}
+
+} // namespace
+
+TrackExporter::TrackExporter()
+    : file_(nullptr), format_(ExportFormat::MOTChallenge),
+      bufferBytes_(kDefaultBufferBytes), pendingCount_(0), stopping_(false) {
+}
+
+TrackExporter::~TrackExporter() {
+    close();
+}
+
+bool TrackExporter::open(const std::string& path, ExportFormat format, size_t bufferBytes) {
+    close();
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Error: Could not open export file: " << path << std::endl;
+        return false;
+    }
+    start(format, bufferBytes, true);
+    return true;
+}
+
+bool TrackExporter::openForResume(const std::string& path, ExportFormat format, int lastFrame,
+                                  size_t bufferBytes) {
+    close();
+
+    // Rows are in frame order and start with the frame number; the CSV
+    // header doesn't parse as one and is kept. A row cut off by the crash
+    // has no newline and is dropped.
+    long keepBytes = 0;
+    if (FILE* existing = std::fopen(path.c_str(), "rb")) {
+        char line[512];
+        while (std::fgets(line, sizeof(line), existing)) {
+            size_t length = std::strlen(line);
+            if (line[length - 1] != '\n') break;
+            char* end = nullptr;
+            long frame = std::strtol(line, &end, 10);
+            if (end != line && frame > lastFrame) break;
+            keepBytes = std::ftell(existing);
+        }
+        std::fclose(existing);
+    }
+    if (keepBytes == 0) {
+        return open(path, format, bufferBytes);
+    }
+
+#ifndef _WIN32
+    if (truncate(path.c_str(), keepBytes) != 0) {
+        std::cerr << "Error: Could not trim export file: " << path << std::endl;
+        return false;
+    }
+#endif
+    file_ = std::fopen(path.c_str(), "ab");
+    if (!file_) {
+        std::cerr << "Error: Could not open export file: " << path << std::endl;
+        return false;
+    }
+    start(format, bufferBytes, false);
+    return true;
+}
+
+void TrackExporter::start(ExportFormat format, size_t bufferBytes, bool writeHeader) {
+    // Buffers are already large; skip stdio's own copy
+    std::setvbuf(file_, nullptr, _IONBF, 0);
+
+    format_ = format;
+    bufferBytes_ = std::max<size_t>(bufferBytes, 4096);
+    active_.clear();
+    active_.reserve(bufferBytes_ + 512);
+
+    if (writeHeader && format_ == ExportFormat::CSV) {
+        active_ += "frame,id,label,x,y,width,height,vx,vy,confidence,visibility,occluded,primary\n";
+    }
+
+    stopping_ = false;
+    writerThread_ = std::thread(&TrackExporter::writerLoop, this);
+}
+
+void TrackExporter::close() {
+    if (!file_) return;
+
+    submitActive();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    if (writerThread_.joinable()) {
+        writerThread_.join();
+    }
+
+    std::fclose(file_);
+    file_ = nullptr;
+    spare_.clear();
+}
+
+bool TrackExporter::isOpen() const {
+    return file_ != nullptr;
+}
+
+size_t TrackExporter::getPendingBuffers() const {
+    return pendingCount_.load(std::memory_order_relaxed);
+}
+
+void TrackExporter::writeFrame(int frameNumber, TrackView<TrackedVehicle> tracks) {
+    if (!file_) return;
+    for (const auto& track : tracks) {
+        writeRow(frameNumber, track, 1.0f, false, false);
+    }
+    if (active_.size() >= bufferBytes_) {
+        submitActive();
+    }
+}
+
+void TrackExporter::writeFrame(int frameNumber, TrackView<AdvancedTrackedVehicle> tracks,
+                               int primaryTargetId) {
+    if (!file_) return;
+    for (const auto& track : tracks) {
+        writeRow(frameNumber, track, track.visibilityRatio, track.isPartiallyOccluded,
+                 track.id == primaryTargetId);
+    }
+    if (active_.size() >= bufferBytes_) {
+        submitActive();
+    }
+}
+
+void TrackExporter::writeRow(int frameNumber, const TrackedVehicle& track,
+                             float visibility, bool occluded, bool primary) {
+    // Longest row is well under this; labels are clipped to keep the bound
+    char row[256];
+    char* end = row + sizeof(row);
+    char* out = row;
+    const cv::Rect& box = track.boundingBox;
+
+    out = appendInt(out, end, frameNumber);
+    *out++ = ',';
+    out = appendInt(out, end, track.id);
+    *out++ = ',';
+
+    if (format_ == ExportFormat::MOTChallenge) {
+        out = appendInt(out, end, box.x);
+        *out++ = ',';
+        out = appendInt(out, end, box.y);
+        *out++ = ',';
+        out = appendInt(out, end, box.width);
+        *out++ = ',';
+        out = appendInt(out, end, box.height);
+        *out++ = ',';
+        out = appendFixed(out, end, track.confidence, 3);
+        out = appendText(out, ",-1,-1,-1\n", 10);
+    } else {
+        const std::string& label = labelName(track.label);
+        out = appendText(out, label.data(), std::min<size_t>(label.size(), 64));
+        *out++ = ',';
+        out = appendInt(out, end, box.x);
+        *out++ = ',';
+        out = appendInt(out, end, box.y);
+        *out++ = ',';
+        out = appendInt(out, end, box.width);
+        *out++ = ',';
+        out = appendInt(out, end, box.height);
+        *out++ = ',';
+        out = appendFixed(out, end, track.velocity.x, 2);
+        *out++ = ',';
+        out = appendFixed(out, end, track.velocity.y, 2);
+        *out++ = ',';
+        out = appendFixed(out, end, track.confidence, 3);
+        *out++ = ',';
+        out = appendFixed(out, end, visibility, 3);
+        *out++ = ',';
+        *out++ = occluded ? '1' : '0';
+        *out++ = ',';
+        *out++ = primary ? '1' : '0';
+        *out++ = '\n';
+    }
+
+    active_.append(row, static_cast<size_t>(out - row));
+}
+
+void TrackExporter::submitActive() {
+    if (active_.empty()) return;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    {
+        // Shows up on the timeline when the writer falls behind
+        TRACE_SCOPE("export_wait");
+        cv_.wait(lock, [this] { return pending_.size() < kMaxPendingBuffers; });
+    }
+
+    pending_.push_back(std::move(active_));
+    pendingCount_.store(pending_.size(), std::memory_order_relaxed);
+    if (!spare_.empty()) {
+        active_ = std::move(spare_.back());
+        spare_.pop_back();
+    } else {
+        active_ = std::string();
+        active_.reserve(bufferBytes_ + 512);
+    }
+    lock.unlock();
+    cv_.notify_all();
+}
+
+void TrackExporter::writerLoop() {
+    Tracer::setThreadName("track_export");
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (pending_.empty()) {
+            if (stopping_) break;
+            continue;
+        }
+
+        std::string buffer = std::move(pending_.front());
+        pending_.pop_front();
+        pendingCount_.store(pending_.size(), std::memory_order_relaxed);
+        lock.unlock();
+
+        {
+            TRACE_SCOPE("export_fwrite");
+            if (std::fwrite(buffer.data(), 1, buffer.size(), file_) != buffer.size()) {
+                std::cerr << "Error: Track export write failed" << std::endl;
+            }
+        }
+        buffer.clear();
+
+        lock.lock();
+        spare_.push_back(std::move(buffer));
+        cv_.notify_all();
+    }
+}
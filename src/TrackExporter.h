@@ -0,0 +1,67 @@
+#pragma once
+
+#include "AdvancedTrackingSystem.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class ExportFormat {
+    MOTChallenge,  // frame,id,bb_left,bb_top,bb_width,bb_height,conf,-1,-1,-1
+    CSV            // Full track state with a header row
+};
+
+// Structured track export sink. Rows are formatted by hand into a large
+// in-memory buffer; full buffers are handed to a background thread that
+// does the actual fwrite, so the tracking loop never waits on disk unless
+// the writer falls more than a couple of buffers behind.
+//
+// Frame numbers are written 1-based, as MOTChallenge expects.
+class TrackExporter {
+public:
+    static constexpr size_t kDefaultBufferBytes = 1 << 20;
+
+    TrackExporter();
+    ~TrackExporter();
+
+    bool open(const std::string& path, ExportFormat format,
+              size_t bufferBytes = kDefaultBufferBytes);
+    // Keeps the rows of an existing export up to lastFrame and appends after
+    // them, for a job resumed from a tracker snapshot
+    bool openForResume(const std::string& path, ExportFormat format, int lastFrame,
+                       size_t bufferBytes = kDefaultBufferBytes);
+    void close();
+    bool isOpen() const;
+
+    void writeFrame(int frameNumber, TrackView<TrackedVehicle> tracks);
+    void writeFrame(int frameNumber, TrackView<AdvancedTrackedVehicle> tracks,
+                    int primaryTargetId = -1);
+
+    // Full buffers waiting for the writer thread; safe from any thread
+    size_t getPendingBuffers() const;
+
+private:
+    FILE* file_;
+    ExportFormat format_;
+    size_t bufferBytes_;
+    std::string active_;
+
+    // Background writer state
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::string> pending_;
+    std::atomic<size_t> pendingCount_;  // pending_.size(), readable without the lock
+    std::vector<std::string> spare_;
+    std::thread writerThread_;
+    bool stopping_;
+
+    void start(ExportFormat format, size_t bufferBytes, bool writeHeader);
+    void writeRow(int frameNumber, const TrackedVehicle& track,
+                  float visibility, bool occluded, bool primary);
+    void submitActive();
+    void writerLoop();
+};
@@ -0,0 +1,400 @@
+#include "TrackLog.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Column order inside a chunk payload; all but the flags column are 4 bytes wide
+enum TrackLogColumn {
+    kColFrame, kColId, kColX, kColY, kColWidth, kColHeight,
+    kColVx, kColVy, kColConfidence, kColVisibility,
+    kWideColumnCount
+};
+
+uint64_t payloadSize(uint32_t rows) {
+    uint64_t bytes = static_cast<uint64_t>(rows) * (kWideColumnCount * 4 + 1);
+    return (bytes + 7) & ~uint64_t(7);
+}
+
+template <typename T>
+const T* column(const uint8_t* payload, uint32_t rows, int col) {
+    return reinterpret_cast<const T*>(payload + static_cast<size_t>(col) * rows * 4);
+}
+
+const uint8_t* flagsColumn(const uint8_t* payload, uint32_t rows) {
+    return payload + static_cast<size_t>(kWideColumnCount) * rows * 4;
+}
+
+TrackLogRow rowAt(const uint8_t* payload, uint32_t rows, uint32_t row) {
+    TrackLogRow out;
+    out.frame = column<int32_t>(payload, rows, kColFrame)[row];
+    out.id = column<int32_t>(payload, rows, kColId)[row];
+    out.x = column<int32_t>(payload, rows, kColX)[row];
+    out.y = column<int32_t>(payload, rows, kColY)[row];
+    out.width = column<int32_t>(payload, rows, kColWidth)[row];
+    out.height = column<int32_t>(payload, rows, kColHeight)[row];
+    out.vx = column<float>(payload, rows, kColVx)[row];
+    out.vy = column<float>(payload, rows, kColVy)[row];
+    out.confidence = column<float>(payload, rows, kColConfidence)[row];
+    out.visibility = column<float>(payload, rows, kColVisibility)[row];
+    out.flags = flagsColumn(payload, rows)[row];
+    return out;
+}
+
+bool overlaps(int32_t aFrom, int32_t aTo, int32_t bFrom, int32_t bTo) {
+    return aFrom <= bTo && bFrom <= aTo;
+}
+
+} // namespace
+
+// ---------------------------------------------------------------------------
+// Writer
+// ---------------------------------------------------------------------------
+
+TrackLogWriter::TrackLogWriter()
+    : file_(nullptr), chunkRows_(kDefaultChunkRows), rowsWritten_(0) {
+}
+
+TrackLogWriter::~TrackLogWriter() {
+    close();
+}
+
+bool TrackLogWriter::open(const std::string& path, uint32_t chunkRows) {
+    close();
+    chunkRows_ = std::max<uint32_t>(1, chunkRows);
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Error: Could not open track log: " << path << std::endl;
+        return false;
+    }
+    TrackLogFileHeader header = {kTrackLogMagic, kTrackLogVersion, {0, 0}};
+    std::fwrite(&header, sizeof(header), 1, file_);
+    reserveColumns();
+    return true;
+}
+
+bool TrackLogWriter::openForResume(const std::string& path, int32_t lastFrame, uint32_t chunkRows) {
+    close();
+    chunkRows_ = std::max<uint32_t>(1, chunkRows);
+
+    // Chunks are written in frame order. Keep the whole ones up to lastFrame,
+    // carry the rows up to lastFrame out of the chunk that straddles it, and
+    // drop the rest along with any chunk left half-written by a crash.
+    long keepBytes = 0;
+    std::vector<TrackLogRow> carried;
+    if (FILE* existing = std::fopen(path.c_str(), "rb")) {
+        TrackLogFileHeader header;
+        if (std::fread(&header, sizeof(header), 1, existing) == 1 &&
+            header.magic == kTrackLogMagic && header.version == kTrackLogVersion) {
+            std::fseek(existing, 0, SEEK_END);
+            long fileSize = std::ftell(existing);
+            keepBytes = sizeof(header);
+            std::fseek(existing, keepBytes, SEEK_SET);
+
+            TrackLogChunkHeader chunk;
+            std::vector<uint8_t> payload;
+            while (std::fread(&chunk, sizeof(chunk), 1, existing) == 1 &&
+                   chunk.magic == kTrackLogChunkMagic &&
+                   chunk.payloadBytes == payloadSize(chunk.rowCount)) {
+                long end = keepBytes + static_cast<long>(sizeof(chunk) + chunk.payloadBytes);
+                if (end > fileSize) break;
+                if (chunk.lastFrame > lastFrame) {
+                    if (chunk.firstFrame <= lastFrame) payload.resize(chunk.payloadBytes);
+                    if (!payload.empty() &&
+                        std::fread(payload.data(), 1, payload.size(), existing) == payload.size()) {
+                        for (uint32_t i = 0; i < chunk.rowCount; ++i) {
+                            TrackLogRow row = rowAt(payload.data(), chunk.rowCount, i);
+                            if (row.frame <= lastFrame) carried.push_back(row);
+                        }
+                    }
+                    break;
+                }
+                keepBytes = end;
+                std::fseek(existing, keepBytes, SEEK_SET);
+            }
+        }
+        std::fclose(existing);
+    }
+    if (keepBytes == 0) {
+        return open(path, chunkRows);
+    }
+
+#ifndef _WIN32
+    if (truncate(path.c_str(), keepBytes) != 0) {
+        std::cerr << "Error: Could not trim track log: " << path << std::endl;
+        return false;
+    }
+#endif
+    file_ = std::fopen(path.c_str(), "ab");
+    if (!file_) {
+        std::cerr << "Error: Could not open track log: " << path << std::endl;
+        return false;
+    }
+    reserveColumns();
+    for (const auto& row : carried) {
+        append(row);
+    }
+    return true;
+}
+
+void TrackLogWriter::append(const TrackLogRow& row) {
+    if (!file_) return;
+
+    frames_.push_back(row.frame);
+    ids_.push_back(row.id);
+    xs_.push_back(row.x);
+    ys_.push_back(row.y);
+    widths_.push_back(row.width);
+    heights_.push_back(row.height);
+    vxs_.push_back(row.vx);
+    vys_.push_back(row.vy);
+    confidences_.push_back(row.confidence);
+    visibilities_.push_back(row.visibility);
+    flags_.push_back(row.flags);
+    rowsWritten_++;
+
+    if (frames_.size() >= chunkRows_) {
+        writeChunk();
+    }
+}
+
+void TrackLogWriter::flush() {
+    if (!file_) return;
+    writeChunk();
+    std::fflush(file_);
+}
+
+void TrackLogWriter::close() {
+    if (!file_) return;
+    flush();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+bool TrackLogWriter::isOpen() const {
+    return file_ != nullptr;
+}
+
+uint64_t TrackLogWriter::getRowsWritten() const {
+    return rowsWritten_;
+}
+
+void TrackLogWriter::reserveColumns() {
+    for (auto* col : {&frames_, &ids_, &xs_, &ys_, &widths_, &heights_}) col->reserve(chunkRows_);
+    for (auto* col : {&vxs_, &vys_, &confidences_, &visibilities_}) col->reserve(chunkRows_);
+    flags_.reserve(chunkRows_);
+}
+
+void TrackLogWriter::writeChunk() {
+    if (frames_.empty()) return;
+
+    uint32_t rows = static_cast<uint32_t>(frames_.size());
+    TrackLogChunkHeader header;
+    header.magic = kTrackLogChunkMagic;
+    header.rowCount = rows;
+    header.firstFrame = *std::min_element(frames_.begin(), frames_.end());
+    header.lastFrame = *std::max_element(frames_.begin(), frames_.end());
+    header.minX = header.minY = std::numeric_limits<int32_t>::max();
+    header.maxX = header.maxY = std::numeric_limits<int32_t>::min();
+    for (uint32_t i = 0; i < rows; ++i) {
+        header.minX = std::min(header.minX, xs_[i]);
+        header.minY = std::min(header.minY, ys_[i]);
+        header.maxX = std::max(header.maxX, xs_[i] + widths_[i]);
+        header.maxY = std::max(header.maxY, ys_[i] + heights_[i]);
+    }
+    header.payloadBytes = payloadSize(rows);
+
+    std::fwrite(&header, sizeof(header), 1, file_);
+    for (auto* col : {&frames_, &ids_, &xs_, &ys_, &widths_, &heights_}) {
+        std::fwrite(col->data(), sizeof(int32_t), rows, file_);
+    }
+    for (auto* col : {&vxs_, &vys_, &confidences_, &visibilities_}) {
+        std::fwrite(col->data(), sizeof(float), rows, file_);
+    }
+    std::fwrite(flags_.data(), 1, rows, file_);
+
+    static const uint8_t padding[8] = {0};
+    size_t written = static_cast<size_t>(rows) * (kWideColumnCount * 4 + 1);
+    std::fwrite(padding, 1, header.payloadBytes - written, file_);
+
+    for (auto* col : {&frames_, &ids_, &xs_, &ys_, &widths_, &heights_}) col->clear();
+    for (auto* col : {&vxs_, &vys_, &confidences_, &visibilities_}) col->clear();
+    flags_.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Reader
+// ---------------------------------------------------------------------------
+
+TrackLogReader::TrackLogReader()
+    : fd_(-1), mapping_(nullptr), mappingSize_(0), rowCount_(0) {
+}
+
+TrackLogReader::~TrackLogReader() {
+    close();
+}
+
+bool TrackLogReader::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    std::cerr << "Memory-mapped track log reading is not supported on Windows" << std::endl;
+    return false;
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        std::cerr << "Error: Could not open track log: " << path << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd_, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(TrackLogFileHeader)) {
+        std::cerr << "Error: Track log is empty or unreadable: " << path << std::endl;
+        close();
+        return false;
+    }
+
+    void* addr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd_, 0);
+    if (addr == MAP_FAILED) {
+        std::cerr << "Error: Could not map track log: " << path << std::endl;
+        close();
+        return false;
+    }
+    mapping_ = static_cast<const uint8_t*>(addr);
+    mappingSize_ = static_cast<size_t>(st.st_size);
+
+    if (!buildIndex()) {
+        std::cerr << "Error: Not a track log: " << path << std::endl;
+        close();
+        return false;
+    }
+    return true;
+#endif
+}
+
+void TrackLogReader::close() {
+#ifndef _WIN32
+    if (mapping_) {
+        munmap(const_cast<uint8_t*>(mapping_), mappingSize_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+#endif
+    fd_ = -1;
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    chunks_.clear();
+    rowCount_ = 0;
+}
+
+bool TrackLogReader::buildIndex() {
+    TrackLogFileHeader fileHeader;
+    std::memcpy(&fileHeader, mapping_, sizeof(fileHeader));
+    if (fileHeader.magic != kTrackLogMagic || fileHeader.version != kTrackLogVersion) {
+        return false;
+    }
+
+    size_t offset = sizeof(TrackLogFileHeader);
+    while (offset + sizeof(TrackLogChunkHeader) <= mappingSize_) {
+        ChunkIndex chunk;
+        std::memcpy(&chunk.header, mapping_ + offset, sizeof(chunk.header));
+        if (chunk.header.magic != kTrackLogChunkMagic ||
+            chunk.header.payloadBytes != payloadSize(chunk.header.rowCount) ||
+            offset + sizeof(TrackLogChunkHeader) + chunk.header.payloadBytes > mappingSize_) {
+            break; // Truncated tail from an interrupted writer
+        }
+        chunk.payload = mapping_ + offset + sizeof(TrackLogChunkHeader);
+        chunks_.push_back(chunk);
+        rowCount_ += chunk.header.rowCount;
+        offset += sizeof(TrackLogChunkHeader) + chunk.header.payloadBytes;
+    }
+    return true;
+}
+
+TrackLogRow TrackLogReader::readRow(const ChunkIndex& chunk, uint32_t row) {
+    return rowAt(chunk.payload, chunk.header.rowCount, row);
+}
+
+template <typename ChunkFilter, typename RowFilter>
+void TrackLogReader::scan(int32_t fromFrame, int32_t toFrame, const ChunkFilter& chunkMayMatch,
+                          const RowFilter& rowMatches, const RowVisitor& visit) const {
+    for (const auto& chunk : chunks_) {
+        if (!overlaps(chunk.header.firstFrame, chunk.header.lastFrame, fromFrame, toFrame)) continue;
+        if (!chunkMayMatch(chunk.header)) continue;
+
+        // Filter on the narrow columns first; only materialize matching rows
+        const int32_t* frames = column<int32_t>(chunk.payload, chunk.header.rowCount, kColFrame);
+        for (uint32_t i = 0; i < chunk.header.rowCount; ++i) {
+            if (frames[i] < fromFrame || frames[i] > toFrame) continue;
+            if (!rowMatches(chunk, i)) continue;
+            if (!visit(readRow(chunk, i))) return;
+        }
+    }
+}
+
+void TrackLogReader::queryTrack(int32_t id, int32_t fromFrame, int32_t toFrame,
+                                const RowVisitor& visit) const {
+    scan(fromFrame, toFrame,
+         [](const TrackLogChunkHeader&) { return true; },
+         [id](const ChunkIndex& chunk, uint32_t row) {
+             return column<int32_t>(chunk.payload, chunk.header.rowCount, kColId)[row] == id;
+         },
+         visit);
+}
+
+void TrackLogReader::queryRegion(int32_t x, int32_t y, int32_t width, int32_t height,
+                                 int32_t fromFrame, int32_t toFrame, const RowVisitor& visit) const {
+    const int32_t right = x + width;
+    const int32_t bottom = y + height;
+    scan(fromFrame, toFrame,
+         [&](const TrackLogChunkHeader& header) {
+             return header.minX < right && x < header.maxX &&
+                    header.minY < bottom && y < header.maxY;
+         },
+         [&](const ChunkIndex& chunk, uint32_t row) {
+             const uint32_t rows = chunk.header.rowCount;
+             int32_t bx = column<int32_t>(chunk.payload, rows, kColX)[row];
+             int32_t by = column<int32_t>(chunk.payload, rows, kColY)[row];
+             int32_t bw = column<int32_t>(chunk.payload, rows, kColWidth)[row];
+             int32_t bh = column<int32_t>(chunk.payload, rows, kColHeight)[row];
+             return bx < right && x < bx + bw && by < bottom && y < by + bh;
+         },
+         visit);
+}
+
+void TrackLogReader::queryFrames(int32_t fromFrame, int32_t toFrame, const RowVisitor& visit) const {
+    scan(fromFrame, toFrame,
+         [](const TrackLogChunkHeader&) { return true; },
+         [](const ChunkIndex&, uint32_t) { return true; },
+         visit);
+}
+
+const std::vector<TrackLogReader::ChunkIndex>& TrackLogReader::getChunks() const {
+    return chunks_;
+}
+
+uint64_t TrackLogReader::getRowCount() const {
+    return rowCount_;
+}
+
+int32_t TrackLogReader::getFirstFrame() const {
+    int32_t first = std::numeric_limits<int32_t>::max();
+    for (const auto& chunk : chunks_) first = std::min(first, chunk.header.firstFrame);
+    return chunks_.empty() ? 0 : first;
+}
+
+int32_t TrackLogReader::getLastFrame() const {
+    int32_t last = std::numeric_limits<int32_t>::min();
+    for (const auto& chunk : chunks_) last = std::max(last, chunk.header.lastFrame);
+    return chunks_.empty() ? 0 : last;
+}
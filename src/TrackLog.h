@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Append-only columnar log of per-frame track states.
+//
+// File layout:
+//   [TrackLogFileHeader][chunk][chunk]...
+//   chunk = [TrackLogChunkHeader][column payload]
+//
+// Each chunk stores up to TrackLogWriter::kDefaultChunkRows rows as one
+// contiguous array per column, and its header carries the frame range and
+// the bounding region of every box in the chunk. Readers rebuild the index
+// by hopping from header to header and skip whole chunks that cannot match
+// a query. A chunk cut short by a crash fails its size check and is ignored,
+// so everything flushed before it stays readable.
+constexpr uint32_t kTrackLogMagic = 0x4C544343;      // "CCTL"
+constexpr uint32_t kTrackLogChunkMagic = 0x4B4E4843; // "CHNK"
+constexpr uint32_t kTrackLogVersion = 1;
+
+enum TrackLogFlags : uint8_t {
+    kTrackLogOccluded = 1 << 0,
+    kTrackLogPrimary = 1 << 1
+};
+
+struct TrackLogRow {
+    int32_t frame;
+    int32_t id;
+    int32_t x, y, width, height;
+    float vx, vy;
+    float confidence;
+    float visibility;
+    uint8_t flags;
+};
+
+struct TrackLogFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t reserved[2];
+};
+
+struct TrackLogChunkHeader {
+    uint32_t magic;
+    uint32_t rowCount;
+    int32_t firstFrame;
+    int32_t lastFrame;
+    int32_t minX, minY, maxX, maxY;  // Union of all boxes in the chunk
+    uint64_t payloadBytes;
+};
+
+static_assert(sizeof(TrackLogFileHeader) == 16, "track log header layout changed");
+static_assert(sizeof(TrackLogChunkHeader) == 40, "track log chunk layout changed");
+
+class TrackLogWriter {
+public:
+    static constexpr uint32_t kDefaultChunkRows = 4096;
+
+    TrackLogWriter();
+    ~TrackLogWriter();
+
+    // Starts a new log, replacing whatever is at path
+    bool open(const std::string& path, uint32_t chunkRows = kDefaultChunkRows);
+    // Keeps the rows of an existing log up to lastFrame and appends after
+    // them, for a job resumed from a tracker snapshot. Starts a new log when
+    // the file is not a valid track log.
+    bool openForResume(const std::string& path, int32_t lastFrame,
+                       uint32_t chunkRows = kDefaultChunkRows);
+    void append(const TrackLogRow& row);
+    void flush();
+    void close();
+    bool isOpen() const;
+
+    uint64_t getRowsWritten() const;
+
+private:
+    FILE* file_;
+    uint32_t chunkRows_;
+    uint64_t rowsWritten_;
+
+    // Column buffers for the chunk being built
+    std::vector<int32_t> frames_, ids_, xs_, ys_, widths_, heights_;
+    std::vector<float> vxs_, vys_, confidences_, visibilities_;
+    std::vector<uint8_t> flags_;
+
+    void reserveColumns();
+    void writeChunk();
+};
+
+class TrackLogReader {
+public:
+    struct ChunkIndex {
+        TrackLogChunkHeader header;
+        const uint8_t* payload;
+    };
+
+    TrackLogReader();
+    ~TrackLogReader();
+
+    bool open(const std::string& path);
+    void close();
+
+    // Visitors return false to stop the scan early
+    using RowVisitor = std::function<bool(const TrackLogRow&)>;
+
+    void queryTrack(int32_t id, int32_t fromFrame, int32_t toFrame, const RowVisitor& visit) const;
+    void queryRegion(int32_t x, int32_t y, int32_t width, int32_t height,
+                     int32_t fromFrame, int32_t toFrame, const RowVisitor& visit) const;
+    void queryFrames(int32_t fromFrame, int32_t toFrame, const RowVisitor& visit) const;
+
+    const std::vector<ChunkIndex>& getChunks() const;
+    uint64_t getRowCount() const;
+    int32_t getFirstFrame() const;
+    int32_t getLastFrame() const;
+
+private:
+    int fd_;
+    const uint8_t* mapping_;
+    size_t mappingSize_;
+    std::vector<ChunkIndex> chunks_;
+    uint64_t rowCount_;
+
+    bool buildIndex();
+    template <typename ChunkFilter, typename RowFilter>
+    void scan(int32_t fromFrame, int32_t toFrame, const ChunkFilter& chunkMayMatch,
+              const RowFilter& rowMatches, const RowVisitor& visit) const;
+    static TrackLogRow readRow(const ChunkIndex& chunk, uint32_t row);
+};
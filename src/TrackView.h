@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// Read-only view of the active tracks in a tracker's live table, returned by
+// TrackingSystem::update and AdvancedTrackingSystem::updateAdvanced instead of
+// a copy of every track. Valid until the tracker's next update, reset or
+// restoreState; copy out whatever has to outlive that.
+template <typename Track>
+class TrackView {
+public:
+    // Forward iterator that skips inactive tracks
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Track;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Track*;
+        using reference = const Track&;
+
+        const_iterator() : current_(nullptr), last_(nullptr) {}
+        const_iterator(const Track* current, const Track* last)
+            : current_(current), last_(last) {
+            skipInactive();
+        }
+
+        reference operator*() const { return *current_; }
+        pointer operator->() const { return current_; }
+        const_iterator& operator++() {
+            ++current_;
+            skipInactive();
+            return *this;
+        }
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        bool operator==(const const_iterator& other) const { return current_ == other.current_; }
+        bool operator!=(const const_iterator& other) const { return current_ != other.current_; }
+
+    private:
+        const Track* current_;
+        const Track* last_;
+
+        void skipInactive() {
+            while (current_ != last_ && !current_->isActive) ++current_;
+        }
+    };
+
+    TrackView() : first_(nullptr), last_(nullptr) {}
+    TrackView(const Track* first, const Track* last) : first_(first), last_(last) {}
+    // Lets callers holding their own vector (tests, benchmarks) use the same sinks
+    TrackView(const std::vector<Track>& tracks)
+        : first_(tracks.data()), last_(tracks.data() + tracks.size()) {}
+
+    const_iterator begin() const { return const_iterator(first_, last_); }
+    const_iterator end() const { return const_iterator(last_, last_); }
+    bool empty() const { return begin() == end(); }
+    // Counts the active tracks; linear in the table size
+    size_t size() const {
+        size_t count = 0;
+        for (const_iterator it = begin(); it != end(); ++it) ++count;
+        return count;
+    }
+
+    // Visitor interface for renderers and exporters: visit(const Track&) for
+    // every active track, in table order
+    template <typename Visitor>
+    void forEach(Visitor&& visit) const {
+        for (const Track& track : *this) visit(track);
+    }
+
+private:
+    const Track* first_;
+    const Track* last_;
+};
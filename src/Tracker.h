@@ -0,0 +1,239 @@
+#pragma once
+
+#include "TrackerPolicies.h"
+#include "TrackView.h"
+#include "FrameArena.h"
+#include "VehicleDetector.h"
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Tracker with its configuration fixed at compile time. TrackingSystem and
+// AdvancedTrackingSystem pick their features at runtime (flags the
+// controller toggles while playing, snapshots, subclass hooks); this
+// template is for fixed deployments. Each policy (TrackerPolicies.h) is a
+// type parameter, so the association and motion calls inline into the
+// loops below and a disabled appearance or camera model compiles to
+// nothing.
+//
+// Per frame: shift detections by the camera motion, predict every track,
+// greedily give each track its best accepted detection, re-identify lost
+// tracks from unmatched detections by appearance, start tracks for the
+// rest and drop stale ones. With KalmanMotion, IoUAssociation and no
+// appearance or camera model this is TrackingSystem::update.
+template <typename MotionModel, typename AssociationMetric,
+          typename AppearanceModel, typename CameraModel>
+class Tracker {
+public:
+    struct Track {
+        int id;
+        cv::Rect boundingBox;
+        cv::Point2f velocity;
+        float confidence;
+        int age;
+        int totalHits;
+        int consecutiveHits;
+        int consecutiveMisses;
+        LabelId label;
+        bool isActive;
+        typename MotionModel::State motion;
+        typename AppearanceModel::State appearance;
+
+        Track() : id(-1), confidence(0.0f), age(0), totalHits(0), consecutiveHits(0),
+                  consecutiveMisses(0), label(kUnknownLabel), isActive(false) {}
+    };
+
+    explicit Tracker(MotionModel motion = MotionModel(),
+                     AssociationMetric association = AssociationMetric(),
+                     AppearanceModel appearance = AppearanceModel(),
+                     CameraModel camera = CameraModel())
+        : motion_(motion), association_(association), appearance_(appearance), camera_(camera),
+          nextId_(0), maxAge_(30), minHits_(3) {}
+
+    // Active tracks after this frame; a view of the live table, no copies.
+    // The frame is only read by appearance and camera models. dt is the
+    // time since the previous update in frames (see TrackerPolicies.h).
+    TrackView<Track> update(ConstSpan<Detection> detections, const cv::Mat& frame, float dt = 1.0f) {
+        FrameArenaScope arenaScope(frameArena_);
+
+        ConstSpan<Detection> input = detections;
+        ArenaVector<Detection> compensated{ArenaAllocator<Detection>(&frameArena_)};
+        if constexpr (CameraModel::kEnabled) {
+            camera_.estimate(frame);
+            cv::Point2f offset = camera_.offset();
+            compensated.assign(detections.begin(), detections.end());
+            for (auto& detection : compensated) {
+                detection.boundingBox.x += static_cast<int>(offset.x);
+                detection.boundingBox.y += static_cast<int>(offset.y);
+            }
+            input = compensated;
+        }
+
+        predictTracks(dt);
+        ArenaVector<char> detectionMatched(input.size(), 0, ArenaAllocator<char>(&frameArena_));
+        associate(input, frame, detectionMatched);
+        createNewTracks(input, frame, detectionMatched);
+        removeStaleTracks();
+
+        return getTracks();
+    }
+
+    TrackView<Track> getTracks() const { return TrackView<Track>(tracks_); }
+
+    void reset() {
+        tracks_.clear();
+        nextId_ = 0;
+    }
+
+    void setMaxAge(int maxAge) { maxAge_ = maxAge; }
+    void setMinHits(int minHits) { minHits_ = minHits; }
+
+    // Policy parameters (thresholds, gains) are tuned through these
+    MotionModel& motionModel() { return motion_; }
+    AssociationMetric& associationMetric() { return association_; }
+    AppearanceModel& appearanceModel() { return appearance_; }
+    CameraModel& cameraModel() { return camera_; }
+
+private:
+    MotionModel motion_;
+    AssociationMetric association_;
+    AppearanceModel appearance_;
+    CameraModel camera_;
+    std::vector<Track> tracks_;
+    int nextId_;
+    int maxAge_;
+    int minHits_;
+    FrameArena frameArena_;
+
+    void predictTracks(float dt) {
+        for (auto& track : tracks_) {
+            if (!track.isActive) continue;
+            motion_.predict(track.motion, track.boundingBox, track.velocity, dt);
+            track.age += framesCovered(dt);
+            track.consecutiveMisses += framesCovered(dt);
+        }
+    }
+
+    void associate(ConstSpan<Detection> detections, const cv::Mat& frame,
+                   ArenaVector<char>& detectionMatched) {
+        for (auto& track : tracks_) {
+            if (!track.isActive) continue;
+
+            float bestScore = 0.0f;
+            int bestDetectionIdx = -1;
+            for (size_t i = 0; i < detections.size(); ++i) {
+                if (detectionMatched[i]) continue;
+
+                float score = association_.score(track.boundingBox, detections[i].boundingBox);
+                if (score > bestScore && association_.accepts(score)) {
+                    bestScore = score;
+                    bestDetectionIdx = static_cast<int>(i);
+                }
+            }
+
+            if (bestDetectionIdx >= 0) {
+                const Detection& detection = detections[bestDetectionIdx];
+                motion_.correct(track.motion, detection.boundingBox);
+                applyDetection(track, detection, frame);
+                detectionMatched[bestDetectionIdx] = 1;
+            } else if (track.consecutiveMisses > maxAge_) {
+                track.isActive = false;
+            }
+        }
+    }
+
+    void createNewTracks(ConstSpan<Detection> detections, const cv::Mat& frame,
+                         const ArenaVector<char>& detectionMatched) {
+        for (size_t i = 0; i < detections.size(); ++i) {
+            // A matched detection always overlaps the track that took it
+            if (detectionMatched[i] || overlapsActiveTrack(detections[i].boundingBox)) continue;
+
+            if constexpr (AppearanceModel::kEnabled) {
+                if (reidentify(detections[i], frame)) continue;
+            }
+
+            Track track;
+            track.id = nextId_++;
+            track.boundingBox = detections[i].boundingBox;
+            track.confidence = detections[i].confidence;
+            track.label = detections[i].label;
+            track.isActive = true;
+            motion_.initialize(track.motion, track.boundingBox);
+            if constexpr (AppearanceModel::kEnabled) {
+                if (!frame.empty()) appearance_.update(track.appearance, frame, track.boundingBox);
+            }
+            tracks_.push_back(std::move(track));
+        }
+    }
+
+    bool overlapsActiveTrack(const cv::Rect& box) const {
+        for (const auto& track : tracks_) {
+            if (track.isActive && association_.accepts(association_.score(track.boundingBox, box))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Hands an unmatched detection to the most similar track that missed
+    // this frame, instead of starting a new id for it
+    bool reidentify(const Detection& detection, const cv::Mat& frame) {
+        if (frame.empty() || !appearance_.observe(frame, detection.boundingBox)) return false;
+
+        Track* best = nullptr;
+        float bestSimilarity = 0.0f;
+        for (auto& track : tracks_) {
+            if (!track.isActive || track.consecutiveMisses == 0) continue;
+            float similarity = appearance_.similarity(track.appearance);
+            if (similarity > bestSimilarity && appearance_.matches(similarity)) {
+                bestSimilarity = similarity;
+                best = &track;
+            }
+        }
+        if (!best) return false;
+
+        // The box jumped, so the motion model restarts from it
+        motion_.initialize(best->motion, detection.boundingBox);
+        applyDetection(*best, detection, frame);
+        return true;
+    }
+
+    void applyDetection(Track& track, const Detection& detection, const cv::Mat& frame) {
+        track.boundingBox = detection.boundingBox;
+        track.confidence = detection.confidence;
+        track.label = detection.label;
+        track.totalHits++;
+        track.consecutiveHits++;
+        track.consecutiveMisses = 0;
+        track.isActive = true;
+        if constexpr (AppearanceModel::kEnabled) {
+            if (!frame.empty()) appearance_.update(track.appearance, frame, track.boundingBox);
+        }
+    }
+
+    void removeStaleTracks() {
+        size_t kept = 0;
+        for (size_t i = 0; i < tracks_.size(); ++i) {
+            Track& track = tracks_[i];
+            bool stale = !track.isActive ||
+                         (track.consecutiveMisses > maxAge_ && track.totalHits < minHits_);
+            if (stale) continue;
+            if (kept != i) {
+                tracks_[kept] = std::move(track);
+            }
+            ++kept;
+        }
+        tracks_.erase(tracks_.begin() + kept, tracks_.end());
+    }
+};
+
+// Common fixed configurations. The runtime-configured classes stay the
+// default for the interactive tools; these are for builds that never
+// change their setup.
+
+// TrackingSystem's behaviour without its virtual hooks
+using FixedTrackingSystem = Tracker<KalmanMotion, IoUAssociation, NoAppearance, StaticCamera>;
+// AdvancedTrackingSystem's association with re-identification and camera
+// motion compensation always on
+using FixedAdvancedTrackingSystem = Tracker<KalmanMotion, IoUAssociation, HogAppearance, OpticalFlowCamera>;
+// Leanest: matrix-free motion, no pixels read at all
+using EdgeTrackingSystem = Tracker<ConstantVelocityMotion, IoUAssociation, NoAppearance, StaticCamera>;
@@ -0,0 +1,95 @@
+#include "TrackerMetrics.h"
+#include <cstdio>
+#include <sstream>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+void writeMetric(std::ostringstream& out, const char* name, const char* type, const char* help,
+                 uint64_t value) {
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+    out << name << " " << value << "\n";
+}
+
+uint64_t load(const std::atomic<uint64_t>& value) {
+    return value.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+TrackerMetrics::TrackerMetrics()
+    : framesProcessed(0), framesSkipped(0), framesDropped(0), detections(0),
+      lastFrameDetections(0), activeTracks(0), lostTracks(0), reIdHits(0),
+      frameQueueDepth(0), exportQueueDepth(0) {
+}
+
+uint64_t readResidentMemoryBytes() {
+#ifndef _WIN32
+    // Second field of statm is resident pages
+    FILE* file = std::fopen("/proc/self/statm", "r");
+    if (!file) return 0;
+    unsigned long long sizePages = 0, residentPages = 0;
+    int fields = std::fscanf(file, "%llu %llu", &sizePages, &residentPages);
+    std::fclose(file);
+    if (fields != 2) return 0;
+    return residentPages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else
+    return 0;
+#endif
+}
+
+std::string formatPrometheusMetrics(const TrackerMetrics& metrics, const LatencyStats& latency) {
+    std::ostringstream out;
+
+    writeMetric(out, "tracker_frames_processed_total", "counter",
+                "Frames run through detection and tracking.", load(metrics.framesProcessed));
+    writeMetric(out, "tracker_frames_skipped_total", "counter",
+                "Frames left out by frame skipping.", load(metrics.framesSkipped));
+    writeMetric(out, "tracker_frames_dropped_total", "counter",
+                "Frames overwritten in the shared-memory ring before they were read.",
+                load(metrics.framesDropped));
+    writeMetric(out, "tracker_detections_total", "counter",
+                "Detections passed to the tracker.", load(metrics.detections));
+    writeMetric(out, "tracker_frame_detections", "gauge",
+                "Detections in the most recent frame.", load(metrics.lastFrameDetections));
+    writeMetric(out, "tracker_active_tracks", "gauge",
+                "Tracks matched in the most recent frame.", load(metrics.activeTracks));
+    writeMetric(out, "tracker_lost_tracks", "gauge",
+                "Live tracks without a matching detection on the last processed frame.", load(metrics.lostTracks));
+    writeMetric(out, "tracker_reid_hits_total", "counter",
+                "Lost or occluded targets re-acquired by appearance.", load(metrics.reIdHits));
+    writeMetric(out, "tracker_frame_queue_depth", "gauge",
+                "Shared-memory frames waiting to be processed.", load(metrics.frameQueueDepth));
+    writeMetric(out, "tracker_export_queue_depth", "gauge",
+                "Track export buffers waiting to be written.", load(metrics.exportQueueDepth));
+    writeMetric(out, "process_resident_memory_bytes", "gauge",
+                "Resident memory size in bytes.", readResidentMemoryBytes());
+
+    const double quantiles[] = {0.5, 0.95, 0.99};
+    out << "# HELP tracker_stage_latency_seconds Time spent in each pipeline stage.\n";
+    out << "# TYPE tracker_stage_latency_seconds summary\n";
+    for (int i = 0; i < LatencyStats::kStageCount; ++i) {
+        LatencyStage stage = static_cast<LatencyStage>(i);
+        const LatencyHistogram& histogram = latency.get(stage);
+        const char* name = LatencyStats::stageName(stage);
+        for (double quantile : quantiles) {
+            out << "tracker_stage_latency_seconds{stage=\"" << name << "\",quantile=\"" << quantile << "\"} "
+                << histogram.getPercentile(quantile * 100.0) / 1e9 << "\n";
+        }
+        out << "tracker_stage_latency_seconds_sum{stage=\"" << name << "\"} " << histogram.getSum() / 1e9 << "\n";
+        out << "tracker_stage_latency_seconds_count{stage=\"" << name << "\"} " << histogram.getCount() << "\n";
+    }
+    out << "# HELP tracker_stage_latency_max_seconds Slowest observation of each pipeline stage.\n";
+    out << "# TYPE tracker_stage_latency_max_seconds gauge\n";
+    for (int i = 0; i < LatencyStats::kStageCount; ++i) {
+        LatencyStage stage = static_cast<LatencyStage>(i);
+        out << "tracker_stage_latency_max_seconds{stage=\"" << LatencyStats::stageName(stage) << "\"} "
+            << latency.get(stage).getMax() / 1e9 << "\n";
+    }
+
+    return out.str();
+}
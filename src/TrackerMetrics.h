@@ -0,0 +1,31 @@
+#pragma once
+
+#include "LatencyHistogram.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Counters and gauges for long-running tracker processes. The processing
+// thread updates them with relaxed atomic stores; nothing is formatted until
+// a scrape asks for it.
+struct TrackerMetrics {
+    std::atomic<uint64_t> framesProcessed;
+    std::atomic<uint64_t> framesSkipped;       // Left out by --frame-skip
+    std::atomic<uint64_t> framesDropped;       // Overwritten in the shared-memory ring before being read
+    std::atomic<uint64_t> detections;
+    std::atomic<uint64_t> lastFrameDetections;
+    std::atomic<uint64_t> activeTracks;
+    std::atomic<uint64_t> lostTracks;
+    std::atomic<uint64_t> reIdHits;
+    std::atomic<uint64_t> frameQueueDepth;     // Shared-memory frames waiting to be processed
+    std::atomic<uint64_t> exportQueueDepth;    // Track export buffers waiting for disk
+
+    TrackerMetrics();
+};
+
+// Resident set size of this process in bytes; 0 where unavailable
+uint64_t readResidentMemoryBytes();
+
+// Prometheus text exposition format (version 0.0.4). Stage latencies are
+// rendered as summaries with 0.5/0.95/0.99 quantiles.
+std::string formatPrometheusMetrics(const TrackerMetrics& metrics, const LatencyStats& latency);
@@ -0,0 +1,147 @@
+#include "TrackerPolicies.h"
+
+cv::KalmanFilter KalmanMotion::createFilter() {
+    // State: [x, y, width, height, vx, vy, vw, vh]
+    // Measurement: [x, y, width, height]
+    cv::KalmanFilter kf(8, 4, 0);
+
+    // State transition matrix
+    kf.transitionMatrix = cv::Mat::eye(8, 8, CV_32F);
+    kf.transitionMatrix.at<float>(0, 4) = 1.0f; // x += vx
+    kf.transitionMatrix.at<float>(1, 5) = 1.0f; // y += vy
+    kf.transitionMatrix.at<float>(2, 6) = 1.0f; // width += vw
+    kf.transitionMatrix.at<float>(3, 7) = 1.0f; // height += vh
+
+    // Measurement matrix
+    kf.measurementMatrix = cv::Mat::zeros(4, 8, CV_32F);
+    kf.measurementMatrix.at<float>(0, 0) = 1.0f;
+    kf.measurementMatrix.at<float>(1, 1) = 1.0f;
+    kf.measurementMatrix.at<float>(2, 2) = 1.0f;
+    kf.measurementMatrix.at<float>(3, 3) = 1.0f;
+
+    // Process noise covariance
+    kf.processNoiseCov = cv::Mat::eye(8, 8, CV_32F) * kPositionNoise;
+    kf.processNoiseCov.at<float>(4, 4) = kVelocityNoise;
+    kf.processNoiseCov.at<float>(5, 5) = kVelocityNoise;
+    kf.processNoiseCov.at<float>(6, 6) = kVelocityNoise;
+    kf.processNoiseCov.at<float>(7, 7) = kVelocityNoise;
+
+    // Measurement noise covariance
+    kf.measurementNoiseCov = cv::Mat::eye(4, 4, CV_32F) * 1e-1;
+
+    // Initial state covariance
+    kf.errorCovPost = cv::Mat::eye(8, 8, CV_32F) * 1e-1;
+
+    return kf;
+}
+
+void KalmanMotion::setTimeStep(cv::KalmanFilter& filter, float dt) {
+    // The transition holds the last step, so an unchanged dt costs one read
+    if (filter.transitionMatrix.at<float>(0, 4) == dt) return;
+
+    for (int i = 0; i < 4; ++i) {
+        filter.transitionMatrix.at<float>(i, i + 4) = dt;
+        // Noise is independent per frame, so its variance grows with the step
+        filter.processNoiseCov.at<float>(i, i) = kPositionNoise * dt;
+        filter.processNoiseCov.at<float>(i + 4, i + 4) = kVelocityNoise * dt;
+    }
+}
+
+void KalmanMotion::initialize(State& state, const cv::Rect& box) const {
+    state.filter = createFilter();
+
+    cv::Mat initial = cv::Mat::zeros(8, 1, CV_32F);
+    initial.at<float>(0) = static_cast<float>(box.x);
+    initial.at<float>(1) = static_cast<float>(box.y);
+    initial.at<float>(2) = static_cast<float>(box.width);
+    initial.at<float>(3) = static_cast<float>(box.height);
+    initial.copyTo(state.filter.statePre);
+    initial.copyTo(state.filter.statePost);
+}
+
+HogAppearance::HogAppearance()
+    : reIdThreshold(0.7f),
+      hog_(cv::Size(64, 64), cv::Size(16, 16), cv::Size(8, 8), cv::Size(8, 8), 9) {
+}
+
+bool HogAppearance::extract(const cv::Mat& frame, const cv::Rect& box) {
+    if (box.empty() || box.x < 0 || box.y < 0 ||
+        box.x + box.width > frame.cols || box.y + box.height > frame.rows) {
+        return false;
+    }
+
+    cv::resize(frame(box), resized_, cv::Size(64, 64));
+    const cv::Mat* gray = &resized_;
+    if (resized_.channels() == 3) {
+        cv::cvtColor(resized_, gray_, cv::COLOR_BGR2GRAY);
+        gray = &gray_;
+    }
+    hog_.compute(*gray, descriptors_);
+    return !descriptors_.empty();
+}
+
+void HogAppearance::update(State& state, const cv::Mat& frame, const cv::Rect& box) {
+    if (extract(frame, box)) {
+        // Reuses the track's buffer once it has the descriptor's size
+        cv::Mat(descriptors_).reshape(1, 1).copyTo(state.features);
+    }
+}
+
+bool HogAppearance::observe(const cv::Mat& frame, const cv::Rect& box) {
+    return extract(frame, box);
+}
+
+float HogAppearance::similarity(const State& state) const {
+    if (state.features.empty() || state.features.total() != descriptors_.size()) return 0.0f;
+
+    // Cosine similarity against the last observed candidate
+    const float* features = state.features.ptr<float>();
+    double dotProduct = 0.0, norm1 = 0.0, norm2 = 0.0;
+    for (size_t i = 0; i < descriptors_.size(); ++i) {
+        dotProduct += features[i] * descriptors_[i];
+        norm1 += features[i] * features[i];
+        norm2 += descriptors_[i] * descriptors_[i];
+    }
+
+    if (norm1 > 0 && norm2 > 0) {
+        return static_cast<float>(dotProduct / std::sqrt(norm1 * norm2));
+    }
+    return 0.0f;
+}
+
+OpticalFlowCamera::OpticalFlowCamera() : sensitivity(0.1f), motion_(0, 0) {
+}
+
+void OpticalFlowCamera::estimate(const cv::Mat& frame) {
+    motion_ = cv::Point2f(0, 0);
+    if (frame.empty()) return;
+
+    if (frame.channels() == 3) {
+        cv::cvtColor(frame, currentGray_, cv::COLOR_BGR2GRAY);
+    } else {
+        frame.copyTo(currentGray_);
+    }
+
+    if (!previousGray_.empty() && previousGray_.size() == currentGray_.size()) {
+        cv::goodFeaturesToTrack(previousGray_, previousPoints_, 100, 0.01, 10);
+        if (!previousPoints_.empty()) {
+            cv::calcOpticalFlowPyrLK(previousGray_, currentGray_, previousPoints_, nextPoints_,
+                                     status_, error_);
+
+            cv::Point2f totalMotion(0, 0);
+            int validPoints = 0;
+            for (size_t i = 0; i < previousPoints_.size(); ++i) {
+                if (status_[i]) {
+                    totalMotion += nextPoints_[i] - previousPoints_[i];
+                    validPoints++;
+                }
+            }
+            if (validPoints > 0) {
+                motion_ = totalMotion / validPoints * sensitivity;
+            }
+        }
+    }
+
+    // Swap rather than copy: this frame's grey image is the next reference
+    cv::swap(previousGray_, currentGray_);
+}
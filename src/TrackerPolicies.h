@@ -0,0 +1,220 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Policies for the Tracker template (Tracker.h). Each policy is a small
+// object the tracker owns by value; per-track data lives in the policy's
+// State, which the tracker embeds in every track. Hot per-pair and
+// per-track calls are defined inline here so they inline into the tracker's
+// loops; the OpenCV-heavy bodies live in TrackerPolicies.cpp.
+//
+// Appearance and camera policies carry a kEnabled constant. The tracker
+// tests it with if constexpr, so a disabled feature leaves no code behind.
+
+// --- Motion models: predict a track dt frames ahead, correct on a match ---
+//
+// dt is the time since the track was last predicted, in nominal frame
+// intervals: 1 for consecutive frames, N under --frame-skip N, fractional
+// when frames arrive unevenly. Velocities stay in pixels per frame.
+
+// Whole frames a step of dt covers, at least one. Track ages and miss
+// counts advance by this, so maxAge stays in source frames whatever the
+// frame skip.
+inline int framesCovered(float dt) {
+    return std::max(1, static_cast<int>(std::lround(dt)));
+}
+
+// Constant-velocity Kalman filter over [x, y, w, h] and its rates, the
+// model TrackingSystem uses
+struct KalmanMotion {
+    struct State {
+        cv::KalmanFilter filter;
+    };
+
+    // Process noise per frame of elapsed time
+    static constexpr float kPositionNoise = 1e-2f;
+    static constexpr float kVelocityNoise = 1e-1f;
+
+    // Filter shared with TrackingSystem::createKalmanFilter
+    static cv::KalmanFilter createFilter();
+    // Sets the transition and process noise of filter for a step of dt
+    // frames. Cheap when dt is the same as the last step.
+    static void setTimeStep(cv::KalmanFilter& filter, float dt);
+
+    void initialize(State& state, const cv::Rect& box) const;
+
+    void predict(State& state, cv::Rect& box, cv::Point2f& velocity, float dt) const {
+        setTimeStep(state.filter, dt);
+        const cv::Mat& prediction = state.filter.predict();
+        box.x = static_cast<int>(prediction.at<float>(0));
+        box.y = static_cast<int>(prediction.at<float>(1));
+        box.width = static_cast<int>(prediction.at<float>(2));
+        box.height = static_cast<int>(prediction.at<float>(3));
+        velocity.x = prediction.at<float>(4);
+        velocity.y = prediction.at<float>(5);
+    }
+
+    void correct(State& state, const cv::Rect& box) const {
+        // A Mat header over stack memory does not allocate
+        float values[4] = {static_cast<float>(box.x), static_cast<float>(box.y),
+                           static_cast<float>(box.width), static_cast<float>(box.height)};
+        state.filter.correct(cv::Mat(4, 1, CV_32F, values));
+    }
+};
+
+// Alpha-beta filter on the box position; the size follows the last match.
+// No matrices, so a track is a few dozen bytes instead of a KalmanFilter.
+struct ConstantVelocityMotion {
+    struct State {
+        cv::Point2f position;
+        cv::Point2f velocity;
+        float elapsed;  // Frames covered by the last predict
+    };
+
+    // Share of each position error folded into the velocity
+    float velocityGain;
+
+    ConstantVelocityMotion() : velocityGain(0.5f) {}
+
+    void initialize(State& state, const cv::Rect& box) const {
+        state.position = cv::Point2f(static_cast<float>(box.x), static_cast<float>(box.y));
+        state.velocity = cv::Point2f(0, 0);
+        state.elapsed = 1.0f;
+    }
+
+    void predict(State& state, cv::Rect& box, cv::Point2f& velocity, float dt) const {
+        state.position += state.velocity * dt;
+        state.elapsed = dt;
+        box.x = cvRound(state.position.x);
+        box.y = cvRound(state.position.y);
+        velocity = state.velocity;
+    }
+
+    void correct(State& state, const cv::Rect& box) const {
+        cv::Point2f measured(static_cast<float>(box.x), static_cast<float>(box.y));
+        // The error built up over the whole step, so it is spread over it
+        state.velocity += (measured - state.position) * (velocityGain / state.elapsed);
+        state.position = measured;
+    }
+};
+
+// --- Association metrics: score a predicted track box against a detection ---
+
+// Intersection over union, TrackingSystem's metric
+struct IoUAssociation {
+    float threshold;
+
+    IoUAssociation() : threshold(0.3f) {}
+
+    static float intersectionOverUnion(const cv::Rect& rect1, const cv::Rect& rect2) {
+        int x1 = std::max(rect1.x, rect2.x);
+        int y1 = std::max(rect1.y, rect2.y);
+        int x2 = std::min(rect1.x + rect1.width, rect2.x + rect2.width);
+        int y2 = std::min(rect1.y + rect1.height, rect2.y + rect2.height);
+
+        if (x2 < x1 || y2 < y1) return 0.0f;
+
+        int intersection = (x2 - x1) * (y2 - y1);
+        int area1 = rect1.width * rect1.height;
+        int area2 = rect2.width * rect2.height;
+        int unionArea = area1 + area2 - intersection;
+
+        return static_cast<float>(intersection) / static_cast<float>(unionArea);
+    }
+
+    float score(const cv::Rect& track, const cv::Rect& detection) const {
+        return intersectionOverUnion(track, detection);
+    }
+    bool accepts(float score) const { return score > threshold; }
+};
+
+// Center distance, for small or fast targets whose boxes stop overlapping
+// between frames. Scores 1 at the same center, 0 at maxDistance pixels.
+struct CenterDistanceAssociation {
+    float maxDistance;
+
+    CenterDistanceAssociation() : maxDistance(50.0f) {}
+
+    float score(const cv::Rect& track, const cv::Rect& detection) const {
+        float dx = (track.x + track.width * 0.5f) - (detection.x + detection.width * 0.5f);
+        float dy = (track.y + track.height * 0.5f) - (detection.y + detection.height * 0.5f);
+        return 1.0f - std::sqrt(dx * dx + dy * dy) / maxDistance;
+    }
+    bool accepts(float score) const { return score > 0.0f; }
+};
+
+// --- Appearance models: re-identify a lost track from its looks ---
+
+struct NoAppearance {
+    static constexpr bool kEnabled = false;
+    struct State {};
+
+    void update(State&, const cv::Mat&, const cv::Rect&) {}
+    bool observe(const cv::Mat&, const cv::Rect&) { return false; }
+    float similarity(const State&) const { return 0.0f; }
+    bool matches(float) const { return false; }
+};
+
+// HOG descriptor of the box, matched by cosine similarity, as in
+// AdvancedTrackingSystem. observe() extracts a candidate detection's
+// features once; similarity() then compares them against any track.
+class HogAppearance {
+public:
+    static constexpr bool kEnabled = true;
+    struct State {
+        cv::Mat features;
+    };
+
+    float reIdThreshold;
+
+    HogAppearance();
+
+    void update(State& state, const cv::Mat& frame, const cv::Rect& box);
+    // False when the box yields no features (empty or outside the frame)
+    bool observe(const cv::Mat& frame, const cv::Rect& box);
+    float similarity(const State& state) const;
+    bool matches(float similarity) const { return similarity > reIdThreshold; }
+
+private:
+    cv::HOGDescriptor hog_;
+    cv::Mat resized_;
+    cv::Mat gray_;
+    std::vector<float> descriptors_;
+
+    bool extract(const cv::Mat& frame, const cv::Rect& box);
+};
+
+// --- Camera models: global motion applied to detections before matching ---
+
+struct StaticCamera {
+    static constexpr bool kEnabled = false;
+
+    void estimate(const cv::Mat&) {}
+    cv::Point2f offset() const { return cv::Point2f(0, 0); }
+};
+
+// Mean sparse optical flow between consecutive frames, scaled by
+// sensitivity, as in AdvancedTrackingSystem
+class OpticalFlowCamera {
+public:
+    static constexpr bool kEnabled = true;
+
+    float sensitivity;
+
+    OpticalFlowCamera();
+
+    void estimate(const cv::Mat& frame);
+    cv::Point2f offset() const { return motion_; }
+
+private:
+    cv::Mat previousGray_;
+    cv::Mat currentGray_;
+    std::vector<cv::Point2f> previousPoints_;
+    std::vector<cv::Point2f> nextPoints_;
+    std::vector<uchar> status_;
+    std::vector<float> error_;
+    cv::Point2f motion_;
+};
@@ -0,0 +1,401 @@
+#include "TrackerSnapshot.h"
+#include "DetectionCache.h"
+#include <cstring>
+#include <iostream>
+#include <type_traits>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+namespace {
+
+template <typename T>
+void appendPod(std::string& out, const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "appendPod needs a plain value");
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, const std::string& text) {
+    appendPod(out, static_cast<uint32_t>(text.size()));
+    out.append(text);
+}
+
+void appendMat(std::string& out, const cv::Mat& mat) {
+    appendPod(out, static_cast<int32_t>(mat.rows));
+    appendPod(out, static_cast<int32_t>(mat.cols));
+    appendPod(out, static_cast<int32_t>(mat.type()));
+    size_t rowBytes = static_cast<size_t>(mat.cols) * mat.elemSize();
+    for (int row = 0; row < mat.rows; ++row) {
+        out.append(reinterpret_cast<const char*>(mat.ptr(row)), rowBytes);
+    }
+}
+
+void appendRect(std::string& out, const cv::Rect& rect) {
+    appendPod(out, static_cast<int32_t>(rect.x));
+    appendPod(out, static_cast<int32_t>(rect.y));
+    appendPod(out, static_cast<int32_t>(rect.width));
+    appendPod(out, static_cast<int32_t>(rect.height));
+}
+
+void appendPoint(std::string& out, const cv::Point2f& point) {
+    appendPod(out, point.x);
+    appendPod(out, point.y);
+}
+
+void appendKalmanFilter(std::string& out, const cv::KalmanFilter& filter) {
+    appendMat(out, filter.statePre);
+    appendMat(out, filter.statePost);
+    appendMat(out, filter.transitionMatrix);
+    appendMat(out, filter.controlMatrix);
+    appendMat(out, filter.measurementMatrix);
+    appendMat(out, filter.processNoiseCov);
+    appendMat(out, filter.measurementNoiseCov);
+    appendMat(out, filter.errorCovPre);
+    appendMat(out, filter.gain);
+    appendMat(out, filter.errorCovPost);
+}
+
+void appendTrack(std::string& out, const TrackedVehicle& track) {
+    appendPod(out, static_cast<int32_t>(track.id));
+    appendRect(out, track.boundingBox);
+    appendPoint(out, track.velocity);
+    appendPod(out, track.confidence);
+    appendPod(out, static_cast<int32_t>(track.age));
+    appendPod(out, static_cast<int32_t>(track.totalHits));
+    appendPod(out, static_cast<int32_t>(track.consecutiveHits));
+    appendPod(out, static_cast<int32_t>(track.consecutiveMisses));
+    // By name: label ids are only meaningful within one process
+    appendString(out, labelName(track.label));
+    appendPod(out, static_cast<uint8_t>(track.isActive));
+    appendKalmanFilter(out, track.kalmanFilter);
+}
+
+void appendAdvancedTrack(std::string& out, const AdvancedTrackedVehicle& track) {
+    appendTrack(out, track);
+    appendMat(out, track.appearanceFeatures);
+    appendPod(out, static_cast<uint32_t>(track.featureHistory.size()));
+    for (size_t i = 0; i < track.featureHistory.size(); ++i) {
+        appendMat(out, track.featureHistory[i]);
+    }
+    appendPod(out, track.visibilityRatio);
+    appendRect(out, track.estimatedFullBox);
+    appendPod(out, static_cast<uint8_t>(track.isPartiallyOccluded));
+    appendPoint(out, track.predictedPosition);
+    for (const auto& velocity : track.velocityHistory) {
+        appendPoint(out, velocity);
+    }
+    appendPod(out, track.motionConfidence);
+    appendPod(out, static_cast<int32_t>(track.reIdScore));
+    appendString(out, track.uniqueSignature);
+    appendPoint(out, track.cameraMotionOffset);
+}
+
+// Bounds-checked cursor over a payload; every read fails once it runs out
+class PayloadReader {
+public:
+    PayloadReader(const uint8_t* data, size_t size) : data_(data), remaining_(size) {}
+
+    template <typename T>
+    bool read(T& value) {
+        if (remaining_ < sizeof(T)) return false;
+        std::memcpy(&value, data_, sizeof(T));
+        data_ += sizeof(T);
+        remaining_ -= sizeof(T);
+        return true;
+    }
+
+    bool readInt(int& value) {
+        int32_t stored = 0;
+        if (!read(stored)) return false;
+        value = stored;
+        return true;
+    }
+
+    bool readBool(bool& value) {
+        uint8_t stored = 0;
+        if (!read(stored)) return false;
+        value = stored != 0;
+        return true;
+    }
+
+    bool readString(std::string& text) {
+        uint32_t length = 0;
+        if (!read(length) || remaining_ < length) return false;
+        text.assign(reinterpret_cast<const char*>(data_), length);
+        data_ += length;
+        remaining_ -= length;
+        return true;
+    }
+
+    bool readMat(cv::Mat& mat) {
+        int32_t rows = 0, cols = 0, type = 0;
+        if (!read(rows) || !read(cols) || !read(type) || rows < 0 || cols < 0) return false;
+        if (rows == 0 || cols == 0) {
+            mat.release();
+            return true;
+        }
+        // Checked before allocating so a corrupt size can't request gigabytes
+        uint64_t bytes = static_cast<uint64_t>(rows) * cols * CV_ELEM_SIZE(type);
+        if (bytes == 0 || bytes > remaining_) return false;
+        mat.create(rows, cols, type);
+        size_t rowBytes = static_cast<size_t>(cols) * mat.elemSize();
+        for (int row = 0; row < rows; ++row) {
+            std::memcpy(mat.ptr(row), data_, rowBytes);
+            data_ += rowBytes;
+        }
+        remaining_ -= bytes;
+        return true;
+    }
+
+    bool readRect(cv::Rect& rect) {
+        return readInt(rect.x) && readInt(rect.y) && readInt(rect.width) && readInt(rect.height);
+    }
+
+    bool readPoint(cv::Point2f& point) {
+        return read(point.x) && read(point.y);
+    }
+
+    bool atEnd() const { return remaining_ == 0; }
+
+private:
+    const uint8_t* data_;
+    size_t remaining_;
+};
+
+bool readKalmanFilter(PayloadReader& in, cv::KalmanFilter& filter) {
+    return in.readMat(filter.statePre) && in.readMat(filter.statePost) &&
+           in.readMat(filter.transitionMatrix) && in.readMat(filter.controlMatrix) &&
+           in.readMat(filter.measurementMatrix) && in.readMat(filter.processNoiseCov) &&
+           in.readMat(filter.measurementNoiseCov) && in.readMat(filter.errorCovPre) &&
+           in.readMat(filter.gain) && in.readMat(filter.errorCovPost);
+}
+
+bool readTrack(PayloadReader& in, TrackedVehicle& track) {
+    std::string label;
+    if (!in.readInt(track.id) || !in.readRect(track.boundingBox) || !in.readPoint(track.velocity) ||
+        !in.read(track.confidence) || !in.readInt(track.age) || !in.readInt(track.totalHits) ||
+        !in.readInt(track.consecutiveHits) || !in.readInt(track.consecutiveMisses) ||
+        !in.readString(label)) {
+        return false;
+    }
+    track.label = internLabel(label);
+    return in.readBool(track.isActive) && readKalmanFilter(in, track.kalmanFilter);
+}
+
+bool readAdvancedTrack(PayloadReader& in, AdvancedTrackedVehicle& track) {
+    uint32_t historySize = 0;
+    if (!readTrack(in, track) || !in.readMat(track.appearanceFeatures) || !in.read(historySize)) {
+        return false;
+    }
+    track.featureHistory.clear();
+    for (uint32_t i = 0; i < historySize; ++i) {
+        cv::Mat features;
+        if (!in.readMat(features)) return false;
+        track.featureHistory.push(features);
+    }
+    if (!in.read(track.visibilityRatio) || !in.readRect(track.estimatedFullBox) ||
+        !in.readBool(track.isPartiallyOccluded) || !in.readPoint(track.predictedPosition)) {
+        return false;
+    }
+    for (auto& velocity : track.velocityHistory) {
+        if (!in.readPoint(velocity)) return false;
+    }
+    return in.read(track.motionConfidence) && in.readInt(track.reIdScore) &&
+           in.readString(track.uniqueSignature) && in.readPoint(track.cameraMotionOffset);
+}
+
+// Indexes intact records and returns the offset just past the last one;
+// false when the file is not a snapshot file for videoHash
+bool scanRecords(FILE* file, uint64_t videoHash, std::vector<TrackerSnapshotReader::Record>& records,
+                 long& validEnd) {
+    records.clear();
+    TrackerSnapshotFileHeader header;
+    if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+        header.magic != kTrackerSnapshotMagic || header.version != kTrackerSnapshotVersion ||
+        (videoHash != 0 && header.videoHash != videoHash)) {
+        return false;
+    }
+    validEnd = static_cast<long>(sizeof(header));
+
+    TrackerSnapshotRecordHeader record;
+    std::string payload;
+    while (std::fread(&record, sizeof(record), 1, file) == 1) {
+        if (record.magic != kTrackerSnapshotRecordMagic || record.payloadBytes > (1ull << 32)) break;
+        payload.resize(record.payloadBytes);
+        if (std::fread(&payload[0], 1, payload.size(), file) != payload.size()) break;
+        if (DetectionCache::hashString(payload) != record.checksum) break;
+
+        records.push_back({record.frameIndex, static_cast<uint64_t>(validEnd) + sizeof(record),
+                           record.payloadBytes});
+        validEnd += static_cast<long>(sizeof(record) + record.payloadBytes);
+    }
+    return true;
+}
+
+} // namespace
+
+std::string serializeTrackingState(const TrackingState& state) {
+    std::string out;
+    appendPod(out, static_cast<int32_t>(state.nextId));
+    appendPod(out, static_cast<int32_t>(state.primaryTargetId));
+    appendPoint(out, state.globalCameraMotion);
+    appendPod(out, state.reIdHits);
+    appendPod(out, static_cast<uint32_t>(state.tracks.size()));
+    for (const auto& track : state.tracks) {
+        appendTrack(out, track);
+    }
+    appendPod(out, static_cast<uint32_t>(state.advancedTracks.size()));
+    for (const auto& track : state.advancedTracks) {
+        appendAdvancedTrack(out, track);
+    }
+    return out;
+}
+
+bool deserializeTrackingState(const uint8_t* data, size_t size, TrackingState& state) {
+    PayloadReader in(data, size);
+    state = TrackingState();
+
+    uint32_t count = 0;
+    if (!in.readInt(state.nextId) || !in.readInt(state.primaryTargetId) ||
+        !in.readPoint(state.globalCameraMotion) || !in.read(state.reIdHits) || !in.read(count)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        state.tracks.emplace_back();
+        if (!readTrack(in, state.tracks.back())) return false;
+    }
+    if (!in.read(count)) return false;
+    for (uint32_t i = 0; i < count; ++i) {
+        state.advancedTracks.emplace_back();
+        if (!readAdvancedTrack(in, state.advancedTracks.back())) return false;
+    }
+    return in.atEnd();
+}
+
+TrackerSnapshotWriter::TrackerSnapshotWriter()
+    : file_(nullptr) {
+}
+
+TrackerSnapshotWriter::~TrackerSnapshotWriter() {
+    close();
+}
+
+bool TrackerSnapshotWriter::open(const std::string& path, uint64_t videoHash, bool append) {
+    close();
+
+    long validEnd = 0;
+    FILE* existing = append ? std::fopen(path.c_str(), "rb") : nullptr;
+    if (existing) {
+        std::vector<TrackerSnapshotReader::Record> records;
+        if (!scanRecords(existing, videoHash, records, validEnd)) {
+            validEnd = 0;
+        }
+        std::fclose(existing);
+    }
+
+    if (validEnd > 0) {
+#ifndef _WIN32
+        // Drop a record torn by the crash we may be resuming from
+        if (truncate(path.c_str(), validEnd) != 0) {
+            std::cerr << "Error: Could not trim snapshot file: " << path << std::endl;
+            return false;
+        }
+#endif
+        file_ = std::fopen(path.c_str(), "ab");
+    } else {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (file_) {
+            TrackerSnapshotFileHeader header = {kTrackerSnapshotMagic, kTrackerSnapshotVersion, videoHash};
+            std::fwrite(&header, sizeof(header), 1, file_);
+        }
+    }
+
+    if (!file_) {
+        std::cerr << "Error: Could not open snapshot file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool TrackerSnapshotWriter::write(int frameIndex, const TrackingState& state) {
+    if (!file_) return false;
+
+    std::string payload = serializeTrackingState(state);
+    TrackerSnapshotRecordHeader header = {kTrackerSnapshotRecordMagic, frameIndex,
+                                          payload.size(), DetectionCache::hashString(payload)};
+    if (std::fwrite(&header, sizeof(header), 1, file_) != 1 ||
+        std::fwrite(payload.data(), 1, payload.size(), file_) != payload.size() ||
+        std::fflush(file_) != 0) {
+        std::cerr << "Error: Tracker snapshot write failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void TrackerSnapshotWriter::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+bool TrackerSnapshotWriter::isOpen() const {
+    return file_ != nullptr;
+}
+
+TrackerSnapshotReader::TrackerSnapshotReader()
+    : file_(nullptr) {
+}
+
+TrackerSnapshotReader::~TrackerSnapshotReader() {
+    close();
+}
+
+bool TrackerSnapshotReader::open(const std::string& path, uint64_t videoHash) {
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        return false;
+    }
+    long validEnd = 0;
+    if (!scanRecords(file_, videoHash, records_, validEnd)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TrackerSnapshotReader::close() {
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    records_.clear();
+}
+
+const std::vector<TrackerSnapshotReader::Record>& TrackerSnapshotReader::getRecords() const {
+    return records_;
+}
+
+bool TrackerSnapshotReader::load(const Record& record, TrackingState& state) const {
+    if (!file_) return false;
+    std::vector<uint8_t> payload(record.payloadBytes);
+    if (std::fseek(file_, static_cast<long>(record.offset), SEEK_SET) != 0 ||
+        std::fread(payload.data(), 1, payload.size(), file_) != payload.size()) {
+        return false;
+    }
+    return deserializeTrackingState(payload.data(), payload.size(), state);
+}
+
+bool TrackerSnapshotReader::loadLatest(int frameIndex, int& snapshotFrame, TrackingState& state) const {
+    // Records are appended in processing order, which is frame order
+    for (auto it = records_.rbegin(); it != records_.rend(); ++it) {
+        if (frameIndex >= 0 && it->frameIndex > frameIndex) continue;
+        if (load(*it, state)) {
+            snapshotFrame = it->frameIndex;
+            return true;
+        }
+    }
+    return false;
+}
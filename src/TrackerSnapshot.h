@@ -0,0 +1,87 @@
+#pragma once
+
+#include "AdvancedTrackingSystem.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Periodic binary snapshots of the tracker state, appended to a side file
+// so a killed job can resume from the last one and the controller can seek
+// without replaying from frame 0.
+//
+// File layout:
+//   [TrackerSnapshotFileHeader][record][record]...
+//   record = [TrackerSnapshotRecordHeader][payload]
+//
+// The payload holds every track (box, Kalman matrices, appearance history),
+// nextId, the primary target and camera motion. The previous video frame is
+// left out to keep snapshots small; after a restore, camera motion
+// estimation starts again on the next frame. A record cut short by a crash
+// fails its size or checksum and is dropped, along with anything after it.
+constexpr uint32_t kTrackerSnapshotMagic = 0x53544343;        // "CCTS"
+constexpr uint32_t kTrackerSnapshotRecordMagic = 0x50414E53;  // "SNAP"
+constexpr uint32_t kTrackerSnapshotVersion = 1;
+
+struct TrackerSnapshotFileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t videoHash;  // DetectionCache::fingerprintFile of the source
+};
+
+struct TrackerSnapshotRecordHeader {
+    uint32_t magic;
+    int32_t frameIndex;   // State after this frame (0-based)
+    uint64_t payloadBytes;
+    uint64_t checksum;    // FNV-1a of the payload
+};
+
+static_assert(sizeof(TrackerSnapshotFileHeader) == 16, "tracker snapshot header layout changed");
+static_assert(sizeof(TrackerSnapshotRecordHeader) == 24, "tracker snapshot record layout changed");
+
+std::string serializeTrackingState(const TrackingState& state);
+bool deserializeTrackingState(const uint8_t* data, size_t size, TrackingState& state);
+
+class TrackerSnapshotWriter {
+public:
+    TrackerSnapshotWriter();
+    ~TrackerSnapshotWriter();
+
+    // With append, continues after the last intact record of an existing
+    // file for the same video (resuming); otherwise starts the file fresh
+    bool open(const std::string& path, uint64_t videoHash, bool append);
+    // Flushed before returning, so a killed process loses at most the
+    // snapshot being written
+    bool write(int frameIndex, const TrackingState& state);
+    void close();
+    bool isOpen() const;
+
+private:
+    FILE* file_;
+};
+
+class TrackerSnapshotReader {
+public:
+    struct Record {
+        int frameIndex;
+        uint64_t offset;  // Of the payload
+        uint64_t payloadBytes;
+    };
+
+    TrackerSnapshotReader();
+    ~TrackerSnapshotReader();
+
+    // Indexes intact records; fails on a missing file or a different video.
+    // A videoHash of 0 accepts any video.
+    bool open(const std::string& path, uint64_t videoHash = 0);
+    void close();
+
+    const std::vector<Record>& getRecords() const;
+    bool load(const Record& record, TrackingState& state) const;
+    // Latest snapshot at or before frameIndex (any frame when negative)
+    bool loadLatest(int frameIndex, int& snapshotFrame, TrackingState& state) const;
+
+private:
+    FILE* file_;
+    std::vector<Record> records_;
+};
@@ -1,9 +1,13 @@
 #include "TrackingController.h"
+#include "TrackerSnapshot.h"
+#include "DetectionCache.h"
 #include <iostream>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
 #include <cstdlib>
+#include <algorithm>
+#include <cmath>
 
 #ifdef __APPLE__
 #include <CoreFoundation/CoreFoundation.h>
@@ -13,19 +17,40 @@
 #include <gtk/gtk.h>
 #endif
 
+namespace {
+
+// Replaying further than this to reach a seek target costs more than it is
+// worth; tracking restarts shortly before the target instead
+constexpr int kMaxReplayFrames = 300;
+// Frames tracked ahead of the target on such a restart so tracks are confirmed
+constexpr int kColdStartFrames = 30;
+// Frames decoded and tracked ahead of the display during playback
+constexpr size_t kPrefetchFrames = 8;
+// Longest the UI thread blocks in waitKey, so keys and trackbars stay responsive
+constexpr int kMaxUiWaitMs = 15;
+// While paused nothing is due; waitKey still returns as soon as an event arrives
+constexpr int kIdleUiWaitMs = 100;
+// Span of recent frames the FPS readout averages over
+constexpr std::chrono::seconds kStatsWindow(2);
+
+} // namespace
+
 TrackingController::TrackingController() 
-    : isPlaying_(false), isPaused_(false), isAdvancedMode_(true),
+    : decoderPosition_(0), trackedFrame_(-1), isPlaying_(false), isPaused_(false), isAdvancedMode_(true),
       showDebugInfo_(true), enableRecording_(false), targetSelectionMode_(false),
       partialOcclusionEnabled_(true), reIdEnabled_(true), cameraCompensationEnabled_(true),
       detectionThreshold_(0.5f), occlusionThreshold_(0.3f), reIdThreshold_(0.7f),
       cameraSensitivity_(0.1f), playbackSpeed_(1.0), currentFrame_(0), totalFrames_(0),
-      fps_(0.0), processingTime_(0.0), vehiclesDetected_(0),
+      fps_(0.0), processingTime_(0.0), vehiclesDetected_(0), sourceFps_(30.0),
+      nextPrefetch_(0), prefetchGeneration_(0), prefetchStopping_(false), prefetchEnded_(false),
+      droppedFrames_(0),
       mainWindowName_("Car Chase Tracker"), controlWindowName_("Controls") {
     
     tracker_ = std::make_unique<AdvancedCarTracker>();
 }
 
 TrackingController::~TrackingController() {
+    stopPrefetch();
     cv::destroyAllWindows();
 }
 
@@ -46,41 +71,65 @@ bool TrackingController::initialize() {
     return true;
 }
 
+// The calling thread is the UI thread: HighGUI must stay on it (on macOS it
+// must be the main thread). Decoding and tracking run ahead on the prefetch
+// thread; this loop only shows each frame at its deadline and pumps events.
 void TrackingController::run() {
     if (!isPlaying_) return;
     
-    cv::Mat frame;
-    auto lastTime = std::chrono::high_resolution_clock::now();
+    startPrefetch();
     
     while (isPlaying_) {
+        int waitMs = isPaused_ ? kIdleUiWaitMs : kMaxUiWaitMs;
         if (!isPaused_) {
-            videoCapture_ >> frame;
-            if (frame.empty()) {
+            PrefetchedFrame due;
+            bool show = false;
+            bool ended = false;
+            {
+                std::lock_guard<std::mutex> lock(queueMutex_);
+                auto now = PlaybackClock::Clock::now();
+                // A frame whose successor is already due would only be shown late
+                while (prefetched_.size() >= 2 &&
+                       playbackClock_.deadlineFor(prefetched_[1].timestampMs / 1000.0) <= now) {
+                    prefetched_.pop_front();
+                    ++droppedFrames_;
+                }
+                if (!prefetched_.empty()) {
+                    auto deadline = playbackClock_.deadlineFor(prefetched_.front().timestampMs / 1000.0);
+                    if (deadline <= now) {
+                        due = std::move(prefetched_.front());
+                        prefetched_.pop_front();
+                        show = true;
+                    } else {
+                        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now);
+                        waitMs = static_cast<int>(std::max<long long>(1, std::min<long long>(remaining.count(), kMaxUiWaitMs)));
+                    }
+                } else {
+                    ended = prefetchEnded_;
+                }
+            }
+            queueCv_.notify_all();
+            
+            if (show) {
+                currentFrame_ = due.frameIndex + 1;
+                processingTime_ = due.processingMs;
+                cv::imshow(mainWindowName_, due.frame);
+                if (enableRecording_ && videoWriter_.isOpened()) {
+                    videoWriter_.write(due.frame);
+                }
+                updateStatistics();
+            } else if (ended) {
                 std::cout << "End of video reached." << std::endl;
                 stop();
                 break;
             }
-            
-            currentFrame_++;
-            
-            // Process frame
-            auto startTime = std::chrono::high_resolution_clock::now();
-            processFrame();
-            auto endTime = std::chrono::high_resolution_clock::now();
-            
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
-            processingTime_ = duration.count();
-            
-            // Update display
-            updateDisplay();
-            updateStatistics();
         }
         
         // Update GUI
         updateGUI();
         
-        // Handle key events
-        char key = cv::waitKey(static_cast<int>(30 / playbackSpeed_));
+        // Handle key events; waitKey also runs trackbar and mouse callbacks
+        char key = cv::waitKey(waitMs);
         handleKeyPress(key);
         
         // Check for window close
@@ -88,6 +137,90 @@ void TrackingController::run() {
             break;
         }
     }
+    
+    stopPrefetch();
+    if (droppedFrames_ > 0) {
+        std::cout << "Playback dropped " << droppedFrames_ << " late frames" << std::endl;
+    }
+}
+
+void TrackingController::startPrefetch() {
+    stopPrefetch();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        prefetchStopping_ = false;
+        droppedFrames_ = 0;
+    }
+    restartPlayback();
+    prefetchThread_ = std::thread(&TrackingController::prefetchLoop, this);
+}
+
+void TrackingController::stopPrefetch() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        prefetchStopping_ = true;
+    }
+    queueCv_.notify_all();
+    if (prefetchThread_.joinable()) {
+        prefetchThread_.join();
+    }
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    prefetched_.clear();
+}
+
+// Drops prefetched frames and continues from the displayed position; after a
+// step, seek, parameter change or resume
+void TrackingController::restartPlayback() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        prefetched_.clear();
+        ++prefetchGeneration_;
+        prefetchEnded_ = false;
+        nextPrefetch_ = currentFrame_;
+        playbackClock_.setSpeed(playbackSpeed_);
+        playbackClock_.start(currentFrame_ / sourceFps_);
+        if (isPaused_) {
+            playbackClock_.pause();
+        }
+    }
+    queueCv_.notify_all();
+}
+
+void TrackingController::prefetchLoop() {
+    std::unique_lock<std::mutex> lock(queueMutex_);
+    while (true) {
+        queueCv_.wait(lock, [this] {
+            return prefetchStopping_ || (!prefetchEnded_ && prefetched_.size() < kPrefetchFrames);
+        });
+        if (prefetchStopping_) break;
+        
+        // Behind the clock: jump to the frame due now instead of queueing late ones
+        int dueFrame = static_cast<int>(std::floor(playbackClock_.getMediaTime() * sourceFps_));
+        int frameIndex = std::max(nextPrefetch_, dueFrame);
+        uint64_t generation = prefetchGeneration_;
+        lock.unlock();
+        
+        PrefetchedFrame prefetched;
+        prefetched.frameIndex = frameIndex;
+        auto startTime = std::chrono::steady_clock::now();
+        bool rendered;
+        {
+            std::lock_guard<std::mutex> pipeline(pipelineMutex_);
+            rendered = renderFrame(frameIndex, prefetched.frame, prefetched.timestampMs, true);
+        }
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+        prefetched.processingMs = elapsed.count();
+        
+        lock.lock();
+        // A seek or parameter change came in while this frame was processed
+        if (generation != prefetchGeneration_) continue;
+        if (!rendered) {
+            prefetchEnded_ = true;
+        } else {
+            prefetched_.push_back(std::move(prefetched));
+            nextPrefetch_ = frameIndex + 1;
+        }
+    }
 }
 
 void TrackingController::createControlWindow() {
@@ -95,10 +228,8 @@ void TrackingController::createControlWindow() {
     cv::namedWindow(controlWindowName_, cv::WINDOW_AUTOSIZE);
     
     // Create control panel
-    controlPanel_ = cv::Mat::zeros(400, 300, CV_8UC3);
     drawControlPanel();
-    
-    cv::imshow(controlWindowName_, controlPanel_);
+    updateGUI();
 }
 
 void TrackingController::createTrackbarWindow() {
@@ -136,114 +267,270 @@ void TrackingController::createTrackbarWindow() {
     cv::setTrackbarPos("Camera Sensitivity", "Parameters", static_cast<int>(cameraSensitivity_ * 100));
 }
 
+// Static text is rasterized once into panelBackground_; the value lines are
+// drawn over it by updateGUI
 void TrackingController::drawControlPanel() {
-    controlPanel_ = cv::Scalar(50, 50, 50);
+    panelBackground_ = cv::Mat(400, 300, CV_8UC3, cv::Scalar(50, 50, 50));
     
     // Title
-    cv::putText(controlPanel_, "Car Chase Tracker", cv::Point(10, 30), 
+    cv::putText(panelBackground_, "Car Chase Tracker", cv::Point(10, 30), 
                cv::FONT_HERSHEY_SIMPLEX, 0.8, cv::Scalar(255, 255, 255), 2);
     
-    // Playback controls
-    cv::putText(controlPanel_, "Playback Controls:", cv::Point(10, 70), 
+    // Section headers
+    cv::putText(panelBackground_, "Playback Controls:", cv::Point(10, 70), 
                cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 0), 1);
-    
-    std::string playStatus = isPlaying_ ? (isPaused_ ? "PAUSED" : "PLAYING") : "STOPPED";
-    cv::putText(controlPanel_, "Status: " + playStatus, cv::Point(10, 95), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 0), 1);
-    
-    // Tracking mode
-    std::string modeText = isAdvancedMode_ ? "Advanced Mode" : "Basic Mode";
-    cv::putText(controlPanel_, "Mode: " + modeText, cv::Point(10, 120), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 255, 255), 1);
-    
-    // Features status
-    cv::putText(controlPanel_, "Features:", cv::Point(10, 150), 
+    cv::putText(panelBackground_, "Features:", cv::Point(10, 150), 
+               cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 0), 1);
+    cv::putText(panelBackground_, "Statistics:", cv::Point(10, 250), 
                cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 0), 1);
     
-    cv::putText(controlPanel_, "Occlusion: " + std::string(partialOcclusionEnabled_ ? "ON" : "OFF"), 
-               cv::Point(10, 175), cv::FONT_HERSHEY_SIMPLEX, 0.4, 
-               partialOcclusionEnabled_ ? cv::Scalar(0, 255, 0) : cv::Scalar(0, 0, 255), 1);
+    // Instructions
+    cv::putText(panelBackground_, "Controls:", cv::Point(10, 350), 
+               cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
+    cv::putText(panelBackground_, "SPACE: Play/Pause", cv::Point(10, 370), 
+               cv::FONT_HERSHEY_SIMPLEX, 0.3, cv::Scalar(200, 200, 200), 1);
+    cv::putText(panelBackground_, "T: Toggle Mode", cv::Point(10, 385), 
+               cv::FONT_HERSHEY_SIMPLEX, 0.3, cv::Scalar(200, 200, 200), 1);
     
-    cv::putText(controlPanel_, "Re-ID: " + std::string(reIdEnabled_ ? "ON" : "OFF"), 
-               cv::Point(10, 195), cv::FONT_HERSHEY_SIMPLEX, 0.4, 
-               reIdEnabled_ ? cv::Scalar(0, 255, 0) : cv::Scalar(0, 0, 255), 1);
+    controlPanel_ = panelBackground_.clone();
+    panelLines_.assign(kPanelLineCount, std::string());
+}
+
+// Redraws one value line: restores its strip of the background, then the text
+void TrackingController::drawPanelLine(int line, const std::string& text, const cv::Scalar& color) {
+    static const struct {
+        int baseline;
+        double scale;
+    } layout[kPanelLineCount] = {
+        {95, 0.5}, {120, 0.5},               // Status, mode
+        {175, 0.4}, {195, 0.4}, {215, 0.4},  // Features
+        {275, 0.4}, {295, 0.4}, {315, 0.4},  // Statistics
+    };
+    
+    int top = layout[line].baseline - 16;
+    cv::Rect strip(0, top, controlPanel_.cols, 20);
+    panelBackground_(strip).copyTo(controlPanel_(strip));
+
+    cv::putText(controlPanel_, text, cv::Point(10, layout[line].baseline),
+               cv::FONT_HERSHEY_SIMPLEX, layout[line].scale, color, 1);
+    panelLines_[line] = text;
+}
+
+// Called every loop iteration; touches pixels and the window only for the
+// lines whose text changed, so an idle or paused controller costs nothing
+void TrackingController::updateGUI() {
+    if (controlPanel_.empty()) return;
+    
+    const cv::Scalar white(255, 255, 255);
+    const cv::Scalar on(0, 255, 0);
+    const cv::Scalar off(0, 0, 255);
+    std::string lines[kPanelLineCount];
+    cv::Scalar colors[kPanelLineCount] = {
+        on, cv::Scalar(0, 255, 255),
+        partialOcclusionEnabled_ ? on : off, reIdEnabled_ ? on : off, cameraCompensationEnabled_ ? on : off,
+        white, white, white,
+    };
+    lines[kStatusLine] = std::string("Status: ") + (isPlaying_ ? (isPaused_ ? "PAUSED" : "PLAYING") : "STOPPED");
+    lines[kModeLine] = std::string("Mode: ") + (isAdvancedMode_ ? "Advanced Mode" : "Basic Mode");
+    lines[kOcclusionLine] = std::string("Occlusion: ") + (partialOcclusionEnabled_ ? "ON" : "OFF");
+    lines[kReIdLine] = std::string("Re-ID: ") + (reIdEnabled_ ? "ON" : "OFF");
+    lines[kCameraLine] = std::string("Camera Comp: ") + (cameraCompensationEnabled_ ? "ON" : "OFF");
+    lines[kFrameLine] = "Frame: " + std::to_string(currentFrame_) + "/" + std::to_string(totalFrames_);
+    std::stringstream ss;
+    ss << "FPS: " << std::fixed << std::setprecision(1) << fps_;
+    lines[kFpsLine] = ss.str();
+    lines[kVehiclesLine] = "Vehicles: " + std::to_string(vehiclesDetected_);
+    
+    bool dirty = false;
+    for (int i = 0; i < kPanelLineCount; ++i) {
+        if (lines[i] != panelLines_[i]) {
+            drawPanelLine(i, lines[i], colors[i]);
+            dirty = true;
+        }
+    }
+    if (dirty) {
+        cv::imshow(controlWindowName_, controlPanel_);
+    }
+}
+
+// Shows currentFrame_ right away, for steps and seeks
+bool TrackingController::processFrame() {
+    if (!tracker_ || currentFrame_ <= 0) return false;
     
-    cv::putText(controlPanel_, "Camera Comp: " + std::string(cameraCompensationEnabled_ ? "ON" : "OFF"), 
-               cv::Point(10, 215), cv::FONT_HERSHEY_SIMPLEX, 0.4, 
-               cameraCompensationEnabled_ ? cv::Scalar(0, 255, 0) : cv::Scalar(0, 0, 255), 1);
+    cv::Mat frame;
+    double timestampMs = 0.0;
+    bool rendered;
+    {
+        std::lock_guard<std::mutex> pipeline(pipelineMutex_);
+        rendered = renderFrame(currentFrame_ - 1, frame, timestampMs, false);
+    }
+    if (prefetchThread_.joinable()) {
+        restartPlayback();
+    }
+    if (!rendered) {
+        return false;
+    }
     
-    // Statistics
-    cv::putText(controlPanel_, "Statistics:", cv::Point(10, 250), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(255, 255, 0), 1);
+    // Update display
+    cv::imshow(mainWindowName_, frame);
     
-    std::stringstream ss;
-    ss << "Frame: " << currentFrame_ << "/" << totalFrames_;
-    cv::putText(controlPanel_, ss.str(), cv::Point(10, 275), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(255, 255, 255), 1);
+    // Save if recording
+    if (enableRecording_ && videoWriter_.isOpened()) {
+        videoWriter_.write(frame);
+    }
+    return true;
+}
+
+// Caller holds pipelineMutex_. With allowGap, playback that fell behind
+// tracks frameIndex straight on top of an earlier frame's state instead of
+// replaying the frames in between.
+bool TrackingController::renderFrame(int frameIndex, cv::Mat& output, double& timestampMs, bool allowGap) {
+    if (const FrameCache::Entry* cached = frameCache_.find(frameIndex)) {
+        output = cached->frame;
+        timestampMs = cached->timestampMs;
+        return true;
+    }
+    bool skipAhead = allowGap && trackedFrame_ < frameIndex - 1 &&
+                     frameIndex - trackedFrame_ <= kMaxReplayFrames &&
+                     !frameCache_.findState(frameIndex - 1);
+    if (!skipAhead && !seekTracker(frameIndex - 1)) {
+        return false;
+    }
+    return trackFrame(frameIndex, output, timestampMs);
+}
+
+// Tracks frameIndex on top of the tracker's current state
+bool TrackingController::trackFrame(int frameIndex, cv::Mat& output, double& timestampMs) {
+    cv::Mat frame;
+    if (!decodeFrame(frameIndex, frame, timestampMs)) {
+        return false;
+    }
     
-    ss.str("");
-    ss << "FPS: " << std::fixed << std::setprecision(1) << fps_;
-    cv::putText(controlPanel_, ss.str(), cv::Point(10, 295), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(255, 255, 255), 1);
+    // Draws the tracks into frame
+    tracker_->processFrame(frame, frameIndex);
+    trackedFrame_ = frameIndex;
+    frameCache_.insert(frameIndex, frame, timestampMs,
+                       std::make_shared<const TrackingState>(tracker_->saveTrackingState()));
+    output = frame;
+    return true;
+}
+
+bool TrackingController::decodeFrame(int frameIndex, cv::Mat& frame, double& timestampMs) {
+    if (frameIndex != decoderPosition_) {
+        // Without a keyframe in between, a seek would decode the same frames
+        // again from the previous keyframe; just skip ahead
+        bool sameGroup = frameIndex > decoderPosition_ &&
+                         keyframeIndex_.keyframeAtOrBefore(frameIndex) <= decoderPosition_;
+        if (sameGroup) {
+            while (decoderPosition_ < frameIndex) {
+                if (!videoCapture_.grab()) return false;
+                ++decoderPosition_;
+            }
+        } else {
+            videoCapture_.set(cv::CAP_PROP_POS_FRAMES, frameIndex);
+            decoderPosition_ = frameIndex;
+        }
+    }
     
-    ss.str("");
-    ss << "Vehicles: " << vehiclesDetected_;
-    cv::putText(controlPanel_, ss.str(), cv::Point(10, 315), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.4, cv::Scalar(255, 255, 255), 1);
+    if (!videoCapture_.read(frame) || frame.empty()) {
+        return false;
+    }
+    ++decoderPosition_;
     
-    // Instructions
-    cv::putText(controlPanel_, "Controls:", cv::Point(10, 350), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
-    cv::putText(controlPanel_, "SPACE: Play/Pause", cv::Point(10, 370), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.3, cv::Scalar(200, 200, 200), 1);
-    cv::putText(controlPanel_, "T: Toggle Mode", cv::Point(10, 385), 
-               cv::FONT_HERSHEY_SIMPLEX, 0.3, cv::Scalar(200, 200, 200), 1);
+    // Presentation time of the frame just read; some backends only report 0
+    timestampMs = videoCapture_.get(cv::CAP_PROP_POS_MSEC);
+    if (timestampMs <= 0.0 && frameIndex > 0) {
+        timestampMs = frameIndex * 1000.0 / sourceFps_;
+    }
+    return true;
 }
 
-void TrackingController::updateGUI() {
-    drawControlPanel();
-    cv::imshow(controlWindowName_, controlPanel_);
+// Leaves the tracker holding the state after frameIndex; -1 means no frames
+bool TrackingController::seekTracker(int frameIndex) {
+    if (trackedFrame_ == frameIndex) return true;
+    
+    std::shared_ptr<const TrackingState> state =
+        frameIndex >= 0 ? frameCache_.findState(frameIndex) : std::make_shared<const TrackingState>();
+    if (state) {
+        tracker_->restoreTrackingState(*state);
+        trackedFrame_ = frameIndex;
+        return true;
+    }
+    
+    // Tracking is sequential: replay from the nearest earlier checkpoint, or
+    // carry on from the tracker's current frame if that is closer
+    int start = -1;
+    state = frameCache_.findCheckpoint(frameIndex, start);
+    if (!state) {
+        state = std::make_shared<const TrackingState>();
+    }
+    if (trackedFrame_ < frameIndex && trackedFrame_ >= start) {
+        start = trackedFrame_;
+        state.reset();
+    }
+    if (frameIndex - start > kMaxReplayFrames) {
+        // Restart from an empty state at a keyframe, so the decoder seek is cheap.
+        // Track IDs differ from an uninterrupted run.
+        start = keyframeIndex_.keyframeAtOrBefore(std::max(0, frameIndex - kColdStartFrames)) - 1;
+        state = std::make_shared<const TrackingState>();
+    }
+    if (state) {
+        tracker_->restoreTrackingState(*state);
+    }
+    trackedFrame_ = start;
+    
+    cv::Mat output;
+    double timestampMs = 0.0;
+    for (int i = start + 1; i <= frameIndex; ++i) {
+        if (!trackFrame(i, output, timestampMs)) return false;
+    }
+    return true;
 }
 
-void TrackingController::processFrame() {
+// Applies a parameter or target change between prefetched frames. Results up
+// to the displayed frame stay; later ones are recomputed from its state,
+// which the change may also edit (target selection).
+void TrackingController::changeTracking(const std::function<void()>& change) {
     if (!tracker_) return;
     
-    // Get current frame from video capture
-    cv::Mat frame;
-    videoCapture_.set(cv::CAP_PROP_POS_FRAMES, currentFrame_ - 1);
-    videoCapture_ >> frame;
+    std::lock_guard<std::mutex> pipeline(pipelineMutex_);
+    bool positioned = videoCapture_.isOpened() && currentFrame_ > 0;
+    int displayed = currentFrame_ - 1;
+    if (positioned) {
+        seekTracker(displayed);
+        frameCache_.eraseAfter(displayed);
+    }
     
-    if (!frame.empty()) {
-        // Process with tracker
-        tracker_->processFrame(frame);
-        
-        // Update display
-        cv::imshow(mainWindowName_, frame);
-        
-        // Save if recording
-        if (enableRecording_ && videoWriter_.isOpened()) {
-            videoWriter_.write(frame);
+    change();
+    
+    if (positioned) {
+        if (const FrameCache::Entry* cached = frameCache_.find(displayed)) {
+            cv::Mat frame = cached->frame;
+            double timestampMs = cached->timestampMs;
+            frameCache_.insert(displayed, frame, timestampMs,
+                               std::make_shared<const TrackingState>(tracker_->saveTrackingState()));
         }
     }
+    if (prefetchThread_.joinable()) {
+        restartPlayback();
+    }
 }
 
 void TrackingController::updateDisplay() {
     // Display is handled in processFrame
 }
 
+// Display rate over the frames shown in the last kStatsWindow
 void TrackingController::updateStatistics() {
-    // Calculate FPS
-    static auto lastFpsTime = std::chrono::high_resolution_clock::now();
-    static int frameCount = 0;
-    
-    frameCount++;
-    auto currentTime = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - lastFpsTime);
+    auto now = std::chrono::steady_clock::now();
+    shownFrameTimes_.push_back(now);
+    while (now - shownFrameTimes_.front() > kStatsWindow) {
+        shownFrameTimes_.pop_front();
+    }
     
-    if (duration.count() >= 1000) {
-        fps_ = frameCount * 1000.0 / duration.count();
-        frameCount = 0;
-        lastFpsTime = currentTime;
+    if (shownFrameTimes_.size() >= 2) {
+        std::chrono::duration<double> span = now - shownFrameTimes_.front();
+        fps_ = (shownFrameTimes_.size() - 1) / span.count();
     }
 }
 
@@ -286,6 +573,28 @@ void TrackingController::handleKeyPress(char key) {
         case 'V':
             toggleRecording();
             break;
+        case ',':
+            stepBackward();
+            break;
+        case '.':
+            stepForward();
+            break;
+        case '[':
+        case ']': {
+            // Jump five seconds
+            int jump = static_cast<int>(5.0 * sourceFps_);
+            seekToFrame(currentFrame_ + (key == '[' ? -jump : jump));
+            break;
+        }
+        case '+':
+        case '=':
+            setPlaybackSpeed(std::min(playbackSpeed_ * 2.0, 16.0));
+            std::cout << "Playback speed: " << playbackSpeed_ << "x" << std::endl;
+            break;
+        case '-':
+            setPlaybackSpeed(std::max(playbackSpeed_ / 2.0, 0.125));
+            std::cout << "Playback speed: " << playbackSpeed_ << "x" << std::endl;
+            break;
         case 27: // ESC
             stop();
             break;
@@ -301,10 +610,31 @@ void TrackingController::loadVideo(const std::string& videoPath) {
     }
     
     totalFrames_ = static_cast<int>(videoCapture_.get(cv::CAP_PROP_FRAME_COUNT));
+    sourceFps_ = videoCapture_.get(cv::CAP_PROP_FPS);
+    if (sourceFps_ <= 0.0) {
+        sourceFps_ = 30.0;
+    }
     currentFrame_ = 0;
+    decoderPosition_ = 0;
+    trackedFrame_ = -1;
+    frameCache_.clear();
+    
+    // The container's frame count is an estimate for many formats
+    if (keyframeIndex_.build(videoPath)) {
+        totalFrames_ = keyframeIndex_.getFrameCount();
+        std::cout << "Keyframes: " << keyframeIndex_.getKeyframeCount() << std::endl;
+    }
+    if (!snapshotPath_.empty()) {
+        loadSnapshots(videoPath);
+    }
     
     // Initialize tracker with video
     tracker_->initialize(videoPath);
+    tracker_->setDetectionThreshold(detectionThreshold_);
+    if (!detectionCacheDir_.empty()) {
+        // Threshold changes then replay cached detections instead of re-detecting
+        tracker_->setDetectionCache(detectionCacheDir_);
+    }
     
     if (videoLoadedCallback_) {
         videoLoadedCallback_(videoPath);
@@ -314,6 +644,33 @@ void TrackingController::loadVideo(const std::string& videoPath) {
     std::cout << "Total frames: " << totalFrames_ << std::endl;
 }
 
+void TrackingController::setDetectionCacheDir(const std::string& directory) {
+    detectionCacheDir_ = directory;
+}
+
+void TrackingController::setSnapshotFile(const std::string& path) {
+    snapshotPath_ = path;
+}
+
+// Seeds the frame cache's checkpoints, so seeks replay at most one snapshot
+// interval
+void TrackingController::loadSnapshots(const std::string& videoPath) {
+    TrackerSnapshotReader reader;
+    if (!reader.open(snapshotPath_, DetectionCache::fingerprintFile(videoPath))) {
+        std::cerr << "Warning: No tracker snapshots for this video in " << snapshotPath_ << std::endl;
+        return;
+    }
+    size_t loaded = 0;
+    for (const auto& record : reader.getRecords()) {
+        auto state = std::make_shared<TrackingState>();
+        if (reader.load(record, *state)) {
+            frameCache_.addCheckpoint(record.frameIndex, std::move(state));
+            ++loaded;
+        }
+    }
+    std::cout << "Tracker snapshots: " << loaded << std::endl;
+}
+
 void TrackingController::saveVideo(const std::string& outputPath) {
     if (!videoCapture_.isOpened()) return;
     
@@ -338,6 +695,9 @@ void TrackingController::play() {
     
     isPlaying_ = true;
     isPaused_ = false;
+    if (prefetchThread_.joinable()) {
+        restartPlayback();
+    }
     
     if (statusUpdateCallback_) {
         statusUpdateCallback_("Playing");
@@ -346,6 +706,10 @@ void TrackingController::play() {
 
 void TrackingController::pause() {
     isPaused_ = true;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        playbackClock_.pause();
+    }
     
     if (statusUpdateCallback_) {
         statusUpdateCallback_("Paused");
@@ -375,9 +739,16 @@ void TrackingController::stepForward() {
 }
 
 void TrackingController::stepBackward() {
+    if (!videoCapture_.isOpened() || currentFrame_ <= 1) return;
+    
+    currentFrame_--;
+    processFrame();
+}
+
+void TrackingController::seekToFrame(int frameNumber) {
     if (!videoCapture_.isOpened()) return;
     
-    currentFrame_ = std::max(currentFrame_ - 1, 0);
+    currentFrame_ = std::max(1, totalFrames_ > 0 ? std::min(frameNumber, totalFrames_) : frameNumber);
     processFrame();
 }
 
@@ -402,55 +773,41 @@ void TrackingController::toggleTracking() {
 // Advanced features
 void TrackingController::setOcclusionThreshold(float threshold) {
     occlusionThreshold_ = threshold;
-    if (tracker_) {
-        tracker_->setOcclusionThreshold(threshold);
-    }
+    changeTracking([this, threshold] { tracker_->setOcclusionThreshold(threshold); });
 }
 
 void TrackingController::setReIdThreshold(float threshold) {
     reIdThreshold_ = threshold;
-    if (tracker_) {
-        tracker_->setReIdThreshold(threshold);
-    }
+    changeTracking([this, threshold] { tracker_->setReIdThreshold(threshold); });
 }
 
 void TrackingController::setCameraSensitivity(float sensitivity) {
     cameraSensitivity_ = sensitivity;
-    if (tracker_) {
-        tracker_->setCameraMotionSensitivity(sensitivity);
-    }
+    changeTracking([this, sensitivity] { tracker_->setCameraMotionSensitivity(sensitivity); });
 }
 
 void TrackingController::togglePartialOcclusion() {
     partialOcclusionEnabled_ = !partialOcclusionEnabled_;
-    if (tracker_) {
-        tracker_->enablePartialOcclusionHandling(partialOcclusionEnabled_);
-    }
+    changeTracking([this] { tracker_->enablePartialOcclusionHandling(partialOcclusionEnabled_); });
     std::cout << "Partial occlusion: " << (partialOcclusionEnabled_ ? "ON" : "OFF") << std::endl;
 }
 
 void TrackingController::toggleReIdentification() {
     reIdEnabled_ = !reIdEnabled_;
-    if (tracker_) {
-        tracker_->enableReIdentification(reIdEnabled_);
-    }
+    changeTracking([this] { tracker_->enableReIdentification(reIdEnabled_); });
     std::cout << "Re-identification: " << (reIdEnabled_ ? "ON" : "OFF") << std::endl;
 }
 
 void TrackingController::toggleCameraCompensation() {
     cameraCompensationEnabled_ = !cameraCompensationEnabled_;
-    if (tracker_) {
-        tracker_->enableCameraMotionCompensation(cameraCompensationEnabled_);
-    }
+    changeTracking([this] { tracker_->enableCameraMotionCompensation(cameraCompensationEnabled_); });
     std::cout << "Camera compensation: " << (cameraCompensationEnabled_ ? "ON" : "OFF") << std::endl;
 }
 
 // Display options
 void TrackingController::toggleDebugInfo() {
     showDebugInfo_ = !showDebugInfo_;
-    if (tracker_) {
-        tracker_->setDebugMode(showDebugInfo_);
-    }
+    changeTracking([this] { tracker_->setDebugMode(showDebugInfo_); });
     std::cout << "Debug info: " << (showDebugInfo_ ? "ON" : "OFF") << std::endl;
 }
 
@@ -464,7 +821,7 @@ void TrackingController::toggleRecording() {
 
 void TrackingController::setDetectionThreshold(float threshold) {
     detectionThreshold_ = threshold;
-    // Note: This would need to be implemented in the tracker
+    changeTracking([this, threshold] { tracker_->setDetectionThreshold(threshold); });
 }
 
 // Statistics
@@ -490,13 +847,13 @@ void TrackingController::setStatusUpdateCallback(std::function<void(const std::s
 
 // Private methods
 void TrackingController::updateTrackingState() {
-    if (!tracker_) return;
-    
-    if (isAdvancedMode_) {
-        tracker_->enablePartialOcclusionHandling(partialOcclusionEnabled_);
-        tracker_->enableReIdentification(reIdEnabled_);
-        tracker_->enableCameraMotionCompensation(cameraCompensationEnabled_);
-    }
+    changeTracking([this] {
+        if (isAdvancedMode_) {
+            tracker_->enablePartialOcclusionHandling(partialOcclusionEnabled_);
+            tracker_->enableReIdentification(reIdEnabled_);
+            tracker_->enableCameraMotionCompensation(cameraCompensationEnabled_);
+        }
+    });
 }
 
 void TrackingController::saveSettings() {
@@ -515,26 +872,25 @@ void TrackingController::handleMouseEvents(int event, int x, int y, int flags, v
 }
 
 void TrackingController::selectTarget(int x, int y) {
-    if (tracker_) {
-        tracker_->handleMouseClick(x, y);
-    }
+    changeTracking([this, x, y] { tracker_->handleMouseClick(x, y); });
 }
 
 void TrackingController::clearTarget() {
-    if (tracker_) {
-        tracker_->clearTargetSelection();
-    }
+    changeTracking([this] { tracker_->clearTargetSelection(); });
 }
 
 void TrackingController::enableTargetSelection(bool enable) {
     targetSelectionMode_ = enable;
-    if (tracker_) {
-        tracker_->setTargetSelectionMode(enable);
-    }
+    changeTracking([this, enable] { tracker_->setTargetSelectionMode(enable); });
 }
 
+// Takes effect from the displayed frame on; frames that cannot be tracked in
+// time at this speed are skipped or dropped
 void TrackingController::setPlaybackSpeed(double speed) {
+    if (speed <= 0.0) return;
     playbackSpeed_ = speed;
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    playbackClock_.setSpeed(speed);
 }
 
 // Static mouse callback
@@ -1,10 +1,19 @@
 #pragma once
 
 #include "AdvancedCarTracker.h"
+#include "FrameCache.h"
+#include "KeyframeIndex.h"
+#include "PlaybackClock.h"
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <memory>
 #include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <vector>
 
 class TrackingController {
 public:
@@ -18,6 +27,9 @@ public:
     // File operations
     void loadVideo(const std::string& videoPath);
     void saveVideo(const std::string& outputPath);
+    void setDetectionCacheDir(const std::string& directory);
+    // Tracker snapshots from a batch run (--snapshots) to seek with
+    void setSnapshotFile(const std::string& path);
     void selectVideoFile();
     void selectOutputFile();
     std::string openFileDialog(const std::string& title, const std::string& filter = "Video files (*.mp4 *.avi *.mov *.mkv);;All files (*.*)");
@@ -29,6 +41,7 @@ public:
     void stop();
     void stepForward();
     void stepBackward();
+    void seekToFrame(int frameNumber);  // 1-based, like getFrameCount()
     void setPlaybackSpeed(double speed);
     
     // Tracking controls
@@ -72,10 +85,17 @@ private:
     void updateGUI();
     void handleMouseEvents(int event, int x, int y, int flags, void* userdata);
     void drawControlPanel();
+    void drawPanelLine(int line, const std::string& text, const cv::Scalar& color);
     void drawStatusPanel();
     
     // Video processing
-    void processFrame();
+    bool processFrame();
+    bool renderFrame(int frameIndex, cv::Mat& output, double& timestampMs, bool allowGap);
+    bool trackFrame(int frameIndex, cv::Mat& output, double& timestampMs);
+    bool decodeFrame(int frameIndex, cv::Mat& frame, double& timestampMs);
+    bool seekTracker(int frameIndex);
+    void changeTracking(const std::function<void()>& change);
+    void loadSnapshots(const std::string& videoPath);
     void updateDisplay();
     void updateStatistics();
     void handleKeyPress(char key);
@@ -85,14 +105,40 @@ private:
     void saveSettings();
     void loadSettings();
     
+    // Playback: the prefetch thread tracks ahead, run() shows frames on time
+    struct PrefetchedFrame {
+        int frameIndex = 0;
+        double timestampMs = 0.0;
+        cv::Mat frame;
+        double processingMs = 0.0;
+    };
+    void startPrefetch();
+    void stopPrefetch();
+    void restartPlayback();
+    void prefetchLoop();
+    
     // Member variables
     std::unique_ptr<AdvancedCarTracker> tracker_;
     cv::VideoCapture videoCapture_;
     cv::VideoWriter videoWriter_;
     
+    // Scrubbing: cached results, keyframes, and where decoder and tracker are
+    FrameCache frameCache_;
+    KeyframeIndex keyframeIndex_;
+    int decoderPosition_;  // Frame the next read() returns
+    int trackedFrame_;     // Tracker holds the state after this frame; -1 = no frames yet
+    
     // GUI windows
     cv::Mat controlPanel_;
+    cv::Mat panelBackground_;  // Static text only
     cv::Mat statusPanel_;
+    
+    // Value lines of the control panel, as last drawn
+    enum PanelLine {
+        kStatusLine, kModeLine, kOcclusionLine, kReIdLine, kCameraLine,
+        kFrameLine, kFpsLine, kVehiclesLine, kPanelLineCount
+    };
+    std::vector<std::string> panelLines_;
     std::string mainWindowName_;
     std::string controlWindowName_;
     
@@ -113,6 +159,8 @@ private:
     float reIdThreshold_;
     float cameraSensitivity_;
     double playbackSpeed_;
+    std::string detectionCacheDir_;
+    std::string snapshotPath_;
     
     // Statistics
     int currentFrame_;
@@ -120,6 +168,23 @@ private:
     double fps_;
     double processingTime_;
     int vehiclesDetected_;
+    double sourceFps_;
+    // Display times of recent frames, for the FPS readout
+    std::deque<std::chrono::steady_clock::time_point> shownFrameTimes_;
+    
+    // Tracker, decoder and frame cache; held by whichever thread renders
+    std::mutex pipelineMutex_;
+    // Guards the queue, the clock and the prefetch position
+    std::mutex queueMutex_;
+    std::condition_variable queueCv_;
+    std::deque<PrefetchedFrame> prefetched_;
+    PlaybackClock playbackClock_;
+    int nextPrefetch_;
+    uint64_t prefetchGeneration_;  // Bumped to discard frames rendered before a restart
+    bool prefetchStopping_;
+    bool prefetchEnded_;
+    int droppedFrames_;
+    std::thread prefetchThread_;
     
     // Callbacks
     std::function<void(const std::string&)> videoLoadedCallback_;
@@ -0,0 +1,188 @@
+#include "TrackingMetrics.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <tuple>
+
+bool loadMOTFile(const std::string& path, std::map<int, FrameBoxes>& frames) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open ground truth file: " << path << std::endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::replace(line.begin(), line.end(), ',', ' ');
+        std::istringstream fields(line);
+
+        int frame, id;
+        float x, y, width, height, consider = 1.0f;
+        if (!(fields >> frame >> id >> x >> y >> width >> height)) continue;
+        fields >> consider;
+        if (consider == 0.0f) continue;
+
+        frames[frame].emplace_back(id, cv::Rect(static_cast<int>(x), static_cast<int>(y),
+                                                static_cast<int>(width), static_cast<int>(height)));
+    }
+    return true;
+}
+
+float boxIoU(const cv::Rect& a, const cv::Rect& b) {
+    int x1 = std::max(a.x, b.x);
+    int y1 = std::max(a.y, b.y);
+    int x2 = std::min(a.x + a.width, b.x + b.width);
+    int y2 = std::min(a.y + a.height, b.y + b.height);
+    if (x2 <= x1 || y2 <= y1) return 0.0f;
+
+    float intersection = static_cast<float>(x2 - x1) * (y2 - y1);
+    float unionArea = static_cast<float>(a.width) * a.height + static_cast<float>(b.width) * b.height - intersection;
+    return unionArea > 0.0f ? intersection / unionArea : 0.0f;
+}
+
+// ---------------------------------------------------------------------------
+// MOTAccumulator
+// ---------------------------------------------------------------------------
+
+MOTAccumulator::MOTAccumulator(float iouThreshold)
+    : iouThreshold_(iouThreshold), groundTruth_(0), hypotheses_(0),
+      falsePositives_(0), misses_(0), idSwitches_(0) {
+}
+
+void MOTAccumulator::addFrame(const FrameBoxes& groundTruth, const FrameBoxes& tracks) {
+    groundTruth_ += static_cast<long>(groundTruth.size());
+    hypotheses_ += static_cast<long>(tracks.size());
+
+    std::vector<bool> gtMatched(groundTruth.size(), false);
+    std::vector<bool> trackMatched(tracks.size(), false);
+    std::vector<std::pair<size_t, size_t>> matches;
+
+    // Keep correspondences from the previous frame that still hold
+    for (size_t g = 0; g < groundTruth.size(); ++g) {
+        auto last = lastMatch_.find(groundTruth[g].first);
+        if (last == lastMatch_.end()) continue;
+        for (size_t t = 0; t < tracks.size(); ++t) {
+            if (!trackMatched[t] && tracks[t].first == last->second &&
+                boxIoU(groundTruth[g].second, tracks[t].second) >= iouThreshold_) {
+                gtMatched[g] = trackMatched[t] = true;
+                matches.emplace_back(g, t);
+                break;
+            }
+        }
+    }
+
+    // Pair the rest greedily, best overlap first
+    std::vector<std::tuple<float, size_t, size_t>> candidates;
+    for (size_t g = 0; g < groundTruth.size(); ++g) {
+        if (gtMatched[g]) continue;
+        for (size_t t = 0; t < tracks.size(); ++t) {
+            if (trackMatched[t]) continue;
+            float iou = boxIoU(groundTruth[g].second, tracks[t].second);
+            if (iou >= iouThreshold_) candidates.emplace_back(iou, g, t);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return std::get<0>(a) > std::get<0>(b); });
+    for (const auto& candidate : candidates) {
+        size_t g = std::get<1>(candidate);
+        size_t t = std::get<2>(candidate);
+        if (gtMatched[g] || trackMatched[t]) continue;
+        gtMatched[g] = trackMatched[t] = true;
+        matches.emplace_back(g, t);
+    }
+
+    for (const auto& match : matches) {
+        int gtId = groundTruth[match.first].first;
+        int trackId = tracks[match.second].first;
+        auto last = lastMatch_.find(gtId);
+        if (last != lastMatch_.end() && last->second != trackId) {
+            idSwitches_++;
+        }
+        lastMatch_[gtId] = trackId;
+        coFrames_[std::make_pair(gtId, trackId)]++;
+    }
+
+    misses_ += static_cast<long>(groundTruth.size() - matches.size());
+    falsePositives_ += static_cast<long>(tracks.size() - matches.size());
+}
+
+MOTSummary MOTAccumulator::summary() const {
+    MOTSummary result;
+    result.groundTruth = groundTruth_;
+    result.hypotheses = hypotheses_;
+    result.falsePositives = falsePositives_;
+    result.misses = misses_;
+    result.idSwitches = idSwitches_;
+    result.mota = groundTruth_ > 0
+        ? 1.0 - static_cast<double>(misses_ + falsePositives_ + idSwitches_) / groundTruth_
+        : 0.0;
+
+    // Greedy identity assignment: largest co-occurrence first, one-to-one
+    std::vector<std::pair<long, std::pair<int, int>>> pairs;
+    pairs.reserve(coFrames_.size());
+    for (const auto& entry : coFrames_) {
+        pairs.emplace_back(entry.second, entry.first);
+    }
+    std::sort(pairs.begin(), pairs.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    std::map<int, bool> gtUsed, trackUsed;
+    long idTruePositives = 0;
+    for (const auto& pair : pairs) {
+        int gtId = pair.second.first;
+        int trackId = pair.second.second;
+        if (gtUsed[gtId] || trackUsed[trackId]) continue;
+        gtUsed[gtId] = trackUsed[trackId] = true;
+        idTruePositives += pair.first;
+    }
+
+    long denominator = groundTruth_ + hypotheses_;
+    result.idf1 = denominator > 0 ? 2.0 * idTruePositives / denominator : 0.0;
+    return result;
+}
+
+// ---------------------------------------------------------------------------
+// StabilityAccumulator
+// ---------------------------------------------------------------------------
+
+StabilityAccumulator::StabilityAccumulator(float iouThreshold)
+    : iouThreshold_(iouThreshold), coverageSum_(0.0), frames_(0) {
+}
+
+void StabilityAccumulator::addFrame(const std::vector<cv::Rect>& detections, const FrameBoxes& tracks) {
+    for (const auto& track : tracks) {
+        trackFrames_[track.first]++;
+    }
+    if (detections.empty()) return;
+
+    size_t covered = 0;
+    for (const auto& detection : detections) {
+        for (const auto& track : tracks) {
+            if (boxIoU(detection, track.second) >= iouThreshold_) {
+                covered++;
+                break;
+            }
+        }
+    }
+    coverageSum_ += static_cast<double>(covered) / detections.size();
+    frames_++;
+}
+
+StabilitySummary StabilityAccumulator::summary() const {
+    StabilitySummary result;
+    result.tracks = static_cast<long>(trackFrames_.size());
+    result.coverage = frames_ > 0 ? coverageSum_ / frames_ : 0.0;
+
+    long totalFrames = 0;
+    long shortTracks = 0;
+    for (const auto& entry : trackFrames_) {
+        totalFrames += entry.second;
+        if (entry.second < kShortTrackFrames) shortTracks++;
+    }
+    result.meanTrackLength = result.tracks > 0 ? static_cast<double>(totalFrames) / result.tracks : 0.0;
+    result.shortTrackRatio = result.tracks > 0 ? static_cast<double>(shortTracks) / result.tracks : 0.0;
+    result.score = result.coverage * (1.0 - result.shortTrackRatio);
+    return result;
+}
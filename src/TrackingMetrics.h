@@ -0,0 +1,77 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+// (track or ground-truth id, box) pairs for one frame
+using FrameBoxes = std::vector<std::pair<int, cv::Rect>>;
+
+// Loads a MOTChallenge text file (frame,id,x,y,w,h,...) keyed by frame
+// number. Rows with a zero "consider" flag in column 7 are skipped.
+bool loadMOTFile(const std::string& path, std::map<int, FrameBoxes>& frames);
+
+float boxIoU(const cv::Rect& a, const cv::Rect& b);
+
+struct MOTSummary {
+    double mota;
+    double idf1;
+    long groundTruth;     // Total ground-truth boxes
+    long hypotheses;      // Total track boxes
+    long falsePositives;
+    long misses;
+    long idSwitches;
+};
+
+// CLEAR-MOT and identity metrics accumulated frame by frame.
+//
+// Frame matching keeps last frame's ground-truth/track pairs when they still
+// overlap, then pairs the rest greedily by IoU. IDF1 uses a greedy one-to-one
+// assignment of ground-truth ids to track ids by co-occurrence count rather
+// than the optimal bipartite matching, which can only under-report it.
+class MOTAccumulator {
+public:
+    explicit MOTAccumulator(float iouThreshold = 0.5f);
+
+    void addFrame(const FrameBoxes& groundTruth, const FrameBoxes& tracks);
+    MOTSummary summary() const;
+
+private:
+    float iouThreshold_;
+    long groundTruth_;
+    long hypotheses_;
+    long falsePositives_;
+    long misses_;
+    long idSwitches_;
+    std::map<int, int> lastMatch_;                  // gt id -> track id
+    std::map<std::pair<int, int>, long> coFrames_;  // (gt id, track id) -> matched frames
+};
+
+struct StabilitySummary {
+    double score;            // Higher is better; see StabilityAccumulator
+    double coverage;         // Mean fraction of detections with a track on them
+    double meanTrackLength;  // Frames per track id
+    double shortTrackRatio;  // Fraction of track ids seen for fewer than kShortTrackFrames
+    long tracks;
+};
+
+// Stand-in for accuracy when there is no ground truth: a stable tracker keeps
+// a track on every detection (coverage) without spawning short-lived ids.
+// score = coverage * (1 - shortTrackRatio).
+class StabilityAccumulator {
+public:
+    static constexpr int kShortTrackFrames = 10;
+
+    explicit StabilityAccumulator(float iouThreshold = 0.5f);
+
+    void addFrame(const std::vector<cv::Rect>& detections, const FrameBoxes& tracks);
+    StabilitySummary summary() const;
+
+private:
+    float iouThreshold_;
+    double coverageSum_;
+    long frames_;
+    std::map<int, long> trackFrames_;  // track id -> frames seen
+};
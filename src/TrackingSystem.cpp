@@ -1,4 +1,5 @@
 #include "TrackingSystem.h"
+#include "TrackerPolicies.h"
 #include <iostream>
 #include <algorithm>
 
@@ -11,13 +12,16 @@ TrackingSystem::~TrackingSystem() {
 
 void TrackingSystem::initialize() {
     tracks_.clear();
+    trackIndex_.clear();
     nextId_ = 0;
 }
 
-std::vector<TrackedVehicle> TrackingSystem::update(const std::vector<Detection>& detections, 
-                                                  const cv::Mat& frame) {
+TrackView<TrackedVehicle> TrackingSystem::update(ConstSpan<Detection> detections, 
+                                                const cv::Mat& frame, float dt) {
+    FrameArenaScope arenaScope(frameArena_);
+    
     // Predict new locations of existing tracks
-    predictTracks();
+    predictTracks(dt);
     
     // Update tracks with detections
     updateTracks(detections);
@@ -28,28 +32,26 @@ std::vector<TrackedVehicle> TrackingSystem::update(const std::vector<Detection>&
     // Remove stale tracks
     removeStaleTracks();
     
-    // Return active tracks
-    std::vector<TrackedVehicle> activeTracks;
-    for (const auto& track : tracks_) {
-        if (track.isActive) {
-            activeTracks.push_back(track);
-        }
-    }
-    
-    return activeTracks;
+    return getTracks();
+}
+
+TrackView<TrackedVehicle> TrackingSystem::getTracks() const {
+    return TrackView<TrackedVehicle>(tracks_);
 }
 
-void TrackingSystem::drawTracks(cv::Mat& frame, const std::vector<TrackedVehicle>& tracks) {
+void TrackingSystem::drawTracks(cv::Mat& frame, TrackView<TrackedVehicle> tracks) {
     for (const auto& track : tracks) {
-        if (!track.isActive) continue;
+        static const LabelId car = internLabel("car");
+        static const LabelId truck = internLabel("truck");
+        static const LabelId bus = internLabel("bus");
         
         // Draw bounding box
         cv::Scalar color;
-        if (track.label == "car") {
+        if (track.label == car) {
             color = cv::Scalar(0, 255, 0); // Green for cars
-        } else if (track.label == "truck") {
+        } else if (track.label == truck) {
             color = cv::Scalar(0, 0, 255); // Red for trucks
-        } else if (track.label == "bus") {
+        } else if (track.label == bus) {
             color = cv::Scalar(255, 0, 0); // Blue for buses
         } else {
             color = cv::Scalar(255, 255, 0); // Cyan for others
@@ -58,7 +60,7 @@ void TrackingSystem::drawTracks(cv::Mat& frame, const std::vector<TrackedVehicle
         cv::rectangle(frame, track.boundingBox, color, 2);
         
         // Draw ID and label
-        std::string label = track.label + " #" + std::to_string(track.id);
+        std::string label = labelName(track.label) + " #" + std::to_string(track.id);
         cv::putText(frame, label, cv::Point(track.boundingBox.x, track.boundingBox.y - 10),
                    cv::FONT_HERSHEY_SIMPLEX, 0.6, color, 2);
         
@@ -79,6 +81,7 @@ void TrackingSystem::drawTracks(cv::Mat& frame, const std::vector<TrackedVehicle
 
 void TrackingSystem::reset() {
     tracks_.clear();
+    trackIndex_.clear();
     nextId_ = 0;
 }
 
@@ -95,46 +98,18 @@ void TrackingSystem::setIoUThreshold(float threshold) {
 }
 
 cv::KalmanFilter TrackingSystem::createKalmanFilter() {
-    // State: [x, y, width, height, vx, vy, vw, vh]
-    // Measurement: [x, y, width, height]
-    cv::KalmanFilter kf(8, 4, 0);
-    
-    // State transition matrix
-    kf.transitionMatrix = cv::Mat::eye(8, 8, CV_32F);
-    kf.transitionMatrix.at<float>(0, 4) = 1.0f; // x += vx
-    kf.transitionMatrix.at<float>(1, 5) = 1.0f; // y += vy
-    kf.transitionMatrix.at<float>(2, 6) = 1.0f; // width += vw
-    kf.transitionMatrix.at<float>(3, 7) = 1.0f; // height += vh
-    
-    // Measurement matrix
-    kf.measurementMatrix = cv::Mat::zeros(4, 8, CV_32F);
-    kf.measurementMatrix.at<float>(0, 0) = 1.0f;
-    kf.measurementMatrix.at<float>(1, 1) = 1.0f;
-    kf.measurementMatrix.at<float>(2, 2) = 1.0f;
-    kf.measurementMatrix.at<float>(3, 3) = 1.0f;
-    
-    // Process noise covariance
-    kf.processNoiseCov = cv::Mat::eye(8, 8, CV_32F) * 1e-2;
-    kf.processNoiseCov.at<float>(4, 4) = 1e-1; // Velocity noise
-    kf.processNoiseCov.at<float>(5, 5) = 1e-1;
-    kf.processNoiseCov.at<float>(6, 6) = 1e-1;
-    kf.processNoiseCov.at<float>(7, 7) = 1e-1;
-    
-    // Measurement noise covariance
-    kf.measurementNoiseCov = cv::Mat::eye(4, 4, CV_32F) * 1e-1;
-    
-    // Initial state covariance
-    kf.errorCovPost = cv::Mat::eye(8, 8, CV_32F) * 1e-1;
-    
-    return kf;
+    // Same filter as the KalmanMotion policy of the Tracker template
+    return KalmanMotion::createFilter();
 }
 
-void TrackingSystem::predictTracks() {
+void TrackingSystem::predictTracks(float dt) {
     for (auto& track : tracks_) {
         if (track.isActive) {
-            // Predict using Kalman filter
-            cv::KalmanFilter tempKF = track.kalmanFilter;
-            cv::Mat prediction = tempKF.predict();
+            // Predict using Kalman filter, over the rest of the gap in one step
+            float step = std::max(dt - track.framesAhead, 0.0f);
+            track.framesAhead = 0.0f;
+            KalmanMotion::setTimeStep(track.kalmanFilter, step);
+            const cv::Mat& prediction = track.kalmanFilter.predict();
             
             // Update bounding box from prediction
             track.boundingBox.x = static_cast<int>(prediction.at<float>(0));
@@ -146,14 +121,15 @@ void TrackingSystem::predictTracks() {
             track.velocity.x = prediction.at<float>(4);
             track.velocity.y = prediction.at<float>(5);
             
-            track.age++;
-            track.consecutiveMisses++;
+            // Misses count from the re-anchor, when there was one
+            track.age += framesCovered(dt);
+            track.consecutiveMisses += framesCovered(step);
         }
     }
 }
 
-void TrackingSystem::updateTracks(const std::vector<Detection>& detections) {
-    std::vector<bool> detectionMatched(detections.size(), false);
+void TrackingSystem::updateTracks(ConstSpan<Detection> detections) {
+    ArenaVector<char> detectionMatched(detections.size(), 0, ArenaAllocator<char>(&frameArena_));
     
     for (auto& track : tracks_) {
         if (!track.isActive) continue;
@@ -168,7 +144,7 @@ void TrackingSystem::updateTracks(const std::vector<Detection>& detections) {
             float iou = calculateIoU(track.boundingBox, detections[i].boundingBox);
             if (iou > bestIoU && iou > iouThreshold_) {
                 bestIoU = iou;
-                bestDetectionIdx = i;
+                bestDetectionIdx = static_cast<int>(i);
             }
         }
         
@@ -185,7 +161,7 @@ void TrackingSystem::updateTracks(const std::vector<Detection>& detections) {
             track.consecutiveMisses = 0;
             track.isActive = true;
             
-            detectionMatched[bestDetectionIdx] = true;
+            detectionMatched[bestDetectionIdx] = 1;
         } else {
             // No detection matched
             if (track.consecutiveMisses > maxAge_) {
@@ -195,7 +171,7 @@ void TrackingSystem::updateTracks(const std::vector<Detection>& detections) {
     }
 }
 
-void TrackingSystem::createNewTracks(const std::vector<Detection>& detections) {
+void TrackingSystem::createNewTracks(ConstSpan<Detection> detections) {
     for (size_t i = 0; i < detections.size(); ++i) {
         bool matched = false;
         
@@ -229,36 +205,38 @@ void TrackingSystem::createNewTracks(const std::vector<Detection>& detections) {
             newTrack.kalmanFilter.statePost = state.clone();
             
             newTrack.isActive = true;
+            trackIndex_[newTrack.id] = tracks_.size();
             tracks_.push_back(newTrack);
         }
     }
 }
 
 void TrackingSystem::removeStaleTracks() {
-    tracks_.erase(
-        std::remove_if(tracks_.begin(), tracks_.end(),
-                      [this](const TrackedVehicle& track) {
-                          return !track.isActive || 
-                                 (track.consecutiveMisses > maxAge_ && track.totalHits < minHits_);
-                      }),
-        tracks_.end()
-    );
+    size_t kept = 0;
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        const TrackedVehicle& track = tracks_[i];
+        bool stale = !track.isActive || 
+                     (track.consecutiveMisses > maxAge_ && track.totalHits < minHits_);
+        if (stale) {
+            retireTrack(track);
+            trackIndex_.erase(track.id);
+            continue;
+        }
+        if (kept != i) {
+            trackIndex_[track.id] = kept;
+            tracks_[kept] = std::move(tracks_[i]);
+        }
+        ++kept;
+    }
+    tracks_.erase(tracks_.begin() + kept, tracks_.end());
+}
+
+void TrackingSystem::retireTrack(const TrackedVehicle& track) {
+    (void)track;
 }
 
 float TrackingSystem::calculateIoU(const cv::Rect& rect1, const cv::Rect& rect2) {
-    int x1 = std::max(rect1.x, rect2.x);
-    int y1 = std::max(rect1.y, rect2.y);
-    int x2 = std::min(rect1.x + rect1.width, rect2.x + rect2.width);
-    int y2 = std::min(rect1.y + rect1.height, rect2.y + rect2.height);
-    
-    if (x2 < x1 || y2 < y1) return 0.0f;
-    
-    int intersection = (x2 - x1) * (y2 - y1);
-    int area1 = rect1.width * rect1.height;
-    int area2 = rect2.width * rect2.height;
-    int union_area = area1 + area2 - intersection;
-    
-    return static_cast<float>(intersection) / static_cast<float>(union_area);
+    return IoUAssociation::intersectionOverUnion(rect1, rect2);
 }
 
 cv::Point2f TrackingSystem::calculateVelocity(const cv::Rect& prevBox, const cv::Rect& currBox) {
@@ -269,24 +247,39 @@ cv::Point2f TrackingSystem::calculateVelocity(const cv::Rect& prevBox, const cv:
 }
 
 void TrackingSystem::updateKalmanFilter(TrackedVehicle& track, const cv::Rect& detection) {
-    cv::Mat measurement = cv::Mat::zeros(4, 1, CV_32F);
-    measurement.at<float>(0) = static_cast<float>(detection.x);
-    measurement.at<float>(1) = static_cast<float>(detection.y);
-    measurement.at<float>(2) = static_cast<float>(detection.width);
-    measurement.at<float>(3) = static_cast<float>(detection.height);
+    // Wraps stack memory; a Mat header over external data does not allocate
+    float values[4] = {static_cast<float>(detection.x), static_cast<float>(detection.y),
+                       static_cast<float>(detection.width), static_cast<float>(detection.height)};
+    cv::Mat measurement(4, 1, CV_32F, values);
     
     track.kalmanFilter.correct(measurement);
 }
 
-cv::Rect TrackingSystem::predictKalmanPosition(const TrackedVehicle& track) {
-    cv::KalmanFilter tempKF = track.kalmanFilter;
-    cv::Mat prediction = tempKF.predict();
+TrackedVehicle* TrackingSystem::findTrack(int id) {
+    auto entry = trackIndex_.find(id);
+    if (entry == trackIndex_.end() || entry->second >= tracks_.size()) return nullptr;
+    TrackedVehicle& track = tracks_[entry->second];
+    return track.id == id ? &track : nullptr;
+}
+
+void TrackingSystem::rebuildTrackIndex() {
+    trackIndex_.clear();
+    for (size_t i = 0; i < tracks_.size(); ++i) {
+        trackIndex_[tracks_[i].id] = i;
+    }
+}
+
+cv::Rect TrackingSystem::predictKalmanPosition(const TrackedVehicle& track, float dt) const {
+    // Copies of a KalmanFilter share its matrices, so predict() here would
+    // move the track; apply the constant-velocity step to the state instead
+    const cv::Mat& state = track.kalmanFilter.statePost;
+    if (state.empty()) return track.boundingBox;
     
     cv::Rect predictedBox;
-    predictedBox.x = static_cast<int>(prediction.at<float>(0));
-    predictedBox.y = static_cast<int>(prediction.at<float>(1));
-    predictedBox.width = static_cast<int>(prediction.at<float>(2));
-    predictedBox.height = static_cast<int>(prediction.at<float>(3));
+    predictedBox.x = static_cast<int>(state.at<float>(0) + state.at<float>(4) * dt);
+    predictedBox.y = static_cast<int>(state.at<float>(1) + state.at<float>(5) * dt);
+    predictedBox.width = static_cast<int>(state.at<float>(2) + state.at<float>(6) * dt);
+    predictedBox.height = static_cast<int>(state.at<float>(3) + state.at<float>(7) * dt);
     
     return predictedBox;
 } 
\ No newline at end of file
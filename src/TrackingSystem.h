@@ -1,6 +1,8 @@
 #pragma once
 
 #include "VehicleDetector.h"
+#include "TrackView.h"
+#include "FrameArena.h"
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <memory>
@@ -16,42 +18,64 @@ struct TrackedVehicle {
     int consecutiveHits;
     int consecutiveMisses;
     cv::KalmanFilter kalmanFilter;
-    std::string label;
+    LabelId label;
     bool isActive;
+    // Frames the filter was already carried past the last update (by a
+    // correlation re-anchor on skipped frames); the next predict covers the rest
+    float framesAhead;
     
     TrackedVehicle() : id(-1), confidence(0.0f), age(0), totalHits(0), 
-                      consecutiveHits(0), consecutiveMisses(0), isActive(false) {}
+                      consecutiveHits(0), consecutiveMisses(0), label(kUnknownLabel), isActive(false),
+                      framesAhead(0.0f) {}
 };
 
 class TrackingSystem {
 public:
     TrackingSystem();
-    ~TrackingSystem();
+    virtual ~TrackingSystem();
     
     void initialize();
-    std::vector<TrackedVehicle> update(const std::vector<Detection>& detections, 
-                                      const cv::Mat& frame);
-    void drawTracks(cv::Mat& frame, const std::vector<TrackedVehicle>& tracks);
+    // Active tracks after this frame; a view of the live table, no copies.
+    // dt is the time since the previous update in frames: the frame skip,
+    // or the measured gap when frames are dropped or unevenly timed.
+    TrackView<TrackedVehicle> update(ConstSpan<Detection> detections, 
+                                     const cv::Mat& frame, float dt = 1.0f);
+    TrackView<TrackedVehicle> getTracks() const;
+    // Box the filter expects dt frames after the last update, for frames
+    // that are shown but not tracked; the track itself is not advanced
+    cv::Rect predictKalmanPosition(const TrackedVehicle& track, float dt = 1.0f) const;
+    void drawTracks(cv::Mat& frame, TrackView<TrackedVehicle> tracks);
     void reset();
     
     void setMaxAge(int maxAge);
     void setMinHits(int minHits);
     void setIoUThreshold(float threshold);
     
-private:
+protected:
     std::vector<TrackedVehicle> tracks_;
+    // Position of each track in tracks_ by id, kept in step as tracks are
+    // created and compacted away
+    std::unordered_map<int, size_t> trackIndex_;
     int nextId_;
     int maxAge_;
     int minHits_;
     float iouThreshold_;
+    // Per-frame temporaries; reset when the outermost update returns
+    FrameArena frameArena_;
     
     cv::KalmanFilter createKalmanFilter();
-    void predictTracks();
-    void updateTracks(const std::vector<Detection>& detections);
-    void createNewTracks(const std::vector<Detection>& detections);
+    void predictTracks(float dt);
+    void updateTracks(ConstSpan<Detection> detections);
+    void createNewTracks(ConstSpan<Detection> detections);
     void removeStaleTracks();
+    // Called for each track removeStaleTracks drops, before it is erased, so
+    // subclasses can release their per-track state
+    virtual void retireTrack(const TrackedVehicle& track);
     float calculateIoU(const cv::Rect& rect1, const cv::Rect& rect2);
     cv::Point2f calculateVelocity(const cv::Rect& prevBox, const cv::Rect& currBox);
     void updateKalmanFilter(TrackedVehicle& track, const cv::Rect& detection);
-    cv::Rect predictKalmanPosition(const TrackedVehicle& track);
+    // Null when no track has this id
+    TrackedVehicle* findTrack(int id);
+    // After replacing tracks_ wholesale (restoreState)
+    void rebuildTrackIndex();
 }; 
\ No newline at end of file
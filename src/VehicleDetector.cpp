@@ -1,31 +1,79 @@
 #include "VehicleDetector.h"
+#include "DetectionCache.h"
 #include <iostream>
 #include <fstream>
+#include <sstream>
+
+namespace {
+
+// Lightweight model for real-time processing
+const char* const kDefaultModelPath = "models/yolov4-tiny.weights";
+const char* const kDefaultConfigPath = "models/yolov4-tiny.cfg";
+
+bool readFileBytes(const std::string& path, std::vector<uchar>& bytes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.good()) return false;
+    std::streamsize size = file.tellg();
+    if (size <= 0) return false;
+    bytes.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(bytes.data()), size));
+}
+
+}  // namespace
 
 VehicleDetector::VehicleDetector() 
-    : confidenceThreshold_(0.5f), nmsThreshold_(0.4f), inputSize_(416, 416) {
+    : vehicleLabel_(internLabel("vehicle")), confidenceThreshold_(0.5f), nmsThreshold_(0.4f),
+      inputSize_(416, 416), latencyStats_(nullptr) {
+    hog_.setSVMDetector(cv::HOGDescriptor::getDefaultPeopleDetector());
 }
 
 VehicleDetector::~VehicleDetector() {
 }
 
+std::shared_ptr<const DetectorModel> VehicleDetector::loadDefaultModel() {
+    auto model = std::make_shared<DetectorModel>();
+    model->configPath = kDefaultConfigPath;
+    model->modelPath = kDefaultModelPath;
+    if (!readFileBytes(model->modelPath, model->weights) || !readFileBytes(model->configPath, model->config)) {
+        return nullptr;
+    }
+    // Once per load, while the bytes are in memory anyway
+    model->contentHash = DetectionCache::hashBytes(model->config.data(), model->config.size());
+    model->contentHash = DetectionCache::hashBytes(model->weights.data(), model->weights.size(),
+                                                   model->contentHash);
+    return model;
+}
+
 bool VehicleDetector::initialize() {
+    std::shared_ptr<const DetectorModel> model = loadDefaultModel();
+    if (!model) {
+        std::cout << "YOLO model not found, using HOG detector..." << std::endl;
+    }
+    return initialize(model);
+}
+
+bool VehicleDetector::initialize(std::shared_ptr<const DetectorModel> model) {
+    net_ = cv::dnn::Net();
+    outputNames_.clear();
+    model_ = model;
+    if (!model_) {
+        return true; // We'll use HOG detector
+    }
+    
     try {
-        // Load YOLO model (using a lightweight model for real-time processing)
-        std::string modelPath = "models/yolov4-tiny.weights";
-        std::string configPath = "models/yolov4-tiny.cfg";
-        
-        // Check if model files exist, if not, we'll use HOG detector as fallback
-        std::ifstream modelFile(modelPath);
-        if (!modelFile.good()) {
-            std::cout << "YOLO model not found, using HOG detector..." << std::endl;
-            return true; // We'll use HOG detector
-        }
-        
-        net_ = cv::dnn::readNetFromDarknet(configPath, modelPath);
+        net_ = cv::dnn::readNetFromDarknet(model_->config, model_->weights);
         net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
         net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
         
+        // Output layer names, looked up once per network
+        std::vector<int> outLayers = net_.getUnconnectedOutLayers();
+        std::vector<cv::String> layersNames = net_.getLayerNames();
+        outputNames_.resize(outLayers.size());
+        for (size_t i = 0; i < outLayers.size(); ++i) {
+            outputNames_[i] = layersNames[outLayers[i] - 1];
+        }
+        
         // Load class names
         classNames_ = {"person", "bicycle", "car", "motorcycle", "airplane", "bus", 
                       "train", "truck", "boat", "traffic light", "fire hydrant", 
@@ -41,6 +89,10 @@ bool VehicleDetector::initialize() {
                       "mouse", "remote", "keyboard", "cell phone", "microwave", 
                       "oven", "toaster", "sink", "refrigerator", "book", "clock", 
                       "vase", "scissors", "teddy bear", "hair drier", "toothbrush"};
+        classLabels_.clear();
+        for (const auto& name : classNames_) {
+            classLabels_.push_back(internLabel(name));
+        }
         
         return true;
     }
@@ -51,22 +103,54 @@ bool VehicleDetector::initialize() {
 }
 
 std::vector<Detection> VehicleDetector::detectVehicles(const cv::Mat& frame) {
+    return detect(frame, confidenceThreshold_);
+}
+
+std::vector<Detection> VehicleDetector::detectVehiclesInRegions(const cv::Mat& frame,
+                                                               const std::vector<cv::Rect>& regions) {
+    return detectRegions(frame, regions, confidenceThreshold_);
+}
+
+std::vector<Detection> VehicleDetector::detectVehiclesRaw(const cv::Mat& frame, float floorThreshold) {
+    return detect(frame, std::min(floorThreshold, confidenceThreshold_));
+}
+
+std::vector<Detection> VehicleDetector::filterByConfidence(const std::vector<Detection>& detections,
+                                                           float threshold) {
+    std::vector<Detection> filtered;
+    filtered.reserve(detections.size());
+    for (const auto& detection : detections) {
+        if (detection.confidence > threshold) {
+            filtered.push_back(detection);
+        }
+    }
+    return filtered;
+}
+
+std::vector<Detection> VehicleDetector::detect(const cv::Mat& frame, float threshold) {
     std::vector<Detection> detections;
     
     if (net_.empty()) {
         // Fallback to HOG detector
-        return detectVehiclesHOG(frame);
+        return detectVehiclesHOG(frame, threshold);
     }
     
     try {
-        cv::Mat blob;
-        preprocessFrame(frame, blob);
+        const cv::Mat* blob;
+        {
+            StageTimer timer(latencyStats_, LatencyStage::Preprocess);
+            blob = &preprocessFrame(frame);
+        }
         
-        net_.setInput(blob);
         std::vector<cv::Mat> outputs;
-        net_.forward(outputs, getOutputsNames());
+        {
+            StageTimer timer(latencyStats_, LatencyStage::Inference);
+            net_.setInput(*blob);
+            net_.forward(outputs, outputNames_);
+        }
         
-        detections = postprocessDetections(frame, outputs);
+        StageTimer timer(latencyStats_, LatencyStage::Postprocess);
+        detections = postprocessDetections(outputs, threshold);
     }
     catch (const cv::Exception& e) {
         std::cerr << "Error in vehicle detection: " << e.what() << std::endl;
@@ -75,27 +159,71 @@ std::vector<Detection> VehicleDetector::detectVehicles(const cv::Mat& frame) {
     return detections;
 }
 
-std::vector<Detection> VehicleDetector::detectVehiclesHOG(const cv::Mat& frame) {
+std::vector<Detection> VehicleDetector::detectRegions(const cv::Mat& frame,
+                                                     const std::vector<cv::Rect>& regions,
+                                                     float threshold) {
+    if (regions.empty()) {
+        return detect(frame, threshold);
+    }
+    
+    std::vector<Detection> candidates;
+    const cv::Rect frameRect(0, 0, frame.cols, frame.rows);
+    for (const auto& region : regions) {
+        cv::Rect clipped = region & frameRect;
+        if (clipped.area() <= 0) continue;
+        
+        // A ROI header shares the frame's pixels; no copy
+        for (auto& detection : detect(frame(clipped), threshold)) {
+            detection.boundingBox.x += clipped.x;
+            detection.boundingBox.y += clipped.y;
+            candidates.push_back(detection);
+        }
+    }
+    if (regions.size() == 1) {
+        return candidates;
+    }
+    
+    // Regions overlap, so a vehicle in the overlap is found twice
+    std::vector<cv::Rect> boxes;
+    std::vector<float> confidences;
+    boxes.reserve(candidates.size());
+    confidences.reserve(candidates.size());
+    for (const auto& detection : candidates) {
+        boxes.push_back(detection.boundingBox);
+        confidences.push_back(detection.confidence);
+    }
+    std::vector<int> indices;
+    cv::dnn::NMSBoxes(boxes, confidences, threshold, nmsThreshold_, indices);
+    
+    std::vector<Detection> detections;
+    detections.reserve(indices.size());
+    for (int idx : indices) {
+        detections.push_back(candidates[idx]);
+    }
+    return detections;
+}
+
+std::vector<Detection> VehicleDetector::detectVehiclesHOG(const cv::Mat& frame, float threshold) {
     std::vector<Detection> detections;
     
     // Use HOG detector for cars
-    static cv::HOGDescriptor hog;
-    hog.setSVMDetector(cv::HOGDescriptor::getDefaultPeopleDetector());
-    
     std::vector<cv::Rect> foundLocations;
     std::vector<double> weights;
     
     // Detect objects
-    hog.detectMultiScale(frame, foundLocations, weights, 0, cv::Size(8, 8), 
+    StageTimer inferenceTimer(latencyStats_, LatencyStage::Inference);
+    hog_.detectMultiScale(frame, foundLocations, weights, 0, cv::Size(8, 8), 
                         cv::Size(4, 4), 1.05, 2, false);
+    inferenceTimer.stop();
     
+    StageTimer postprocessTimer(latencyStats_, LatencyStage::Postprocess);
     for (size_t i = 0; i < foundLocations.size(); ++i) {
-        if (weights[i] > confidenceThreshold_) {
+        if (weights[i] > threshold) {
             Detection det;
             det.boundingBox = foundLocations[i];
             det.confidence = static_cast<float>(weights[i]);
             det.classId = 2; // car class
-            det.label = "vehicle";
+            det.label = vehicleLabel_;
             detections.push_back(det);
         }
     }
@@ -111,26 +239,51 @@ void VehicleDetector::setNMSThreshold(float threshold) {
     nmsThreshold_ = threshold;
 }
 
-std::vector<cv::String> VehicleDetector::getOutputsNames() {
-    static std::vector<cv::String> names;
-    if (names.empty()) {
-        std::vector<int> outLayers = net_.getUnconnectedOutLayers();
-        std::vector<cv::String> layersNames = net_.getLayerNames();
-        names.resize(outLayers.size());
-        for (size_t i = 0; i < outLayers.size(); ++i) {
-            names[i] = layersNames[outLayers[i] - 1];
-        }
+float VehicleDetector::getConfidenceThreshold() const {
+    return confidenceThreshold_;
+}
+
+std::string VehicleDetector::getModelFingerprint() const {
+    return fingerprintFor(net_.empty() ? nullptr : model_.get(), inputSize_, nmsThreshold_);
+}
+
+std::string VehicleDetector::fingerprintFor(const DetectorModel* model, const cv::Size& inputSize,
+                                            float nmsThreshold) {
+    if (!model) {
+        return "hog:default-people";
     }
-    return names;
+    
+    std::ostringstream key;
+    key << "darknet:" << model->configPath << ":" << model->modelPath
+        << ":" << std::hex << model->contentHash << std::dec
+        << ":" << inputSize.width << "x" << inputSize.height
+        << ":letterbox:nms=" << nmsThreshold;
+    return key.str();
+}
+
+cv::Size VehicleDetector::getInputSize() const {
+    return inputSize_;
+}
+
+LabelId VehicleDetector::labelForClass(int classId) const {
+    if (net_.empty()) {
+        return vehicleLabel_;
+    }
+    return (classId >= 0 && classId < static_cast<int>(classLabels_.size())) ? classLabels_[classId] : kUnknownLabel;
+}
+
+void VehicleDetector::setLatencyStats(LatencyStats* stats) {
+    latencyStats_ = stats;
 }
 
-void VehicleDetector::preprocessFrame(const cv::Mat& frame, cv::Mat& blob) {
-    cv::dnn::blobFromImage(frame, blob, 1/255.0, inputSize_, cv::Scalar(0, 0, 0), 
-                          true, false);
+const cv::Mat& VehicleDetector::preprocessFrame(const cv::Mat& frame) {
+    return inputBlob_.prepare(frame, inputSize_);
 }
 
-std::vector<Detection> VehicleDetector::postprocessDetections(const cv::Mat& frame, 
-                                                             const std::vector<cv::Mat>& outputs) {
+std::vector<Detection> VehicleDetector::postprocessDetections(const std::vector<cv::Mat>& outputs,
+                                                             float threshold) {
+    // Outputs are relative to the letterboxed input, not the frame
+    const LetterboxTransform& letterbox = inputBlob_.transform();
     std::vector<Detection> detections;
     std::vector<int> classIds;
     std::vector<float> confidences;
@@ -144,31 +297,25 @@ std::vector<Detection> VehicleDetector::postprocessDetections(const cv::Mat& fra
             double confidence;
             cv::minMaxLoc(scores, 0, &confidence, 0, &classIdPoint);
             
-            if (confidence > confidenceThreshold_) {
-                int centerX = (int)(data[0] * frame.cols);
-                int centerY = (int)(data[1] * frame.rows);
-                int width = (int)(data[2] * frame.cols);
-                int height = (int)(data[3] * frame.rows);
-                int left = centerX - width / 2;
-                int top = centerY - height / 2;
-                
+            if (confidence > threshold) {
                 classIds.push_back(classIdPoint.x);
                 confidences.push_back((float)confidence);
-                boxes.push_back(cv::Rect(left, top, width, height));
+                boxes.push_back(letterbox.toFrame(data[0] * inputSize_.width, data[1] * inputSize_.height,
+                                                  data[2] * inputSize_.width, data[3] * inputSize_.height));
             }
         }
     }
     
     // Apply Non-Maximum Suppression
     std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, confidenceThreshold_, nmsThreshold_, indices);
+    cv::dnn::NMSBoxes(boxes, confidences, threshold, nmsThreshold_, indices);
     
     for (int idx : indices) {
         Detection det;
         det.boundingBox = boxes[idx];
         det.confidence = confidences[idx];
         det.classId = classIds[idx];
-        det.label = (det.classId < classNames_.size()) ? classNames_[det.classId] : "unknown";
+        det.label = labelForClass(det.classId);
         
         // Only include vehicles (car, truck, bus, motorcycle)
         if (det.classId == 2 || det.classId == 7 || det.classId == 5 || det.classId == 3) {
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "LatencyHistogram.h"
+#include "LabelTable.h"
+#include "LetterboxBlob.h"
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <memory>
@@ -8,30 +11,83 @@ struct Detection {
     cv::Rect boundingBox;
     float confidence;
     int classId;
-    std::string label;
+    LabelId label;  // Interned class name
 };
 
+// Detector model files, read into memory once. Detectors built from the
+// same DetectorModel share these bytes read-only; each still parses them
+// into a network of its own.
+struct DetectorModel {
+    std::string configPath;
+    std::string modelPath;
+    std::vector<uchar> config;
+    std::vector<uchar> weights;
+    uint64_t contentHash = 0;  // Of config and weights; retrained files at the same paths differ
+};
+
+// One instance per thread: the network, input blob and HOG scanner are
+// per-instance state. DetectorPool runs several instances in parallel.
 class VehicleDetector {
 public:
     VehicleDetector();
     ~VehicleDetector();
     
+    // Bundled YOLO files, or null when they are missing
+    static std::shared_ptr<const DetectorModel> loadDefaultModel();
+    
     bool initialize();
+    // Builds the network from model; null selects the HOG fallback
+    bool initialize(std::shared_ptr<const DetectorModel> model);
     std::vector<Detection> detectVehicles(const cv::Mat& frame);
+    // Scans only the given regions of frame (see MotionGate) and returns
+    // boxes in frame pixels, with NMS across overlapping regions. An empty
+    // list scans the whole frame.
+    std::vector<Detection> detectVehiclesInRegions(const cv::Mat& frame, const std::vector<cv::Rect>& regions);
     void setConfidenceThreshold(float threshold);
     void setNMSThreshold(float threshold);
+    float getConfidenceThreshold() const;
+    
+    // Detections above a floor threshold, after NMS. Greedy NMS never lets a
+    // lower-scoring box suppress a higher one, so filtering this list by a
+    // higher threshold gives exactly what detectVehicles would return.
+    std::vector<Detection> detectVehiclesRaw(const cv::Mat& frame, float floorThreshold);
+    static std::vector<Detection> filterByConfidence(const std::vector<Detection>& detections,
+                                                     float threshold);
+    
+    // Identifies everything detections depend on: model files, input size
+    // and NMS threshold. Used to key cached detections.
+    std::string getModelFingerprint() const;
+    // The same for any detector built from model (null: HOG fallback)
+    static std::string fingerprintFor(const DetectorModel* model, const cv::Size& inputSize,
+                                      float nmsThreshold);
+    cv::Size getInputSize() const;
+    LabelId labelForClass(int classId) const;
+    
+    // Records preprocess/inference/postprocess times; null disables
+    void setLatencyStats(LatencyStats* stats);
     
 private:
     cv::dnn::Net net_;
+    std::shared_ptr<const DetectorModel> model_;
+    std::vector<cv::String> outputNames_;
+    cv::HOGDescriptor hog_;             // Used when there is no network
     std::vector<std::string> classNames_;
+    std::vector<LabelId> classLabels_;  // classNames_, interned
+    LabelId vehicleLabel_;              // HOG fallback's only class
     float confidenceThreshold_;
     float nmsThreshold_;
     cv::Size inputSize_;
+    LatencyStats* latencyStats_;
+    LetterboxBlob inputBlob_;           // Network input, reused across frames
     
-    std::vector<cv::String> getOutputsNames();
-    void preprocessFrame(const cv::Mat& frame, cv::Mat& blob);
-    std::vector<Detection> postprocessDetections(const cv::Mat& frame, 
-                                                const std::vector<cv::Mat>& outputs);
+    std::vector<Detection> detect(const cv::Mat& frame, float threshold);
+    std::vector<Detection> detectRegions(const cv::Mat& frame, const std::vector<cv::Rect>& regions,
+                                         float threshold);
+    // Letterboxed input blob for frame; valid until the next call
+    const cv::Mat& preprocessFrame(const cv::Mat& frame);
+    // Boxes in frame pixels, undoing the letterbox of the last preprocessFrame()
+    std::vector<Detection> postprocessDetections(const std::vector<cv::Mat>& outputs,
+                                                float threshold);
     void drawDetections(cv::Mat& frame, const std::vector<Detection>& detections);
-    std::vector<Detection> detectVehiclesHOG(const cv::Mat& frame);
+    std::vector<Detection> detectVehiclesHOG(const cv::Mat& frame, float threshold);
 }; 
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "VideoIngest.h"
+#include <algorithm>
+#include <vector>
+
+VideoIngest::VideoIngest()
+    : decodeThreads_(0), hardwareDecode_(false), decodedFrames_(0), skippedFrames_(0) {
+}
+
+VideoIngest::~VideoIngest() {
+    release();
+}
+
+void VideoIngest::setDecodeThreads(int threads) {
+    decodeThreads_ = std::max(0, threads);
+}
+
+void VideoIngest::setHardwareDecode(bool enable) {
+    hardwareDecode_ = enable;
+}
+
+bool VideoIngest::open(const std::string& path) {
+    release();
+    
+    std::vector<int> params;
+    if (decodeThreads_ > 0) {
+        params.push_back(cv::CAP_PROP_N_THREADS);
+        params.push_back(decodeThreads_);
+    }
+    if (hardwareDecode_) {
+        params.push_back(cv::CAP_PROP_HW_ACCELERATION);
+        params.push_back(cv::VIDEO_ACCELERATION_ANY);
+    }
+    
+    // Other backends reject these parameters; let them open the file plain
+    if (capture_.open(path, cv::CAP_FFMPEG, params)) {
+        return true;
+    }
+    return capture_.open(path);
+}
+
+bool VideoIngest::open(int cameraIndex) {
+    release();
+    return capture_.open(cameraIndex);
+}
+
+bool VideoIngest::isOpened() const {
+    return capture_.isOpened();
+}
+
+void VideoIngest::release() {
+    if (capture_.isOpened()) {
+        capture_.release();
+    }
+    decodedFrames_ = 0;
+    skippedFrames_ = 0;
+}
+
+bool VideoIngest::read(cv::Mat& frame) {
+    if (!capture_.grab() || !capture_.retrieve(frame) || frame.empty()) {
+        return false;
+    }
+    decodedFrames_++;
+    return true;
+}
+
+bool VideoIngest::skip() {
+    if (!capture_.grab()) {
+        return false;
+    }
+    skippedFrames_++;
+    return true;
+}
+
+bool VideoIngest::seek(int frameIndex) {
+    return capture_.set(cv::CAP_PROP_POS_FRAMES, frameIndex);
+}
+
+double VideoIngest::getTimestampMs() const {
+    return capture_.get(cv::CAP_PROP_POS_MSEC);
+}
+
+double VideoIngest::getFPS() const {
+    double fps = capture_.get(cv::CAP_PROP_FPS);
+    return fps > 0.0 ? fps : 0.0;
+}
+
+int VideoIngest::getFrameCount() const {
+    return std::max(0, static_cast<int>(capture_.get(cv::CAP_PROP_FRAME_COUNT)));
+}
+
+uint64_t VideoIngest::getDecodedFrames() const {
+    return decodedFrames_;
+}
+
+uint64_t VideoIngest::getSkippedFrames() const {
+    return skippedFrames_;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+
+// Video file and camera input for the batch pipeline.
+//
+// Frames nobody will look at are stepped over with grab() alone. The codec
+// still decodes them, since later frames reference them, but the colour
+// conversion to BGR and the copy out of the decoder are skipped; on 4K that
+// is a large share of the per-frame cost outside the codec. read() converts
+// into the caller's Mat, so a reused Mat is not reallocated. Files open on
+// the FFmpeg backend with the decoder thread count and hardware decoding
+// set at open time, where FFmpeg takes them.
+class VideoIngest {
+public:
+    VideoIngest();
+    ~VideoIngest();
+
+    // Take effect on the next open(); 0 threads leaves the count to FFmpeg
+    void setDecodeThreads(int threads);
+    void setHardwareDecode(bool enable);
+
+    bool open(const std::string& path);
+    bool open(int cameraIndex);
+    bool isOpened() const;
+    void release();
+
+    // Next frame as BGR; false at the end of the stream
+    bool read(cv::Mat& frame);
+    // Moves past the next frame without converting it
+    bool skip();
+    // The next read() or skip() returns frameIndex
+    bool seek(int frameIndex);
+
+    // Presentation time of the frame last read or skipped. Some backends
+    // (most cameras) report 0 throughout.
+    double getTimestampMs() const;
+    double getFPS() const;       // 0 when unknown
+    int getFrameCount() const;   // 0 for cameras
+    uint64_t getDecodedFrames() const;
+    uint64_t getSkippedFrames() const;
+
+private:
+    cv::VideoCapture capture_;
+    int decodeThreads_;
+    bool hardwareDecode_;
+    uint64_t decodedFrames_;
+    uint64_t skippedFrames_;
+};
@@ -1,4 +1,5 @@
 #include "AdvancedCarTracker.h"
+#include "Tracer.h"
 #include <iostream>
 #include <string>
 
@@ -22,12 +23,30 @@ void printAdvancedUsage(const std::string& programName) {
     std::cout << "  --frame-skip <value>             Process every Nth frame (default: 1)" << std::endl;
     std::cout << "  --realtime-mode                  Enable real-time processing mode" << std::endl;
     std::cout << "  --resolution-scale <value>         Scale resolution (0.1-1.0, default: 1.0)" << std::endl;
+    std::cout << "  --motion-gate                    Detect only in regions that moved since the last frame" << std::endl;
+    std::cout << "  --full-scan-every <frames>       Whole-frame detection interval with --motion-gate (default: 15)" << std::endl;
+    std::cout << "  --decode-threads <n>             FFmpeg decoder threads for video files (default: FFmpeg's choice)" << std::endl;
+    std::cout << "  --hw-decode                      Decode video files on the GPU when the backend supports it" << std::endl;
+    std::cout << "  --shm-input <name>               Read raw frames from a shared-memory ring instead of a file" << std::endl;
+    std::cout << "  --track-log <path>               Append every track state to a columnar log (see track_query)" << std::endl;
+    std::cout << "  --export-mot <path>              Write tracks in MOTChallenge format" << std::endl;
+    std::cout << "  --export-csv <path>              Write tracks as CSV" << std::endl;
+    std::cout << "  --detection-cache <dir>          Cache detections per video; re-runs skip the detector" << std::endl;
+    std::cout << "  --cache-source <file>            Original video to key the cache on when using --shm-input" << std::endl;
+    std::cout << "  --headless                       Don't open any windows (servers, benchmarks)" << std::endl;
+    std::cout << "  --trace <path>                   Write a Chrome/Perfetto timeline of every pipeline stage" << std::endl;
+    std::cout << "  --camera <index>                 Capture from a camera instead of a file" << std::endl;
+    std::cout << "  --metrics <endpoint>             Serve Prometheus metrics on [host:]port or unix:<path>" << std::endl;
+    std::cout << "  --snapshots <path>               Save the tracker state to this file periodically" << std::endl;
+    std::cout << "  --snapshot-every <frames>        Frames between snapshots (default: 300)" << std::endl;
+    std::cout << "  --resume                         Continue a killed run from its last snapshot" << std::endl;
     std::cout << std::endl;
     std::cout << "Interactive Controls:" << std::endl;
     std::cout << "  Mouse Click: Select target vehicle" << std::endl;
     std::cout << "  C: Clear primary target" << std::endl;
     std::cout << "  T: Toggle target selection mode" << std::endl;
     std::cout << "  I: Show track information" << std::endl;
+    std::cout << "  L: Print stage latency percentiles" << std::endl;
     std::cout << "  A: Toggle advanced features" << std::endl;
     std::cout << "  P: Pause/Resume" << std::endl;
     std::cout << "  ESC: Exit" << std::endl;
@@ -47,6 +66,23 @@ int main(int argc, char* argv[]) {
     int frameSkip = 1;  // Process every frame by default
     bool realtimeMode = false;
     float resolutionScale = 1.0f;
+    bool motionGate = false;
+    int fullScanInterval = 15;
+    int decodeThreads = 0;
+    bool hardwareDecode = false;
+    std::string shmInput = "";
+    std::string trackLogPath = "";
+    std::string exportMotPath = "";
+    std::string exportCsvPath = "";
+    std::string detectionCacheDir = "";
+    std::string cacheSourcePath = "";
+    bool headless = false;
+    std::string tracePath = "";
+    int cameraIndex = -1;
+    std::string metricsEndpoint = "";
+    std::string snapshotPath = "";
+    int snapshotInterval = 300;
+    bool resume = false;
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -69,6 +105,40 @@ int main(int argc, char* argv[]) {
             realtimeMode = true;
         } else if (arg == "--resolution-scale") {
             if (i + 1 < argc) resolutionScale = std::stof(argv[++i]);
+        } else if (arg == "--motion-gate") {
+            motionGate = true;
+        } else if (arg == "--full-scan-every") {
+            if (i + 1 < argc) fullScanInterval = std::stoi(argv[++i]);
+        } else if (arg == "--decode-threads") {
+            if (i + 1 < argc) decodeThreads = std::stoi(argv[++i]);
+        } else if (arg == "--hw-decode") {
+            hardwareDecode = true;
+        } else if (arg == "--shm-input") {
+            if (i + 1 < argc) shmInput = argv[++i];
+        } else if (arg == "--track-log") {
+            if (i + 1 < argc) trackLogPath = argv[++i];
+        } else if (arg == "--export-mot") {
+            if (i + 1 < argc) exportMotPath = argv[++i];
+        } else if (arg == "--export-csv") {
+            if (i + 1 < argc) exportCsvPath = argv[++i];
+        } else if (arg == "--detection-cache") {
+            if (i + 1 < argc) detectionCacheDir = argv[++i];
+        } else if (arg == "--cache-source") {
+            if (i + 1 < argc) cacheSourcePath = argv[++i];
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--trace") {
+            if (i + 1 < argc) tracePath = argv[++i];
+        } else if (arg == "--camera") {
+            if (i + 1 < argc) cameraIndex = std::stoi(argv[++i]);
+        } else if (arg == "--metrics") {
+            if (i + 1 < argc) metricsEndpoint = argv[++i];
+        } else if (arg == "--snapshots") {
+            if (i + 1 < argc) snapshotPath = argv[++i];
+        } else if (arg == "--snapshot-every") {
+            if (i + 1 < argc) snapshotInterval = std::stoi(argv[++i]);
+        } else if (arg == "--resume") {
+            resume = true;
         } else if (arg == "--help") {
             std::cout << "Advanced Car Chase Tracking System\n";
             std::cout << "Usage: " << argv[0] << " [options]\n";
@@ -82,6 +152,23 @@ int main(int argc, char* argv[]) {
             std::cout << "  --frame-skip <value>         Process every Nth frame (default: 1)\n";
             std::cout << "  --realtime-mode              Enable real-time processing mode\n";
             std::cout << "  --resolution-scale <value>   Scale resolution (0.1-1.0, default: 1.0)\n";
+            std::cout << "  --motion-gate                Detect only in regions that moved\n";
+            std::cout << "  --full-scan-every <frames>   Whole-frame detection interval (default: 15)\n";
+            std::cout << "  --decode-threads <n>         FFmpeg decoder threads for video files\n";
+            std::cout << "  --hw-decode                  Decode video files on the GPU when supported\n";
+            std::cout << "  --shm-input <name>           Read raw frames from a shared-memory ring\n";
+            std::cout << "  --track-log <path>           Append track states to a columnar log\n";
+            std::cout << "  --export-mot <path>          Write tracks in MOTChallenge format\n";
+            std::cout << "  --export-csv <path>          Write tracks as CSV\n";
+            std::cout << "  --detection-cache <dir>      Reuse detections from earlier runs on the same video\n";
+            std::cout << "  --cache-source <file>        Original video to key the cache on with --shm-input\n";
+            std::cout << "  --headless                   Don't open any windows\n";
+            std::cout << "  --trace <path>               Write a Chrome trace (chrome://tracing, Perfetto)\n";
+            std::cout << "  --camera <index>             Capture from a camera instead of a file\n";
+            std::cout << "  --metrics <endpoint>         Serve Prometheus metrics on [host:]port or unix:<path>\n";
+            std::cout << "  --snapshots <path>           Save the tracker state to this file periodically\n";
+            std::cout << "  --snapshot-every <frames>    Frames between snapshots (default: 300)\n";
+            std::cout << "  --resume                     Continue a killed run from its last snapshot\n";
             std::cout << "  --help                       Show this help\n";
             return 0;
         }
@@ -89,7 +176,8 @@ int main(int argc, char* argv[]) {
     
     std::cout << "🚗🚁 Advanced Car Chase Tracking System\n";
     std::cout << "=====================================\n";
-    std::cout << "Input: " << inputVideo << std::endl;
+    std::cout << "Input: " << (cameraIndex >= 0 ? "camera:" + std::to_string(cameraIndex)
+                               : shmInput.empty() ? inputVideo : "shm:" + shmInput) << std::endl;
     std::cout << "Output: " << outputVideo << std::endl;
     std::cout << "Detection Threshold: " << detectionThreshold << std::endl;
     std::cout << "Occlusion Threshold: " << occlusionThreshold << std::endl;
@@ -98,16 +186,35 @@ int main(int argc, char* argv[]) {
     std::cout << "Frame Skip: " << frameSkip << std::endl;
     std::cout << "Real-time Mode: " << (realtimeMode ? "Enabled" : "Disabled") << std::endl;
     std::cout << "Resolution Scale: " << resolutionScale << std::endl;
+    if (motionGate) {
+        std::cout << "Motion Gate: full scan every " << fullScanInterval << " frames" << std::endl;
+    }
     std::cout << std::endl;
     
     // Initialize advanced tracking system
     AdvancedCarTracker tracker;
+    tracker.setHeadless(headless);
+    tracker.setDecodeOptions(decodeThreads, hardwareDecode);
     
-    if (!tracker.initialize(inputVideo)) {
+    bool initialized = cameraIndex >= 0 ? tracker.initializeCamera(cameraIndex)
+                       : shmInput.empty() ? tracker.initialize(inputVideo)
+                                          : tracker.initializeSharedMemory(shmInput);
+    if (!initialized) {
         std::cerr << "Failed to initialize advanced car tracker!" << std::endl;
         return -1;
     }
     
+    if (resume && snapshotPath.empty()) {
+        std::cerr << "--resume needs --snapshots <path>" << std::endl;
+        return -1;
+    }
+    if (resume && !tracker.resumeFromSnapshot(snapshotPath)) {
+        return -1;
+    }
+    if (!snapshotPath.empty()) {
+        tracker.setSnapshotFile(snapshotPath, snapshotInterval);
+    }
+    
     // Set advanced parameters
     tracker.setOcclusionThreshold(occlusionThreshold);
     tracker.setReIdThreshold(reidThreshold);
@@ -115,11 +222,46 @@ int main(int argc, char* argv[]) {
     tracker.setFrameSkip(frameSkip);
     tracker.setRealtimeMode(realtimeMode);
     tracker.setResolutionScale(resolutionScale);
+    tracker.setMotionGate(motionGate, fullScanInterval);
+    tracker.setDetectionThreshold(detectionThreshold);
+    if (!detectionCacheDir.empty()) {
+        tracker.setDetectionCache(detectionCacheDir, cacheSourcePath);
+    }
+    if (!trackLogPath.empty() && !tracker.setTrackLogPath(trackLogPath)) {
+        std::cerr << "Failed to open track log!" << std::endl;
+        return -1;
+    }
+    if (!exportMotPath.empty() && !tracker.addExporter(exportMotPath, ExportFormat::MOTChallenge)) {
+        std::cerr << "Failed to open MOT export file!" << std::endl;
+        return -1;
+    }
+    if (!exportCsvPath.empty() && !tracker.addExporter(exportCsvPath, ExportFormat::CSV)) {
+        std::cerr << "Failed to open CSV export file!" << std::endl;
+        return -1;
+    }
+    
+    if (!metricsEndpoint.empty() && !tracker.startMetricsServer(metricsEndpoint)) {
+        std::cerr << "Failed to start metrics endpoint!" << std::endl;
+        return -1;
+    }
+    
+    if (!tracePath.empty()) {
+        Tracer::setThreadName("pipeline");
+        if (!Tracer::start(tracePath)) {
+            return -1;
+        }
+    }
     
     std::cout << "Starting advanced tracking with real-time optimizations..." << std::endl;
     
     // Process video
-    if (!tracker.processVideo()) {
+    bool processed = tracker.processVideo();
+    
+    // Flush the exporter threads before the trace is written
+    tracker.stop();
+    Tracer::stop();
+    
+    if (!processed) {
         std::cerr << "Failed to process video!" << std::endl;
         return -1;
     }
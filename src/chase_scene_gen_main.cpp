@@ -0,0 +1,151 @@
+#include "SyntheticScene.h"
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+void printGeneratorUsage(const std::string& programName) {
+    std::cout << "Synthetic Chase Scene Generator" << std::endl;
+    std::cout << "===============================" << std::endl;
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Output:" << std::endl;
+    std::cout << "  -o, --output <video>         Video file (default: synthetic_chase.avi, MJPG)" << std::endl;
+    std::cout << "  --frames-dir <dir>           Write numbered PNG frames instead of a video" << std::endl;
+    std::cout << "  --gt <path>                  Ground truth in MOTChallenge format (default: <output>.gt.txt)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Scene:" << std::endl;
+    std::cout << "  --size <w>x<h>               Frame size (default: 1280x720)" << std::endl;
+    std::cout << "  --frames <n>                 Number of frames (default: 300)" << std::endl;
+    std::cout << "  --fps <value>                Frame rate (default: 30)" << std::endl;
+    std::cout << "  --vehicles <n>               Vehicle count (default: 20)" << std::endl;
+    std::cout << "  --speed <min>,<max>          Vehicle speed in pixels/frame (default: 2,8)" << std::endl;
+    std::cout << "  --occluders <n>              Overpasses/trees hiding traffic (default: 6)" << std::endl;
+    std::cout << "  --pan <dx>,<dy>              Camera pan in pixels/frame (default: 1.5,0.5)" << std::endl;
+    std::cout << "  --zoom <amplitude>           Zoom oscillation, 0.1 = +/-10% (default: 0.1)" << std::endl;
+    std::cout << "  --zoom-period <frames>       Frames per zoom cycle (default: 240)" << std::endl;
+    std::cout << "  --seed <n>                   Random seed (default: 1)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Example:" << std::endl;
+    std::cout << "  " << programName << " -o dense.avi --vehicles 200 --frames 600 --size 1920x1080" << std::endl;
+}
+
+bool parsePair(const std::string& text, char separator, float& first, float& second) {
+    std::istringstream stream(text);
+    char sep = 0;
+    return static_cast<bool>(stream >> first >> sep >> second) && sep == separator;
+}
+
+int main(int argc, char* argv[]) {
+    SyntheticSceneConfig config;
+    std::string outputPath = "synthetic_chase.avi";
+    std::string framesDir;
+    std::string groundTruthPath;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                printGeneratorUsage(argv[0]);
+                return 0;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Error: Missing argument for " << arg << std::endl;
+                return 1;
+            }
+            std::string value = argv[++i];
+            float a = 0.0f, b = 0.0f;
+            if (arg == "-o" || arg == "--output") {
+                outputPath = value;
+            } else if (arg == "--frames-dir") {
+                framesDir = value;
+            } else if (arg == "--gt") {
+                groundTruthPath = value;
+            } else if (arg == "--size" && parsePair(value, 'x', a, b)) {
+                config.width = static_cast<int>(a);
+                config.height = static_cast<int>(b);
+            } else if (arg == "--frames") {
+                config.frameCount = std::stoi(value);
+            } else if (arg == "--fps") {
+                config.fps = std::stod(value);
+            } else if (arg == "--vehicles") {
+                config.vehicleCount = std::stoi(value);
+            } else if (arg == "--speed" && parsePair(value, ',', a, b)) {
+                config.minSpeed = a;
+                config.maxSpeed = b;
+            } else if (arg == "--occluders") {
+                config.occluderCount = std::stoi(value);
+            } else if (arg == "--pan" && parsePair(value, ',', a, b)) {
+                config.panVelocity = cv::Point2f(a, b);
+            } else if (arg == "--zoom") {
+                config.zoomAmplitude = std::stof(value);
+            } else if (arg == "--zoom-period") {
+                config.zoomPeriod = std::stoi(value);
+            } else if (arg == "--seed") {
+                config.seed = static_cast<unsigned>(std::stoul(value));
+            } else {
+                std::cerr << "Error: Unknown or malformed argument " << arg << " " << value << std::endl;
+                printGeneratorUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid numeric argument" << std::endl;
+        return 1;
+    }
+
+    if (config.width < 64 || config.height < 64 || config.frameCount < 1) {
+        std::cerr << "Error: Frame size must be at least 64x64 and frames at least 1" << std::endl;
+        return 1;
+    }
+    if (groundTruthPath.empty()) {
+        groundTruthPath = (framesDir.empty() ? outputPath : framesDir + "/gt") + ".gt.txt";
+    }
+
+    SyntheticScene scene(config);
+
+    cv::VideoWriter writer;
+    if (framesDir.empty()) {
+        writer.open(outputPath, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), config.fps,
+                    cv::Size(config.width, config.height));
+        if (!writer.isOpened()) {
+            std::cerr << "Error: Could not open video writer: " << outputPath << std::endl;
+            return 1;
+        }
+    }
+
+    FILE* groundTruth = std::fopen(groundTruthPath.c_str(), "w");
+    if (!groundTruth) {
+        std::cerr << "Error: Could not write ground truth: " << groundTruthPath << std::endl;
+        return 1;
+    }
+
+    cv::Mat frame;
+    FrameBoxes boxes;
+    std::vector<float> visibility;
+    char name[64];
+    for (int index = 0; index < config.frameCount; ++index) {
+        scene.renderFrame(index, frame, boxes, visibility);
+        SyntheticScene::writeGroundTruthRows(groundTruth, index, boxes, visibility);
+
+        if (writer.isOpened()) {
+            writer.write(frame);
+        } else {
+            std::snprintf(name, sizeof(name), "/%06d.png", index + 1);
+            if (!cv::imwrite(framesDir + name, frame)) {
+                std::cerr << "Error: Could not write frame to " << framesDir << std::endl;
+                std::fclose(groundTruth);
+                return 1;
+            }
+        }
+
+        if ((index + 1) % 100 == 0) {
+            std::cout << "Rendered " << (index + 1) << "/" << config.frameCount << " frames" << std::endl;
+        }
+    }
+
+    std::fclose(groundTruth);
+    std::cout << "Scene written to " << (framesDir.empty() ? outputPath : framesDir) << std::endl;
+    std::cout << "Ground truth written to " << groundTruthPath << std::endl;
+    return 0;
+}
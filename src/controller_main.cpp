@@ -10,6 +10,8 @@ void printControllerUsage(const std::string& programName) {
     std::cout << "Options:" << std::endl;
     std::cout << "  -i, --input <video_path>     Input video file" << std::endl;
     std::cout << "  -o, --output <output_path>   Output video file" << std::endl;
+    std::cout << "  --detection-cache <dir>      Cache detections so parameter changes skip the detector" << std::endl;
+    std::cout << "  --snapshots <path>           Seek using tracker snapshots from an advanced_car_tracker run" << std::endl;
     std::cout << "  --help                       Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Interactive Controls:" << std::endl;
@@ -21,6 +23,9 @@ void printControllerUsage(const std::string& programName) {
     std::cout << "  C: Toggle camera motion compensation" << std::endl;
     std::cout << "  D: Toggle debug information" << std::endl;
     std::cout << "  V: Toggle video recording" << std::endl;
+    std::cout << "  , / .: Step one frame back / forward" << std::endl;
+    std::cout << "  [ / ]: Jump five seconds back / forward" << std::endl;
+    std::cout << "  + / -: Double / halve playback speed" << std::endl;
     std::cout << "  Mouse Click: Select target vehicle" << std::endl;
     std::cout << "  ESC: Exit application" << std::endl;
     std::cout << std::endl;
@@ -46,6 +51,8 @@ void onStatusUpdate(const std::string& status) {
 int main(int argc, char* argv[]) {
     std::string inputVideo = "";
     std::string outputVideo = "";
+    std::string detectionCacheDir = "";
+    std::string snapshotPath = "";
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -68,6 +75,20 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: Missing argument for " << arg << std::endl;
                 return 1;
             }
+        } else if (arg == "--detection-cache") {
+            if (i + 1 < argc) {
+                detectionCacheDir = argv[++i];
+            } else {
+                std::cerr << "Error: Missing argument for " << arg << std::endl;
+                return 1;
+            }
+        } else if (arg == "--snapshots") {
+            if (i + 1 < argc) {
+                snapshotPath = argv[++i];
+            } else {
+                std::cerr << "Error: Missing argument for " << arg << std::endl;
+                return 1;
+            }
         } else {
             std::cerr << "Error: Unknown argument " << arg << std::endl;
             printControllerUsage(argv[0]);
@@ -90,6 +111,8 @@ int main(int argc, char* argv[]) {
     // Set up callbacks
     controller.setVideoLoadedCallback(onVideoLoaded);
     controller.setStatusUpdateCallback(onStatusUpdate);
+    controller.setDetectionCacheDir(detectionCacheDir);
+    controller.setSnapshotFile(snapshotPath);
     
     // Load video if specified
     if (!inputVideo.empty()) {
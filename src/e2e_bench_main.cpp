@@ -0,0 +1,306 @@
+#include "AdvancedCarTracker.h"
+#include "SyntheticScene.h"
+#include "TrackingMetrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+struct E2EResult {
+    int vehicles;
+    int frames;
+    double fps;
+    MOTSummary accuracy;
+    // p50/p95/p99 in milliseconds per LatencyStage
+    double percentiles[LatencyStats::kStageCount][3];
+};
+
+const double kReportedPercentiles[] = {50.0, 95.0, 99.0};
+
+void printE2EUsage(const std::string& programName) {
+    std::cout << "End-to-end Tracker Benchmark" << std::endl;
+    std::cout << "============================" << std::endl;
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Renders a synthetic chase scene per vehicle density, runs the advanced" << std::endl;
+    std::cout << "tracker over it headless and reports FPS, per-stage latency and ID accuracy." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --vehicles <list>            Vehicle densities to run (default: 10,50,200)" << std::endl;
+    std::cout << "  --frames <n>                 Frames per scene (default: 300)" << std::endl;
+    std::cout << "  --size <w>x<h>               Frame size (default: 1280x720)" << std::endl;
+    std::cout << "  --seed <n>                   Scene seed (default: 1)" << std::endl;
+    std::cout << "  --workdir <dir>              Scenes, ground truth and tracks (default: e2e_bench_work)" << std::endl;
+    std::cout << "  -m, --model <path>           Detector weights (default: HOG fallback)" << std::endl;
+    std::cout << "  --oracle                     Feed jittered ground truth as detections; times the" << std::endl;
+    std::cout << "                               tracker without depending on the detector" << std::endl;
+    std::cout << "  --csv <path>                 Write results as CSV" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Example:" << std::endl;
+    std::cout << "  " << programName << " --oracle --vehicles 10,100,500 --size 1920x1080" << std::endl;
+}
+
+// Ground truth as a detector would report it: boxes jittered by a few
+// pixels and an occasional miss, hidden vehicles left out
+std::vector<Detection> oracleDetections(const FrameBoxes& groundTruth, const std::vector<float>& visibility,
+                                        std::mt19937& rng) {
+    std::normal_distribution<float> jitter(0.0f, 2.0f);
+    std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+
+    std::vector<Detection> detections;
+    for (size_t i = 0; i < groundTruth.size(); ++i) {
+        if (visibility[i] < SyntheticScene::kMinVisibleFraction || chance(rng) < 0.05f) continue;
+        const cv::Rect& box = groundTruth[i].second;
+        Detection detection;
+        detection.boundingBox = cv::Rect(box.x + cvRound(jitter(rng)), box.y + cvRound(jitter(rng)),
+                                         std::max(1, box.width + cvRound(jitter(rng))),
+                                         std::max(1, box.height + cvRound(jitter(rng))));
+        detection.confidence = 0.6f + 0.4f * visibility[i];
+        detection.classId = 2;
+        detections.push_back(detection);
+    }
+    return detections;
+}
+
+bool runDensity(const SyntheticSceneConfig& config, const std::string& workdir, const std::string& modelPath,
+                bool oracle, E2EResult& result) {
+    std::string stem = workdir + "/chase_v" + std::to_string(config.vehicleCount);
+    std::string videoPath = stem + ".avi";
+    std::string groundTruthPath = stem + ".gt.txt";
+    std::string tracksPath = stem + (oracle ? ".oracle" : "") + ".tracks.txt";
+
+    std::cout << std::endl << "=== " << config.vehicleCount << " vehicles ===" << std::endl;
+
+    // Render the scene; oracle detections come from the same pass
+    SyntheticScene scene(config);
+    cv::VideoWriter writer(videoPath, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), config.fps,
+                           cv::Size(config.width, config.height));
+    FILE* groundTruth = std::fopen(groundTruthPath.c_str(), "w");
+    if (!writer.isOpened() || !groundTruth) {
+        std::cerr << "Error: Could not write scene to " << stem << std::endl;
+        if (groundTruth) std::fclose(groundTruth);
+        return false;
+    }
+
+    std::vector<std::vector<Detection>> detections;
+    std::mt19937 rng(config.seed);
+    cv::Mat frame;
+    FrameBoxes boxes;
+    std::vector<float> visibility;
+    for (int index = 0; index < config.frameCount; ++index) {
+        scene.renderFrame(index, frame, boxes, visibility);
+        SyntheticScene::writeGroundTruthRows(groundTruth, index, boxes, visibility);
+        writer.write(frame);
+        if (oracle) {
+            detections.push_back(oracleDetections(boxes, visibility, rng));
+        }
+    }
+    std::fclose(groundTruth);
+    writer.release();
+
+    AdvancedCarTracker tracker;
+    tracker.setHeadless(true);
+    if (oracle) {
+        tracker.setDetectionCache(workdir + "/oracle_cache");
+    }
+    if (!tracker.initialize(videoPath, modelPath) || !tracker.addExporter(tracksPath, ExportFormat::MOTChallenge)) {
+        return false;
+    }
+
+    if (oracle) {
+        DetectionCache* cache = tracker.getDetectionCache();
+        if (!cache) {
+            std::cerr << "Error: Could not open the oracle detection cache" << std::endl;
+            return false;
+        }
+        // The cache is keyed on the video fingerprint, so an identical scene
+        // from an earlier run is already filled
+        if (cache->getCachedFrameCount() < detections.size()) {
+            for (size_t index = 0; index < detections.size(); ++index) {
+                cache->store(static_cast<int>(index), detections[index]);
+            }
+        }
+    }
+
+    bool processed = tracker.processVideo();
+    tracker.stop();
+    if (!processed) return false;
+
+    std::map<int, FrameBoxes> truthFrames;
+    std::map<int, FrameBoxes> trackFrames;
+    if (!loadMOTFile(groundTruthPath, truthFrames) || !loadMOTFile(tracksPath, trackFrames)) {
+        std::cerr << "Error: Could not read back " << groundTruthPath << " or " << tracksPath << std::endl;
+        return false;
+    }
+    MOTAccumulator accumulator;
+    const FrameBoxes empty;
+    for (int number = 1; number <= config.frameCount; ++number) {
+        auto truth = truthFrames.find(number);
+        auto tracks = trackFrames.find(number);
+        accumulator.addFrame(truth != truthFrames.end() ? truth->second : empty,
+                             tracks != trackFrames.end() ? tracks->second : empty);
+    }
+
+    const LatencyStats& latency = tracker.getLatencyStats();
+    result.vehicles = config.vehicleCount;
+    result.frames = static_cast<int>(latency.get(LatencyStage::Frame).getCount());
+    result.fps = tracker.getAverageFPS();
+    result.accuracy = accumulator.summary();
+    for (int stage = 0; stage < LatencyStats::kStageCount; ++stage) {
+        const LatencyHistogram& histogram = latency.get(static_cast<LatencyStage>(stage));
+        for (int i = 0; i < 3; ++i) {
+            result.percentiles[stage][i] = histogram.getPercentile(kReportedPercentiles[i]) / 1e6;
+        }
+    }
+    return true;
+}
+
+void printResults(const std::vector<E2EResult>& results) {
+    std::cout << std::endl << "Results" << std::endl;
+    std::cout << std::left << std::setw(10) << "vehicles" << std::setw(10) << "fps"
+              << std::setw(10) << "MOTA" << std::setw(10) << "IDF1" << std::setw(10) << "IDsw" << std::endl;
+    for (const auto& result : results) {
+        std::cout << std::left << std::fixed << std::setprecision(3)
+                  << std::setw(10) << result.vehicles << std::setw(10) << std::setprecision(1) << result.fps
+                  << std::setprecision(3) << std::setw(10) << result.accuracy.mota
+                  << std::setw(10) << result.accuracy.idf1 << std::setw(10) << result.accuracy.idSwitches << std::endl;
+    }
+
+    // One row per stage, one column per density
+    std::cout << std::endl << "Stage latency p50/p95/p99 (ms)" << std::endl;
+    std::cout << std::left << std::setw(15) << "stage";
+    for (const auto& result : results) {
+        std::cout << std::setw(24) << (std::to_string(result.vehicles) + " vehicles");
+    }
+    std::cout << std::endl;
+    for (int stage = 0; stage < LatencyStats::kStageCount; ++stage) {
+        bool timed = false;
+        for (const auto& result : results) {
+            timed = timed || result.percentiles[stage][2] > 0.0;
+        }
+        if (!timed) continue;
+
+        std::cout << std::setw(15) << LatencyStats::stageName(static_cast<LatencyStage>(stage));
+        for (const auto& result : results) {
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(2) << result.percentiles[stage][0] << "/"
+                 << result.percentiles[stage][1] << "/" << result.percentiles[stage][2];
+            std::cout << std::setw(24) << cell.str();
+        }
+        std::cout << std::endl;
+    }
+}
+
+bool writeResultsCsv(const std::string& path, const std::vector<E2EResult>& results) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        std::cerr << "Error: Could not write " << path << std::endl;
+        return false;
+    }
+    std::fprintf(file, "vehicles,frames,fps,mota,idf1,id_switches,false_positives,misses");
+    for (int stage = 0; stage < LatencyStats::kStageCount; ++stage) {
+        const char* name = LatencyStats::stageName(static_cast<LatencyStage>(stage));
+        std::fprintf(file, ",%s_p50_ms,%s_p95_ms,%s_p99_ms", name, name, name);
+    }
+    std::fprintf(file, "\n");
+    for (const auto& result : results) {
+        std::fprintf(file, "%d,%d,%.2f,%.4f,%.4f,%ld,%ld,%ld", result.vehicles, result.frames, result.fps,
+                     result.accuracy.mota, result.accuracy.idf1, result.accuracy.idSwitches,
+                     result.accuracy.falsePositives, result.accuracy.misses);
+        for (int stage = 0; stage < LatencyStats::kStageCount; ++stage) {
+            std::fprintf(file, ",%.3f,%.3f,%.3f", result.percentiles[stage][0],
+                         result.percentiles[stage][1], result.percentiles[stage][2]);
+        }
+        std::fprintf(file, "\n");
+    }
+    std::fclose(file);
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    SyntheticSceneConfig config;
+    std::vector<int> densities = {10, 50, 200};
+    std::string workdir = "e2e_bench_work";
+    std::string modelPath;
+    std::string csvPath;
+    bool oracle = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                printE2EUsage(argv[0]);
+                return 0;
+            } else if (arg == "--oracle") {
+                oracle = true;
+            } else if (i + 1 >= argc) {
+                std::cerr << "Error: Missing argument for " << arg << std::endl;
+                return 1;
+            } else if (arg == "--vehicles") {
+                densities.clear();
+                std::stringstream stream(argv[++i]);
+                std::string item;
+                while (std::getline(stream, item, ',')) {
+                    if (!item.empty()) densities.push_back(std::stoi(item));
+                }
+            } else if (arg == "--frames") {
+                config.frameCount = std::stoi(argv[++i]);
+            } else if (arg == "--size") {
+                std::string value = argv[++i];
+                size_t separator = value.find('x');
+                if (separator == std::string::npos) throw std::invalid_argument(value);
+                config.width = std::stoi(value.substr(0, separator));
+                config.height = std::stoi(value.substr(separator + 1));
+            } else if (arg == "--seed") {
+                config.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--workdir") {
+                workdir = argv[++i];
+            } else if (arg == "-m" || arg == "--model") {
+                modelPath = argv[++i];
+            } else if (arg == "--csv") {
+                csvPath = argv[++i];
+            } else {
+                std::cerr << "Error: Unknown argument " << arg << std::endl;
+                printE2EUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid numeric argument" << std::endl;
+        return 1;
+    }
+
+    if (densities.empty() || config.width < 64 || config.height < 64 || config.frameCount < 1) {
+        std::cerr << "Error: Need at least one density, a 64x64 frame and one frame" << std::endl;
+        return 1;
+    }
+
+#ifndef _WIN32
+    mkdir(workdir.c_str(), 0755);
+#endif
+
+    std::vector<E2EResult> results;
+    for (int vehicles : densities) {
+        config.vehicleCount = vehicles;
+        E2EResult result;
+        if (!runDensity(config, workdir, modelPath, oracle, result)) {
+            std::cerr << "Error: Benchmark failed at " << vehicles << " vehicles" << std::endl;
+            return 1;
+        }
+        results.push_back(result);
+    }
+
+    printResults(results);
+    if (!csvPath.empty() && !writeResultsCsv(csvPath, results)) {
+        return 1;
+    }
+    return 0;
+}
@@ -13,6 +13,8 @@ void printUsage(const std::string& programName) {
     std::cout << "  -h, --min-hits <count>       Minimum hits for track confirmation (default: 3)" << std::endl;
     std::cout << "  -u, --iou-threshold <value>  IoU threshold for tracking (0.0-1.0, default: 0.3)" << std::endl;
     std::cout << "  -n, --no-display            Disable real-time display" << std::endl;
+    std::cout << "  --export-mot <path>         Write tracks in MOTChallenge format" << std::endl;
+    std::cout << "  --export-csv <path>         Write tracks as CSV" << std::endl;
     std::cout << "  --help                      Show this help message" << std::endl;
     std::cout << std::endl;
     std::cout << "Example:" << std::endl;
@@ -27,6 +29,8 @@ int main(int argc, char* argv[]) {
     int minHits = 3;
     float iouThreshold = 0.3f;
     bool displayEnabled = true;
+    std::string exportMotPath = "";
+    std::string exportCsvPath = "";
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -95,6 +99,13 @@ int main(int argc, char* argv[]) {
             }
         } else if (arg == "-n" || arg == "--no-display") {
             displayEnabled = false;
+        } else if (arg == "--export-mot" || arg == "--export-csv") {
+            if (i + 1 < argc) {
+                (arg == "--export-mot" ? exportMotPath : exportCsvPath) = argv[++i];
+            } else {
+                std::cerr << "Error: Missing argument for " << arg << std::endl;
+                return 1;
+            }
         } else {
             std::cerr << "Error: Unknown argument " << arg << std::endl;
             printUsage(argv[0]);
@@ -126,6 +137,14 @@ int main(int argc, char* argv[]) {
     tracker.setDetectionThreshold(detectionThreshold);
     tracker.setTrackingParameters(maxAge, minHits, iouThreshold);
     tracker.enableDisplay(displayEnabled);
+    if (!exportMotPath.empty() && !tracker.addExporter(exportMotPath, ExportFormat::MOTChallenge)) {
+        std::cerr << "Failed to open MOT export file!" << std::endl;
+        return 1;
+    }
+    if (!exportCsvPath.empty() && !tracker.addExporter(exportCsvPath, ExportFormat::CSV)) {
+        std::cerr << "Failed to open CSV export file!" << std::endl;
+        return 1;
+    }
     
     // Process video
     if (!tracker.processVideo(inputVideo, outputVideo)) {
@@ -0,0 +1,113 @@
+#include "TrackLog.h"
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <set>
+#include <string>
+
+void printQueryUsage(const std::string& programName) {
+    std::cout << "Track Log Query Tool" << std::endl;
+    std::cout << "====================" << std::endl;
+    std::cout << "Usage: " << programName << " <track_log> <command> [args] [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Commands:" << std::endl;
+    std::cout << "  info                         Summary of the log and its chunk index" << std::endl;
+    std::cout << "  track <id>                   States of one track" << std::endl;
+    std::cout << "  region <x> <y> <w> <h>       All track states overlapping a region" << std::endl;
+    std::cout << "  frame <n>                    All track states in one frame" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --from <frame>               First frame to include" << std::endl;
+    std::cout << "  --to <frame>                 Last frame to include" << std::endl;
+    std::cout << "  --limit <rows>               Stop after this many rows" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Example:" << std::endl;
+    std::cout << "  " << programName << " chase.tracklog track 17 --from 5000 --to 6000" << std::endl;
+}
+
+void printRow(const TrackLogRow& row) {
+    std::printf("%d,%d,%d,%d,%d,%d,%.2f,%.2f,%.3f,%.3f,%d,%d\n",
+                row.frame, row.id, row.x, row.y, row.width, row.height,
+                row.vx, row.vy, row.confidence, row.visibility,
+                (row.flags & kTrackLogOccluded) ? 1 : 0,
+                (row.flags & kTrackLogPrimary) ? 1 : 0);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3 || std::string(argv[1]) == "--help") {
+        printQueryUsage(argv[0]);
+        return argc < 3 ? 1 : 0;
+    }
+
+    std::string logPath = argv[1];
+    std::string command = argv[2];
+    std::vector<std::string> positional;
+    int32_t fromFrame = std::numeric_limits<int32_t>::min();
+    int32_t toFrame = std::numeric_limits<int32_t>::max();
+    long limit = -1;
+
+    try {
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--from" && i + 1 < argc) {
+                fromFrame = std::stoi(argv[++i]);
+            } else if (arg == "--to" && i + 1 < argc) {
+                toFrame = std::stoi(argv[++i]);
+            } else if (arg == "--limit" && i + 1 < argc) {
+                limit = std::stol(argv[++i]);
+            } else {
+                positional.push_back(arg);
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid numeric argument" << std::endl;
+        return 1;
+    }
+
+    TrackLogReader reader;
+    if (!reader.open(logPath)) {
+        return 1;
+    }
+
+    if (command == "info") {
+        std::set<int32_t> ids;
+        reader.queryFrames(fromFrame, toFrame, [&ids](const TrackLogRow& row) {
+            ids.insert(row.id);
+            return true;
+        });
+        std::cout << "Rows: " << reader.getRowCount() << std::endl;
+        std::cout << "Chunks: " << reader.getChunks().size() << std::endl;
+        std::cout << "Frames: " << reader.getFirstFrame() << " - " << reader.getLastFrame() << std::endl;
+        std::cout << "Distinct tracks: " << ids.size() << std::endl;
+        return 0;
+    }
+
+    long emitted = 0;
+    auto visit = [&emitted, limit](const TrackLogRow& row) {
+        printRow(row);
+        return limit < 0 || ++emitted < limit;
+    };
+
+    std::printf("frame,id,x,y,w,h,vx,vy,confidence,visibility,occluded,primary\n");
+    try {
+        if (command == "track" && positional.size() == 1) {
+            reader.queryTrack(std::stoi(positional[0]), fromFrame, toFrame, visit);
+        } else if (command == "region" && positional.size() == 4) {
+            reader.queryRegion(std::stoi(positional[0]), std::stoi(positional[1]),
+                               std::stoi(positional[2]), std::stoi(positional[3]),
+                               fromFrame, toFrame, visit);
+        } else if (command == "frame" && positional.size() == 1) {
+            int32_t frame = std::stoi(positional[0]);
+            reader.queryFrames(frame, frame, visit);
+        } else {
+            std::cerr << "Error: Unknown command or wrong arguments: " << command << std::endl;
+            printQueryUsage(argv[0]);
+            return 1;
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid numeric argument" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,409 @@
+#include "AdvancedTrackingSystem.h"
+#include "BenchHarness.h"
+#include "Tracker.h"
+#include "CorrelationTracker.h"
+#include "LetterboxBlob.h"
+#include "DetectorPool.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Exposes the protected tracking steps to the benchmarks
+class BenchTrackingSystem : public TrackingSystem {
+public:
+    using TrackingSystem::predictTracks;
+    using TrackingSystem::updateTracks;
+    using TrackingSystem::createNewTracks;
+    using TrackingSystem::calculateIoU;
+    using TrackingSystem::rebuildTrackIndex;
+
+    std::vector<TrackedVehicle>& tracks() { return tracks_; }
+};
+
+class BenchAdvancedTrackingSystem : public AdvancedTrackingSystem {
+public:
+    using AdvancedTrackingSystem::extractAppearanceFeatures;
+    using AdvancedTrackingSystem::calculateReIdScore;
+    using AdvancedTrackingSystem::mergeSimilarTracks;
+    using AdvancedTrackingSystem::updateCameraMotion;
+    using AdvancedTrackingSystem::addAdvancedTrack;
+
+    SlotMap<AdvancedTrackedVehicle>& tracks() { return advancedTracks_; }
+};
+
+struct BenchResolution {
+    const char* name;
+    cv::Size size;
+};
+
+const BenchResolution kResolutions[] = {
+    {"720p", cv::Size(1280, 720)},
+    {"1080p", cv::Size(1920, 1080)},
+    {"4K", cv::Size(3840, 2160)}
+};
+
+const int kTrackCounts[] = {10, 100, 1000};
+
+// Non-overlapping boxes on a grid covering a 1080p frame, so every detection
+// matches at most one track
+std::vector<Detection> makeDetections(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> jitter(0, 4);
+    int columns = static_cast<int>(std::ceil(std::sqrt(count * 16.0 / 9.0)));
+    int rows = (count + columns - 1) / columns;
+    int cellWidth = 1920 / columns;
+    int cellHeight = 1080 / rows;
+
+    std::vector<Detection> detections;
+    detections.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        Detection detection;
+        detection.boundingBox = cv::Rect((i % columns) * cellWidth + jitter(rng),
+                                         (i / columns) * cellHeight + jitter(rng),
+                                         cellWidth * 2 / 3, cellHeight * 2 / 3);
+        detection.confidence = 0.9f;
+        detection.classId = 2;
+        detection.label = internLabel("car");
+        detections.push_back(detection);
+    }
+    return detections;
+}
+
+std::vector<Detection> shiftDetections(std::vector<Detection> detections, int dx, int dy) {
+    for (auto& detection : detections) {
+        detection.boundingBox.x += dx;
+        detection.boundingBox.y += dy;
+    }
+    return detections;
+}
+
+// Smoothed noise with vehicle-sized blocks: enough texture for corner
+// detection and HOG, identical on every run
+cv::Mat makeSyntheticFrame(cv::Size size, uint64_t seed) {
+    cv::Mat frame(size, CV_8UC3);
+    cv::RNG rng(seed);
+    rng.fill(frame, cv::RNG::UNIFORM, 0, 256);
+    cv::GaussianBlur(frame, frame, cv::Size(0, 0), 3.0);
+
+    for (int i = 0; i < 60; ++i) {
+        int width = size.width / 20 + rng.uniform(0, size.width / 20);
+        int height = size.height / 20 + rng.uniform(0, size.height / 20);
+        cv::Rect box(rng.uniform(0, size.width - width), rng.uniform(0, size.height - height), width, height);
+        cv::rectangle(frame, box, cv::Scalar(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256)), cv::FILLED);
+    }
+    return frame;
+}
+
+cv::Mat translateFrame(const cv::Mat& frame, double dx, double dy) {
+    cv::Mat transform = cv::Mat::eye(2, 3, CV_64F);
+    transform.at<double>(0, 2) = dx;
+    transform.at<double>(1, 2) = dy;
+    cv::Mat shifted;
+    cv::warpAffine(frame, shifted, transform, frame.size(), cv::INTER_LINEAR, cv::BORDER_REFLECT);
+    return shifted;
+}
+
+void registerTrackingBenchmarks(BenchRunner& runner) {
+    runner.add("TrackingSystem/calculateIoU", [](BenchState& state) {
+        BenchTrackingSystem system;
+        std::vector<Detection> a = makeDetections(1024, 1);
+        std::vector<Detection> b = shiftDetections(a, 7, 5);
+        size_t i = 0;
+        while (state.keepRunning()) {
+            benchDoNotOptimize(system.calculateIoU(a[i].boundingBox, b[i].boundingBox));
+            i = (i + 1) & 1023;
+        }
+    });
+
+    for (int count : kTrackCounts) {
+        std::string suffix = "/" + std::to_string(count);
+
+        runner.add("TrackingSystem/predictTracks" + suffix, [count](BenchState& state) {
+            BenchTrackingSystem system;
+            system.createNewTracks(makeDetections(count, 2));
+            while (state.keepRunning()) {
+                system.predictTracks(1.0f);
+            }
+            benchDoNotOptimize(system.tracks().front().boundingBox);
+        });
+
+        runner.add("TrackingSystem/updateTracks" + suffix, [count](BenchState& state) {
+            BenchTrackingSystem system;
+            std::vector<Detection> seeds = makeDetections(count, 3);
+            system.createNewTracks(seeds);
+            std::vector<Detection> detections = shiftDetections(seeds, 2, 1);
+            while (state.keepRunning()) {
+                system.updateTracks(detections);
+            }
+            benchDoNotOptimize(system.tracks().front().boundingBox);
+        });
+
+        runner.add("TrackingSystem/createNewTracks" + suffix, [count](BenchState& state) {
+            // Half the detections land on existing tracks, half start new ones
+            BenchTrackingSystem system;
+            std::vector<Detection> all = makeDetections(count * 2, 4);
+            system.createNewTracks(std::vector<Detection>(all.begin(), all.begin() + count));
+            const std::vector<TrackedVehicle> snapshot = system.tracks();
+            std::vector<Detection> detections(all.begin() + count / 2, all.begin() + count + count / 2);
+            while (state.keepRunning()) {
+                state.pauseTiming();
+                system.tracks() = snapshot;
+                system.rebuildTrackIndex();
+                state.resumeTiming();
+                system.createNewTracks(detections);
+            }
+            benchDoNotOptimize(system.tracks().size());
+        });
+    }
+}
+
+// Full update of a runtime-configured tracker against its fixed-policy
+// equivalents, on the same jittering scene
+template <typename System>
+void benchTrackerUpdate(BenchState& state, System& system, int count) {
+    std::vector<Detection> seeds = makeDetections(count, 5);
+    std::vector<Detection> shifted = shiftDetections(seeds, 2, 1);
+    const cv::Mat noFrame;
+    bool odd = false;
+    while (state.keepRunning()) {
+        benchDoNotOptimize(system.update(odd ? shifted : seeds, noFrame).empty());
+        odd = !odd;
+    }
+}
+
+void registerPolicyTrackerBenchmarks(BenchRunner& runner) {
+    for (int count : kTrackCounts) {
+        std::string suffix = "/" + std::to_string(count);
+
+        runner.add("Tracker/update/TrackingSystem" + suffix, [count](BenchState& state) {
+            TrackingSystem system;
+            benchTrackerUpdate(state, system, count);
+        });
+
+        runner.add("Tracker/update/FixedTrackingSystem" + suffix, [count](BenchState& state) {
+            FixedTrackingSystem system;
+            benchTrackerUpdate(state, system, count);
+        });
+
+        runner.add("Tracker/update/EdgeTrackingSystem" + suffix, [count](BenchState& state) {
+            EdgeTrackingSystem system;
+            benchTrackerUpdate(state, system, count);
+        });
+    }
+}
+
+void registerAppearanceBenchmarks(BenchRunner& runner) {
+    for (const auto& resolution : kResolutions) {
+        std::string suffix = std::string("/") + resolution.name;
+        cv::Size size = resolution.size;
+        cv::Rect roi(size.width / 2, size.height / 2, size.width / 8, size.height / 8);
+
+        runner.add("AdvancedTrackingSystem/extractAppearanceFeatures" + suffix, [size, roi](BenchState& state) {
+            BenchAdvancedTrackingSystem system;
+            cv::Mat frame = makeSyntheticFrame(size, 10);
+            cv::Mat features;
+            while (state.keepRunning()) {
+                benchDoNotOptimize(system.extractAppearanceFeatures(frame, roi, features));
+            }
+        });
+
+        runner.add("AdvancedTrackingSystem/calculateReIdScore" + suffix, [size, roi](BenchState& state) {
+            BenchAdvancedTrackingSystem system;
+            cv::Mat frame = makeSyntheticFrame(size, 11);
+            cv::Mat features1, features2;
+            system.extractAppearanceFeatures(frame, roi, features1);
+            system.extractAppearanceFeatures(frame, roi - cv::Point(roi.width, 0), features2);
+            while (state.keepRunning()) {
+                benchDoNotOptimize(system.calculateReIdScore(features1, features2));
+            }
+        });
+
+        runner.add("AdvancedTrackingSystem/mergeSimilarTracks" + suffix, [size](BenchState& state) {
+            // 64 active tracks with real appearance features, reset every pass
+            BenchAdvancedTrackingSystem system;
+            cv::Mat frame = makeSyntheticFrame(size, 12);
+            std::mt19937 rng(13);
+            std::uniform_int_distribution<int> x(0, size.width * 7 / 8 - 1);
+            std::uniform_int_distribution<int> y(0, size.height * 7 / 8 - 1);
+            for (int i = 0; i < 64; ++i) {
+                AdvancedTrackedVehicle track;
+                track.id = i;
+                track.label = internLabel("car");
+                track.isActive = true;
+                track.confidence = 0.5f + i * 0.005f;
+                track.boundingBox = cv::Rect(x(rng), y(rng), size.width / 8, size.height / 8);
+                system.extractAppearanceFeatures(frame, track.boundingBox, track.appearanceFeatures);
+                system.addAdvancedTrack(track);
+            }
+            while (state.keepRunning()) {
+                state.pauseTiming();
+                for (auto& track : system.tracks()) track.isActive = true;
+                state.resumeTiming();
+                system.mergeSimilarTracks();
+            }
+        });
+
+        runner.add("CorrelationTracker/update" + suffix, [size, roi](BenchState& state) {
+            // Target drifting a few pixels per frame, as between detector runs
+            CorrelationTracker tracker;
+            cv::Mat frame = makeSyntheticFrame(size, 15);
+            cv::Mat shifted = translateFrame(frame, 3.0, 2.0);
+            tracker.initialize(frame, roi);
+            cv::Rect box;
+            bool odd = false;
+            while (state.keepRunning()) {
+                benchDoNotOptimize(tracker.update(odd ? frame : shifted, box));
+                odd = !odd;
+            }
+        });
+
+        runner.add("AdvancedTrackingSystem/updateCameraMotion" + suffix, [size](BenchState& state) {
+            BenchAdvancedTrackingSystem system;
+            system.enableCameraMotionCompensation(true);
+            cv::Mat previous = makeSyntheticFrame(size, 14);
+            cv::Mat current = translateFrame(previous, 6.0, -3.0);
+            while (state.keepRunning()) {
+                system.updateCameraMotion(current, previous);
+            }
+        });
+    }
+}
+
+void registerPreprocessBenchmarks(BenchRunner& runner) {
+    // The detector's 416x416 input
+    const cv::Size inputSize(416, 416);
+    for (const auto& resolution : kResolutions) {
+        std::string suffix = std::string("/") + resolution.name;
+        cv::Size size = resolution.size;
+
+        runner.add("LetterboxBlob/prepare" + suffix, [size, inputSize](BenchState& state) {
+            LetterboxBlob input;
+            cv::Mat frame = makeSyntheticFrame(size, 16);
+            while (state.keepRunning()) {
+                benchDoNotOptimize(input.prepare(frame, inputSize).data);
+            }
+        });
+
+        // What preprocessing cost before, for comparison
+        runner.add("blobFromImage" + suffix, [size, inputSize](BenchState& state) {
+            cv::Mat frame = makeSyntheticFrame(size, 16);
+            cv::Mat blob;
+            while (state.keepRunning()) {
+                cv::dnn::blobFromImage(frame, blob, 1 / 255.0, inputSize, cv::Scalar(0, 0, 0), true, false);
+                benchDoNotOptimize(blob.data);
+            }
+        });
+    }
+}
+
+void registerDetectorPoolBenchmarks(BenchRunner& runner) {
+    // Four frames per iteration whatever the worker count, so the cases
+    // compare directly; HOG unless the YOLO files are present
+    const int kFramesPerBatch = 4;
+    for (int workers : {1, 2, 4}) {
+        runner.add("DetectorPool/4frames/workers=" + std::to_string(workers), [workers](BenchState& state) {
+            DetectorPool pool;
+            if (!pool.start(workers)) {
+                // Nothing to measure; every submit would throw
+                state.skip("could not start " + std::to_string(workers) + " workers");
+                return;
+            }
+            cv::Mat frame = makeSyntheticFrame(cv::Size(640, 360), 17);
+            std::vector<std::future<std::vector<Detection>>> results;
+            while (state.keepRunning()) {
+                results.clear();
+                for (int i = 0; i < kFramesPerBatch; ++i) {
+                    results.push_back(pool.submit(frame));
+                }
+                for (auto& result : results) {
+                    benchDoNotOptimize(result.get().size());
+                }
+            }
+        });
+    }
+}
+
+void printBenchUsage(const std::string& programName) {
+    std::cout << "Tracker Micro-benchmarks" << std::endl;
+    std::cout << "========================" << std::endl;
+    std::cout << "Usage: " << programName << " [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --filter <text>              Only run benchmarks whose name contains text" << std::endl;
+    std::cout << "  --min-time <ms>              Minimum time per measured batch (default: 200)" << std::endl;
+    std::cout << "  --repetitions <n>            Batches per benchmark; median is reported (default: 3)" << std::endl;
+    std::cout << "  --csv <path>                 Write results as CSV" << std::endl;
+    std::cout << "  --compare <path>             Compare against an earlier --csv run" << std::endl;
+    std::cout << "  --max-regression <percent>   Fail the comparison above this slowdown (default: 10)" << std::endl;
+    std::cout << "  --list                       List benchmark names" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Example:" << std::endl;
+    std::cout << "  " << programName << " --csv before.csv" << std::endl;
+    std::cout << "  " << programName << " --compare before.csv --filter updateTracks" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    BenchRunner runner;
+    std::string csvPath;
+    std::string comparePath;
+    double maxRegression = 0.10;
+    bool listOnly = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h") {
+                printBenchUsage(argv[0]);
+                return 0;
+            } else if (arg == "--list") {
+                listOnly = true;
+            } else if (i + 1 >= argc) {
+                std::cerr << "Error: Missing argument for " << arg << std::endl;
+                return 1;
+            } else if (arg == "--filter") {
+                runner.setFilter(argv[++i]);
+            } else if (arg == "--min-time") {
+                runner.setMinTimeMs(std::stod(argv[++i]));
+            } else if (arg == "--repetitions") {
+                runner.setRepetitions(std::stoi(argv[++i]));
+            } else if (arg == "--csv") {
+                csvPath = argv[++i];
+            } else if (arg == "--compare") {
+                comparePath = argv[++i];
+            } else if (arg == "--max-regression") {
+                maxRegression = std::stod(argv[++i]) / 100.0;
+            } else {
+                std::cerr << "Error: Unknown argument " << arg << std::endl;
+                printBenchUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid numeric argument" << std::endl;
+        return 1;
+    }
+
+    registerTrackingBenchmarks(runner);
+    registerPolicyTrackerBenchmarks(runner);
+    registerAppearanceBenchmarks(runner);
+    registerPreprocessBenchmarks(runner);
+    registerDetectorPoolBenchmarks(runner);
+
+    if (listOnly) {
+        for (const auto& name : runner.names()) {
+            std::cout << name << std::endl;
+        }
+        return 0;
+    }
+    std::vector<BenchResult> results = runner.run();
+
+    if (!csvPath.empty() && !BenchRunner::writeCsv(csvPath, results)) {
+        return 1;
+    }
+    if (!comparePath.empty() && !BenchRunner::compare(comparePath, results, maxRegression)) {
+        return 2;
+    }
+    return 0;
+}
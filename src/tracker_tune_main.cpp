@@ -0,0 +1,317 @@
+#include "AdvancedTrackingSystem.h"
+#include "DetectionCache.h"
+#include "TrackingMetrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <time.h>
+#endif
+
+struct TuneConfig {
+    float iouThreshold;
+    int maxAge;
+    int minHits;
+    float occlusionThreshold;
+    float reIdThreshold;
+};
+
+struct TuneResult {
+    TuneConfig config;
+    double score;       // MOTA with ground truth, stability score without
+    double secondary;   // IDF1 with ground truth, coverage without
+    long idSwitches;    // -1 without ground truth
+    double msPerFrame;
+    bool pareto;
+};
+
+void printTuneUsage(const std::string& programName) {
+    std::cout << "Tracker Parameter Sweep" << std::endl;
+    std::cout << "=======================" << std::endl;
+    std::cout << "Usage: " << programName << " <detection_cache> [options]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Replays cached detections through every combination of the listed" << std::endl;
+    std::cout << "tracker parameters and reports the accuracy/cost Pareto front." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --gt <file>                  MOTChallenge ground truth; enables MOTA/IDF1" << std::endl;
+    std::cout << "  -t, --threshold <value>      Detection confidence threshold (default: 0.5)" << std::endl;
+    std::cout << "  --iou <list>                 IoU thresholds (default: 0.2,0.3,0.4)" << std::endl;
+    std::cout << "  --max-age <list>             Max missed frames (default: 15,30,60)" << std::endl;
+    std::cout << "  --min-hits <list>            Min hits to keep a track (default: 1,3,5)" << std::endl;
+    std::cout << "  --occlusion-threshold <list> Occlusion thresholds (default: 0.3)" << std::endl;
+    std::cout << "  --reid-threshold <list>      Re-ID thresholds (default: 0.7)" << std::endl;
+    std::cout << "  --threads <n>                Worker threads (default: all cores)" << std::endl;
+    std::cout << "  --csv <path>                 Write every result as CSV" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Example:" << std::endl;
+    std::cout << "  " << programName << " cache/abc_def.detcache --gt gt.txt --iou 0.1,0.2,0.3 --max-age 30,90" << std::endl;
+}
+
+template <typename T>
+std::vector<T> parseList(const std::string& text) {
+    std::vector<T> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty()) continue;
+        std::istringstream parser(item);
+        T value;
+        if (!(parser >> value)) throw std::invalid_argument(item);
+        values.push_back(value);
+    }
+    return values;
+}
+
+// CPU time of the calling thread, so workers sharing cores still report
+// their own cost
+double threadCpuMs() {
+#ifndef _WIN32
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#else
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+TuneResult evaluate(const TuneConfig& config, const std::vector<int>& frameIndices,
+                    const std::vector<std::vector<Detection>>& detections,
+                    const std::map<int, FrameBoxes>* groundTruth) {
+    AdvancedTrackingSystem tracker;
+    tracker.initialize();
+    tracker.setIoUThreshold(config.iouThreshold);
+    tracker.setMaxAge(config.maxAge);
+    tracker.setMinHits(config.minHits);
+    tracker.setOcclusionThreshold(config.occlusionThreshold);
+    tracker.setReIdThreshold(config.reIdThreshold);
+
+    MOTAccumulator mot;
+    StabilityAccumulator stability;
+    const cv::Mat noFrame;  // Detections only; appearance and camera motion stay idle
+    const FrameBoxes noBoxes;
+
+    double trackerMs = 0.0;
+    FrameBoxes hypotheses;
+    std::vector<cv::Rect> detectionBoxes;
+    for (size_t i = 0; i < frameIndices.size(); ++i) {
+        // Cached runs may have skipped frames; step the filters over the gap
+        float dt = i > 0 ? static_cast<float>(frameIndices[i] - frameIndices[i - 1]) : 1.0f;
+        double start = threadCpuMs();
+        TrackView<AdvancedTrackedVehicle> tracks = tracker.updateAdvanced(detections[i], noFrame, dt);
+        trackerMs += threadCpuMs() - start;
+
+        hypotheses.clear();
+        for (const auto& track : tracks) {
+            hypotheses.emplace_back(track.id, track.boundingBox);
+        }
+
+        if (groundTruth) {
+            // Ground truth is 1-based like the exporters
+            auto gt = groundTruth->find(frameIndices[i] + 1);
+            mot.addFrame(gt != groundTruth->end() ? gt->second : noBoxes, hypotheses);
+        } else {
+            detectionBoxes.clear();
+            for (const auto& detection : detections[i]) {
+                detectionBoxes.push_back(detection.boundingBox);
+            }
+            stability.addFrame(detectionBoxes, hypotheses);
+        }
+    }
+
+    TuneResult result;
+    result.config = config;
+    result.msPerFrame = frameIndices.empty() ? 0.0 : trackerMs / frameIndices.size();
+    result.pareto = false;
+    if (groundTruth) {
+        MOTSummary summary = mot.summary();
+        result.score = summary.mota;
+        result.secondary = summary.idf1;
+        result.idSwitches = summary.idSwitches;
+    } else {
+        StabilitySummary summary = stability.summary();
+        result.score = summary.score;
+        result.secondary = summary.coverage;
+        result.idSwitches = -1;
+    }
+    return result;
+}
+
+// Marks results not beaten on both score and cost by any other result
+void markParetoFront(std::vector<TuneResult>& results) {
+    std::sort(results.begin(), results.end(), [](const TuneResult& a, const TuneResult& b) {
+        return a.msPerFrame != b.msPerFrame ? a.msPerFrame < b.msPerFrame : a.score > b.score;
+    });
+    double bestScore = -1e300;
+    for (auto& result : results) {
+        if (result.score > bestScore) {
+            result.pareto = true;
+            bestScore = result.score;
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h") {
+        printTuneUsage(argv[0]);
+        return argc < 2 ? 1 : 0;
+    }
+
+    std::string cachePath = argv[1];
+    std::string groundTruthPath;
+    std::string csvPath;
+    float detectionThreshold = 0.5f;
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<float> iouThresholds = {0.2f, 0.3f, 0.4f};
+    std::vector<int> maxAges = {15, 30, 60};
+    std::vector<int> minHits = {1, 3, 5};
+    std::vector<float> occlusionThresholds = {0.3f};
+    std::vector<float> reIdThresholds = {0.7f};
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "Error: Missing argument for " << arg << std::endl;
+                return 1;
+            }
+            if (arg == "--gt") {
+                groundTruthPath = argv[++i];
+            } else if (arg == "-t" || arg == "--threshold") {
+                detectionThreshold = std::stof(argv[++i]);
+            } else if (arg == "--iou") {
+                iouThresholds = parseList<float>(argv[++i]);
+            } else if (arg == "--max-age") {
+                maxAges = parseList<int>(argv[++i]);
+            } else if (arg == "--min-hits") {
+                minHits = parseList<int>(argv[++i]);
+            } else if (arg == "--occlusion-threshold") {
+                occlusionThresholds = parseList<float>(argv[++i]);
+            } else if (arg == "--reid-threshold") {
+                reIdThresholds = parseList<float>(argv[++i]);
+            } else if (arg == "--threads") {
+                threadCount = std::max(1, std::stoi(argv[++i]));
+            } else if (arg == "--csv") {
+                csvPath = argv[++i];
+            } else {
+                std::cerr << "Error: Unknown argument " << arg << std::endl;
+                printTuneUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid numeric argument" << std::endl;
+        return 1;
+    }
+
+    // Load the detection stream once; every configuration replays it
+    DetectionCache cache;
+    if (!cache.openForReplay(cachePath)) {
+        return 1;
+    }
+    if (detectionThreshold < cache.getFloorThreshold()) {
+        std::cerr << "Warning: Cache holds detections above " << cache.getFloorThreshold()
+                  << " only" << std::endl;
+    }
+
+    std::vector<int> frameIndices = cache.getFrameIndices();
+    std::vector<std::vector<Detection>> detections(frameIndices.size());
+    std::unordered_map<int, LabelId> classLabels;
+    for (size_t i = 0; i < frameIndices.size(); ++i) {
+        cache.lookup(frameIndices[i], detections[i]);
+        detections[i] = VehicleDetector::filterByConfidence(detections[i], detectionThreshold);
+        for (auto& detection : detections[i]) {
+            // Only compared for equality by the tracker
+            auto label = classLabels.find(detection.classId);
+            if (label == classLabels.end()) {
+                label = classLabels.emplace(detection.classId,
+                                            internLabel("class" + std::to_string(detection.classId))).first;
+            }
+            detection.label = label->second;
+        }
+    }
+    cache.close();
+
+    std::map<int, FrameBoxes> groundTruth;
+    if (!groundTruthPath.empty() && !loadMOTFile(groundTruthPath, groundTruth)) {
+        return 1;
+    }
+    const std::map<int, FrameBoxes>* groundTruthPtr = groundTruthPath.empty() ? nullptr : &groundTruth;
+
+    std::vector<TuneConfig> configs;
+    for (float iou : iouThresholds)
+        for (int age : maxAges)
+            for (int hits : minHits)
+                for (float occlusion : occlusionThresholds)
+                    for (float reId : reIdThresholds)
+                        configs.push_back({iou, age, hits, occlusion, reId});
+
+    threadCount = std::min<unsigned>(threadCount, static_cast<unsigned>(std::max<size_t>(1, configs.size())));
+    std::cout << "Frames: " << frameIndices.size() << ", configurations: " << configs.size()
+              << ", threads: " << threadCount << std::endl;
+    std::cout << "Scoring: " << (groundTruthPtr ? "MOTA (IDF1 secondary)" : "stability proxy (no ground truth)")
+              << std::endl;
+
+    // Workers pull the next configuration until the grid is exhausted
+    std::vector<TuneResult> results(configs.size());
+    std::atomic<size_t> next(0);
+    std::atomic<size_t> done(0);
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&]() {
+            for (size_t i = next++; i < configs.size(); i = next++) {
+                results[i] = evaluate(configs[i], frameIndices, detections, groundTruthPtr);
+                size_t finished = ++done;
+                if (finished % 10 == 0 || finished == configs.size()) {
+                    std::fprintf(stderr, "\r%zu/%zu configurations", finished, configs.size());
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::fprintf(stderr, "\n");
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    markParetoFront(results);
+
+    if (!csvPath.empty()) {
+        std::ofstream csv(csvPath);
+        csv << "iou,max_age,min_hits,occlusion,reid,score,secondary,id_switches,ms_per_frame,pareto\n";
+        for (const auto& r : results) {
+            csv << r.config.iouThreshold << "," << r.config.maxAge << "," << r.config.minHits << ","
+                << r.config.occlusionThreshold << "," << r.config.reIdThreshold << ","
+                << r.score << "," << r.secondary << "," << r.idSwitches << ","
+                << r.msPerFrame << "," << (r.pareto ? 1 : 0) << "\n";
+        }
+    }
+
+    std::printf("\nPareto front (%s vs ms/frame):\n", groundTruthPtr ? "MOTA" : "stability");
+    std::printf("%6s %8s %8s %9s %6s %8s %9s %7s %9s\n",
+                "iou", "max_age", "min_hits", "occlusion", "reid", "score",
+                groundTruthPtr ? "idf1" : "coverage", "id_sw", "ms/frame");
+    for (const auto& r : results) {
+        if (!r.pareto) continue;
+        std::printf("%6.2f %8d %8d %9.2f %6.2f %8.4f %9.4f %7ld %9.4f\n",
+                    r.config.iouThreshold, r.config.maxAge, r.config.minHits,
+                    r.config.occlusionThreshold, r.config.reIdThreshold,
+                    r.score, r.secondary, r.idSwitches, r.msPerFrame);
+    }
+
+    double trackedFrames = static_cast<double>(frameIndices.size()) * configs.size();
+    std::printf("\n%zu configurations in %.2f s (%.0f tracker frames/s)\n",
+                configs.size(), wallSeconds, wallSeconds > 0 ? trackedFrames / wallSeconds : 0.0);
+    return 0;
+}
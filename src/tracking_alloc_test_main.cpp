@@ -0,0 +1,249 @@
+#include "AdvancedTrackingSystem.h"
+#include "Tracker.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+// Steady-state allocation check for the tracking hot path: once the trackers
+// have warmed up on a scene whose vehicles neither enter nor leave, a frame
+// of update() / updateAdvanced() on detections alone must not touch the heap.
+// Every operator new and every cv::Mat buffer (OpenCV's fastMalloc, which
+// bypasses operator new) is counted while a measured frame runs.
+//
+// With pixels, OpenCV's HOG allocates its own scratch on every call, so that
+// pass reports its allocations and checks instead that the tracker's own
+// appearance buffers are reused frame to frame.
+
+namespace {
+
+std::atomic<bool> countingAllocations(false);
+std::atomic<uint64_t> allocationCount(0);
+
+void countAllocation() {
+    if (countingAllocations.load(std::memory_order_relaxed)) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void* countedAllocate(size_t bytes) {
+    countAllocation();
+    void* memory = std::malloc(bytes ? bytes : 1);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void* countedAllocateAligned(size_t bytes, std::align_val_t alignment) {
+    countAllocation();
+    size_t align = static_cast<size_t>(alignment);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    size_t rounded = ((bytes ? bytes : 1) + align - 1) / align * align;
+    void* memory = std::aligned_alloc(align, rounded);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+// Counts new cv::Mat buffers and hands the work to OpenCV's own allocator,
+// which also frees them
+class CountingMatAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        if (!data) countAllocation();
+        return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+    }
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override {
+        return cv::Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+    }
+    void deallocate(cv::UMatData* data) const override {
+        cv::Mat::getStdAllocator()->deallocate(data);
+    }
+};
+
+const int kVehicles = 50;
+const int kWarmupFrames = 120;
+const int kMeasuredFrames = 300;
+
+// Grid of vehicles drifting at a constant, per-vehicle velocity. Cells are
+// far enough apart that boxes never overlap over the whole run.
+void makeSceneDetections(int frameIndex, LabelId label, std::vector<Detection>& detections) {
+    detections.clear();
+    for (int i = 0; i < kVehicles; ++i) {
+        int column = i % 10;
+        int row = i / 10;
+        Detection detection;
+        detection.boundingBox = cv::Rect(column * 180 + frameIndex * (1 + column % 2),
+                                         row * 200 + frameIndex * (row % 2),
+                                         80, 50);
+        detection.confidence = 0.9f;
+        detection.classId = 2;
+        detection.label = label;
+        detections.push_back(detection);
+    }
+}
+
+// Draws the scene's vehicles as textured blocks, so HOG has edges to describe
+void renderScene(const std::vector<Detection>& detections, cv::Mat& frame) {
+    frame.setTo(cv::Scalar(40, 40, 40));
+    for (size_t i = 0; i < detections.size(); ++i) {
+        const cv::Rect& box = detections[i].boundingBox;
+        cv::Scalar color(60 + (i * 37) % 180, 60 + (i * 71) % 180, 60 + (i * 113) % 180);
+        cv::rectangle(frame, box, color, cv::FILLED);
+        cv::line(frame, box.tl(), box.br(), cv::Scalar(255, 255, 255), 2);
+        cv::rectangle(frame, cv::Rect(box.x + 10, box.y + 10, box.width / 3, box.height / 3),
+                      cv::Scalar(0, 0, 0), cv::FILLED);
+    }
+}
+
+struct AllocationResult {
+    uint64_t allocations;
+    int framesWithAllocations;
+    int failingFrames;  // Wrong track count or a failed per-frame check
+};
+
+// Runs the scene through updateFrame, counting allocations on the measured
+// frames. scene, when given, is redrawn before every frame; checkFrame runs
+// after each measured frame, outside the counted region.
+template <typename UpdateFrame, typename CheckFrame>
+AllocationResult measure(const char* name, cv::Mat* scene, UpdateFrame&& updateFrame, CheckFrame&& checkFrame) {
+    LabelId car = internLabel("car");
+    std::vector<Detection> detections;
+    detections.reserve(kVehicles);
+
+    for (int frame = 0; frame < kWarmupFrames; ++frame) {
+        makeSceneDetections(frame, car, detections);
+        if (scene) renderScene(detections, *scene);
+        updateFrame(detections);
+    }
+
+    AllocationResult result = {0, 0, 0};
+    for (int frame = kWarmupFrames; frame < kWarmupFrames + kMeasuredFrames; ++frame) {
+        makeSceneDetections(frame, car, detections);
+        if (scene) renderScene(detections, *scene);
+        allocationCount.store(0, std::memory_order_relaxed);
+        countingAllocations.store(true, std::memory_order_relaxed);
+        size_t activeTracks = updateFrame(detections);
+        countingAllocations.store(false, std::memory_order_relaxed);
+
+        uint64_t allocations = allocationCount.load(std::memory_order_relaxed);
+        result.allocations += allocations;
+        if (allocations > 0) {
+            result.framesWithAllocations++;
+        }
+        if (activeTracks != static_cast<size_t>(kVehicles)) {
+            std::cerr << name << ": expected " << kVehicles << " tracks on frame " << frame
+                      << ", got " << activeTracks << std::endl;
+            result.failingFrames++;
+        } else if (!checkFrame()) {
+            result.failingFrames++;
+        }
+    }
+
+    std::printf("%-34s %4d frames  %8llu allocations  %4d frames allocating  %4d failing frames\n", name,
+                kMeasuredFrames, static_cast<unsigned long long>(result.allocations),
+                result.framesWithAllocations, result.failingFrames);
+    return result;
+}
+
+template <typename UpdateFrame>
+AllocationResult measure(const char* name, UpdateFrame&& updateFrame) {
+    return measure(name, nullptr, updateFrame, [] { return true; });
+}
+
+bool allocationFree(const AllocationResult& result) {
+    return result.framesWithAllocations == 0 && result.failingFrames == 0;
+}
+
+// Collects the data pointers of every track's appearance buffers, sorted so
+// ring rotation does not count as movement
+void collectFeatureBuffers(TrackView<AdvancedTrackedVehicle> tracks, std::vector<const uchar*>& buffers) {
+    buffers.clear();
+    for (const auto& track : tracks) {
+        buffers.push_back(track.appearanceFeatures.data);
+        for (size_t i = 0; i < track.featureHistory.size(); ++i) {
+            buffers.push_back(track.featureHistory[i].data);
+        }
+    }
+    std::sort(buffers.begin(), buffers.end());
+}
+
+}  // namespace
+
+void* operator new(size_t bytes) { return countedAllocate(bytes); }
+void* operator new[](size_t bytes) { return countedAllocate(bytes); }
+void* operator new(size_t bytes, const std::nothrow_t&) noexcept {
+    try { return countedAllocate(bytes); } catch (...) { return nullptr; }
+}
+void* operator new[](size_t bytes, const std::nothrow_t&) noexcept {
+    try { return countedAllocate(bytes); } catch (...) { return nullptr; }
+}
+void* operator new(size_t bytes, std::align_val_t alignment) { return countedAllocateAligned(bytes, alignment); }
+void* operator new[](size_t bytes, std::align_val_t alignment) { return countedAllocateAligned(bytes, alignment); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { std::free(memory); }
+
+int main() {
+    std::cout << "=== Tracking Allocation Test ===" << std::endl;
+    CountingMatAllocator matAllocator;
+    cv::Mat::setDefaultAllocator(&matAllocator);
+    std::cout << kVehicles << " vehicles, " << kWarmupFrames << " warm-up frames" << std::endl;
+
+    // No pixels: the detection-only path, as in replay and oracle runs
+    const cv::Mat noFrame;
+
+    TrackingSystem tracker;
+    AllocationResult basic = measure("TrackingSystem::update (detections)", [&](const std::vector<Detection>& detections) {
+        return tracker.update(detections, noFrame).size();
+    });
+
+    AdvancedTrackingSystem advancedTracker;
+    AllocationResult advanced = measure("AdvancedTrackingSystem (detections)", [&](const std::vector<Detection>& detections) {
+        return advancedTracker.updateAdvanced(detections, noFrame).size();
+    });
+
+    FixedTrackingSystem fixedTracker;
+    AllocationResult fixed = measure("FixedTrackingSystem (detections)", [&](const std::vector<Detection>& detections) {
+        return fixedTracker.update(detections, noFrame).size();
+    });
+
+    EdgeTrackingSystem edgeTracker;
+    AllocationResult edge = measure("EdgeTrackingSystem (detections)", [&](const std::vector<Detection>& detections) {
+        return edgeTracker.update(detections, noFrame).size();
+    });
+
+    // Pixels: appearance features every frame. Camera motion stays off; its
+    // optical flow builds pyramids inside OpenCV and would read the drifting
+    // vehicles as a panning camera.
+    cv::Mat scene(1280, 2560, CV_8UC3);
+    AdvancedTrackingSystem pixelTracker;
+    pixelTracker.enableCameraMotionCompensation(false);
+    std::vector<const uchar*> previousBuffers, currentBuffers;
+    AllocationResult pixels = measure("AdvancedTrackingSystem (pixels)", &scene,
+        [&](const std::vector<Detection>& detections) {
+            return pixelTracker.updateAdvanced(detections, scene).size();
+        },
+        [&] {
+            collectFeatureBuffers(pixelTracker.getAdvancedTracks(), currentBuffers);
+            bool reused = previousBuffers.empty() || currentBuffers == previousBuffers;
+            if (!reused) {
+                std::cerr << "AdvancedTrackingSystem (pixels): appearance buffers reallocated" << std::endl;
+            }
+            previousBuffers.swap(currentBuffers);
+            return reused;
+        });
+    cv::Mat::setDefaultAllocator(cv::Mat::getStdAllocator());
+
+    bool passed = allocationFree(basic) && allocationFree(advanced) && allocationFree(fixed) &&
+                  allocationFree(edge) && pixels.failingFrames == 0;
+    std::cout << (passed ? "PASS" : "FAIL: steady-state frames allocated") << std::endl;
+    return passed ? 0 : 1;
+}